@@ -0,0 +1,186 @@
+// Throughput benchmark for the lexer.
+//
+// Build: gcc -O2 bench_lexer.c lexer.c source.c WordHash.c skip.c -o bench_lexer
+// Usage: bench_lexer [file.usb ...]   (no arguments: lexes a generated ~8 MB program)
+//
+// Earlier engines are measured with this benchmark as it was in the history,
+// built from a checkout of that commit; e.g. the switch lexer before the
+// transition table:
+//   git worktree add /tmp/lexer-switch 4393398^
+//   cd /tmp/lexer-switch/Lexer && gcc -O2 bench_lexer.c lexer.c source.c WordHash.c -o bench_lexer
+// and both binaries run on the same files.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lexer.h"
+#include "source.h"
+
+#define BENCH_RUNS 5
+#define GENERATED_SIZE (8u << 20)
+
+static const char *sampleStatements =
+    "    bilang counter, total = 0;\n"
+    "    lutang ratio = 3.75;\n"
+    "    kwerdas msg = \"Hello USBong\";\n"
+    "    // running total of the counters\n"
+    "    para (counter = 0; counter < 10; counter = counter + 1) {\n"
+    "        total = total + counter * 2 - (ratio / 4);\n"
+    "        ani(total, msg);\n"
+    "    }\n"
+    "    /* multi line\n"
+    "       comment */\n"
+    "    kung (total >= 100 && ratio != 0) { tanim(total); } kundi { ani('x'); }\n";
+
+static volatile long benchSink; //keeps the scan loops from being optimized away
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Build a syntactically plausible program of roughly `size` bytes
+static char *generateProgram(size_t size, size_t *length) {
+    size_t chunk = strlen(sampleStatements);
+    char *data = malloc(size + chunk + 64);
+    size_t n = 0;
+    n += sprintf(data, "wala ugat() {\n");
+    while (n < size) {
+        memcpy(data + n, sampleStatements, chunk);
+        n += chunk;
+    }
+    n += sprintf(data + n, "}\n");
+    *length = n;
+    return data;
+}
+
+// Input access alone, the way the old lexer did it: one fgetc per character
+// and an ungetc at the end of every token
+static double scanStdio(FILE *file) {
+    double start = nowSeconds();
+    long tokens = 0;
+    int c, prev = ' ';
+    rewind(file);
+    while ((c = fgetc(file)) != EOF) {
+        if (c == ' ' && prev != ' ') {
+            ungetc(c, file);
+            tokens += fgetc(file);
+        }
+        prev = c;
+    }
+    benchSink = tokens;
+    return nowSeconds() - start;
+}
+
+// Same access pattern over the in-memory buffer
+static double scanBuffer(const char *data, size_t length) {
+    double start = nowSeconds();
+    const unsigned char *cursor = (const unsigned char *)data;
+    const unsigned char *end = cursor + length;
+    long tokens = 0;
+    int c, prev = ' ';
+    while (cursor < end) {
+        c = *cursor++;
+        if (c == ' ' && prev != ' ') {
+            cursor--;
+            tokens += *cursor++;
+        }
+        prev = c;
+    }
+    benchSink = tokens;
+    return nowSeconds() - start;
+}
+
+// The streaming lexer must write exactly the same symbol table as the buffer one
+static int sameOutput(const char *data, size_t length) {
+    FILE *input = tmpfile(), *a = tmpfile(), *b = tmpfile();
+    fwrite(data, 1, length, input);
+    rewind(input);
+    lexer(data, length, a);
+    lexStream(input, b);
+    fclose(input);
+    rewind(a);
+    rewind(b);
+    int ca, cb;
+    do {
+        ca = fgetc(a);
+        cb = fgetc(b);
+    } while (ca == cb && ca != EOF);
+    fclose(a);
+    fclose(b);
+    return ca == cb;
+}
+
+static double timeLexer(const char *data, size_t length, FILE *sink) {
+    double start = nowSeconds();
+    lexer(data, length, sink);
+    return nowSeconds() - start;
+}
+
+// Token list only, no symbol table formatting
+static double timeLexTokens(const char *data, size_t length, TokenList *list) {
+    double start = nowSeconds();
+    lexTokens(data, length, list);
+    return nowSeconds() - start;
+}
+
+static void benchInput(const char *name, const char *data, size_t length, FILE *file) {
+    FILE *sink = fopen("/dev/null", "w");
+    double mb = length / (1024.0 * 1024.0);
+    double best = 1e9, bestStdio = 1e9, bestBuffer = 1e9, bestTokens = 1e9;
+    TokenList list;
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        double elapsed = timeLexTokens(data, length, &list);
+        if (elapsed < bestTokens) bestTokens = elapsed;
+        if (run < BENCH_RUNS - 1) freeTokenList(&list);
+        elapsed = timeLexer(data, length, sink);
+        if (elapsed < best) best = elapsed;
+
+        if (file) {
+            elapsed = scanStdio(file);
+            if (elapsed < bestStdio) bestStdio = elapsed;
+        }
+        elapsed = scanBuffer(data, length);
+        if (elapsed < bestBuffer) bestBuffer = elapsed;
+    }
+    fclose(sink);
+
+    printf("%s (%.2f MB)\n", name, mb);
+    printf("  table-driven lexer:         %8.1f MB/s\n", mb / best);
+    printf("  token list only:            %8.1f MB/s (%zu tokens, %.1f MB of spans)\n",
+           mb / bestTokens, list.count, list.capacity * sizeof(Token) / (1024.0 * 1024.0));
+    printf("  identical output:           %8s\n", sameOutput(data, length) ? "yes" : "NO");
+    if (file) {
+        printf("  input only, fgetc/ungetc:   %8.1f MB/s\n", mb / bestStdio);
+    }
+    printf("  input only, pointer walk:   %8.1f MB/s\n", mb / bestBuffer);
+    freeTokenList(&list);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        size_t length;
+        char *data = generateProgram(GENERATED_SIZE, &length);
+        FILE *file = tmpfile();
+        fwrite(data, 1, length, file);
+        benchInput("generated program", data, length, file);
+        fclose(file);
+        free(data);
+        return EXIT_SUCCESS;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        SourceBuffer source;
+        if (!openSource(&source, argv[i])) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        FILE *file = fopen(argv[i], "rb");
+        benchInput(argv[i], source.data, source.length, file);
+        if (file) fclose(file);
+        closeSource(&source);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+// Scaling benchmark for the parallel lexer (lexer_parallel.c): the same input
+// lexed with 1 to N threads, each run checked against the sequential lexer's
+// symbol table byte for byte.
+//
+// Build: gcc -O2 -pthread bench_parallel.c lexer.c lexer_parallel.c source.c WordHash.c skip.c -o bench_parallel
+// Usage: bench_parallel [-t max_threads] [file.usb ...]
+//        (no files: lexes a generated ~64 MB program; max_threads defaults to the online CPUs)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "lexer.h"
+#include "source.h"
+
+#define BENCH_RUNS 3
+#define GENERATED_SIZE (64u << 20)
+
+static const char *sampleStatements =
+    "    bilang counter, total = 0;\n"
+    "    lutang ratio = 3.75;\n"
+    "    kwerdas msg = \"Hello USBong\";\n"
+    "    // running total of the counters\n"
+    "    para (counter = 0; counter < 10; counter = counter + 1) {\n"
+    "        total = total + counter * 2 - (ratio / 4);\n"
+    "        ani(total, msg);\n"
+    "    }\n"
+    "    /* multi line\n"
+    "       comment */\n"
+    "    kung (total >= 100 && ratio != 0) { tanim(total); } kundi { ani('x'); }\n";
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Build a syntactically plausible program of roughly `size` bytes
+static char *generateProgram(size_t size, size_t *length) {
+    size_t chunk = strlen(sampleStatements);
+    char *data = malloc(size + chunk + 64);
+    size_t n = 0;
+    n += sprintf(data, "wala ugat() {\n");
+    while (n < size) {
+        memcpy(data + n, sampleStatements, chunk);
+        n += chunk;
+    }
+    n += sprintf(data + n, "}\n");
+    *length = n;
+    return data;
+}
+
+static FILE *symbolTable(const char *data, const TokenList *list) {
+    FILE *file = tmpfile();
+    writeSymbolTable(file, data, list);
+    rewind(file);
+    return file;
+}
+
+static int sameFile(FILE *a, FILE *b) {
+    static char bufferA[1 << 16], bufferB[1 << 16];
+    size_t na, nb;
+    rewind(a);
+    rewind(b);
+    do {
+        na = fread(bufferA, 1, sizeof(bufferA), a);
+        nb = fread(bufferB, 1, sizeof(bufferB), b);
+        if (na != nb || memcmp(bufferA, bufferB, na) != 0) return 0;
+    } while (na > 0);
+    return 1;
+}
+
+static void benchInput(const char *name, const char *data, size_t length, int maxThreads) {
+    double mb = length / (1024.0 * 1024.0);
+    double sequential = 1e9;
+    TokenList list;
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        double start = nowSeconds();
+        lexTokens(data, length, &list);
+        double elapsed = nowSeconds() - start;
+        if (elapsed < sequential) sequential = elapsed;
+        if (run < BENCH_RUNS - 1) freeTokenList(&list);
+    }
+    FILE *expected = symbolTable(data, &list);
+    printf("%s (%.2f MB, %zu tokens)\n", name, mb, list.count);
+    printf("  sequential    %8.1f MB/s\n", mb / sequential);
+    freeTokenList(&list);
+
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        double best = 1e9;
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            double start = nowSeconds();
+            lexTokensParallel(data, length, &list, threads);
+            double elapsed = nowSeconds() - start;
+            if (elapsed < best) best = elapsed;
+            if (run < BENCH_RUNS - 1) freeTokenList(&list);
+        }
+        FILE *actual = symbolTable(data, &list);
+        printf("  %2d thread%s    %8.1f MB/s  x%.2f  %s\n", threads, threads == 1 ? " " : "s",
+               mb / best, sequential / best, sameFile(expected, actual) ? "identical" : "DIFFERENT");
+        fclose(actual);
+        freeTokenList(&list);
+    }
+    fclose(expected);
+}
+
+int main(int argc, char *argv[]) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = online > 1 ? (int)online : 1;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+        maxThreads = atoi(argv[2]);
+        if (maxThreads < 1) maxThreads = 1;
+        first = 3;
+    }
+
+    if (first >= argc) {
+        size_t length;
+        char *data = generateProgram(GENERATED_SIZE, &length);
+        benchInput("generated program", data, length, maxThreads);
+        free(data);
+        return EXIT_SUCCESS;
+    }
+
+    for (int i = first; i < argc; i++) {
+        SourceBuffer source;
+        if (!openSource(&source, argv[i])) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        benchInput(argv[i], source.data, source.length, maxThreads);
+        closeSource(&source);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+// Per-kernel benchmark for the lexer's fast-skip kernels (skip.c): every
+// implementation built into the binary against the byte-at-a-time loop.
+//
+// Build: gcc -O2 bench_skip.c skip.c -o bench_skip            (SSE2, SWAR, scalar)
+//        gcc -O2 -mavx2 bench_skip.c skip.c -o bench_skip     (adds AVX2)
+// Usage: bench_skip
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "skip.h"
+
+#define BENCH_RUNS 5
+#define BUFFER_SIZE (16u << 20)
+
+enum { K_SPACE, K_IDENTIFIER, K_LINE, K_COMMENT, K_STRING, KERNEL_COUNT };
+
+static const char *kernelNames[KERNEL_COUNT] = {
+    "whitespace", "identifier", "// comment", "/* comment */", "kwerdas body"
+};
+
+static volatile long benchSink; //keeps the scans from being optimized away
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int seed = 12345;
+static unsigned int randomBelow(unsigned int n) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % n;
+}
+
+// Runs of what the kernel skips, each ended by one byte that stops it,
+// with run lengths typical of source code
+static unsigned char *buildInput(int kernel, size_t size) {
+    static const char identifierChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    static const char spaceChars[] = "    \t\n";
+    unsigned char *data = malloc(size);
+    size_t n = 0;
+    while (n < size) {
+        size_t run;
+        switch (kernel) {
+            case K_SPACE:      run = 1 + randomBelow(12); break;
+            case K_IDENTIFIER: run = 1 + randomBelow(16); break;
+            case K_LINE:       run = 20 + randomBelow(60); break;
+            case K_COMMENT:    run = 40 + randomBelow(400); break;
+            default:           run = 4 + randomBelow(40); break;
+        }
+        for (size_t i = 0; i < run && n < size; i++) {
+            unsigned char c;
+            switch (kernel) {
+                case K_SPACE:      c = spaceChars[randomBelow(sizeof(spaceChars) - 1)]; break;
+                case K_IDENTIFIER: c = identifierChars[randomBelow(sizeof(identifierChars) - 1)]; break;
+                case K_COMMENT:    c = randomBelow(50) ? 'a' + randomBelow(26) : '\n'; break;
+                default:           c = randomBelow(6) ? 'a' + randomBelow(26) : ' '; break;
+            }
+            data[n++] = c;
+        }
+        if (n < size) {
+            switch (kernel) {
+                case K_SPACE:      data[n++] = 'x'; break;
+                case K_IDENTIFIER: data[n++] = ' '; break;
+                case K_LINE:       data[n++] = '\n'; break;
+                case K_COMMENT:    data[n++] = '*'; break;
+                default:           data[n++] = '"'; break;
+            }
+        }
+    }
+    return data;
+}
+
+// Skip every run in the buffer; returns the number of runs, *lines gets the newlines
+static long scan(const SkipKernels *k, int kernel, const unsigned char *p, const unsigned char *end, int *lines) {
+    long runs = 0;
+    *lines = 0;
+    while (p < end) {
+        switch (kernel) {
+            case K_SPACE:      p = k->space(p, end, lines); break;
+            case K_IDENTIFIER: p = k->identifier(p, end); break;
+            case K_LINE:       p = k->line(p, end); break;
+            case K_COMMENT:    p = k->comment(p, end, lines); break;
+            default:           p = k->string(p, end); break;
+        }
+        if (p < end) {
+            *lines += (kernel == K_LINE && *p == '\n'); //the stop byte itself
+            p++;
+        }
+        runs++;
+    }
+    return runs;
+}
+
+int main(void) {
+    double mb = BUFFER_SIZE / (1024.0 * 1024.0);
+    int status = EXIT_SUCCESS;
+
+    printf("%-14s", "kernel");
+    for (int s = 0; skipKernelSets[s]; s++) printf(" %10s", skipKernelSets[s]->name);
+    printf("   (MB/s)\n");
+
+    for (int kernel = 0; kernel < KERNEL_COUNT; kernel++) {
+        unsigned char *data = buildInput(kernel, BUFFER_SIZE);
+        const unsigned char *end = data + BUFFER_SIZE;
+        int scalarLines = 0;
+        long scalarRuns = 0;
+        for (int s = 0; skipKernelSets[s]; s++) { //the scalar loop is last
+            if (!skipKernelSets[s + 1]) scalarRuns = scan(skipKernelSets[s], kernel, data, end, &scalarLines);
+        }
+
+        printf("%-14s", kernelNames[kernel]);
+        for (int s = 0; skipKernelSets[s]; s++) {
+            double best = 1e9;
+            int lines = 0;
+            long runs = 0;
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                double start = nowSeconds();
+                runs = scan(skipKernelSets[s], kernel, data, end, &lines);
+                double elapsed = nowSeconds() - start;
+                if (elapsed < best) best = elapsed;
+            }
+            benchSink = runs;
+            if (runs != scalarRuns || lines != scalarLines) { //stops and newline counts must match exactly
+                printf(" %10s", "MISMATCH");
+                status = EXIT_FAILURE;
+            } else {
+                printf(" %10.0f", mb / best);
+            }
+        }
+        printf("\n");
+        free(data);
+    }
+    return status;
+}
@@ -0,0 +1,160 @@
+// Microbenchmark for the keyword table: the generated perfect hash (WordHash.c)
+// against the runtime-built djb2 + linear probing table it replaced.
+//
+// Build: gcc -O2 bench_wordhash.c WordHash.c -o bench_wordhash
+// Usage: bench_wordhash
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wordhash.h"
+#include "wordlist.h"
+
+#define BENCH_RUNS 5
+#define LOOKUPS_PER_RUN 4000000
+#define SAMPLE_COUNT 4096
+
+//---- the previous table, kept here as the baseline ----
+#define OLD_TABLE_SIZE 100
+#define OLD_MAX 100
+
+typedef struct {
+    char key[OLD_MAX];
+    TokenCategory category;
+    int tokenValue;
+} OldHashEntry;
+
+static OldHashEntry oldTable[OLD_TABLE_SIZE];
+
+static unsigned int oldHash(const char *key) {
+    unsigned int hash_val = 5381;
+    int c;
+    while ((c = *key++)) {
+        hash_val = hash_val * 33 + c;
+    }
+    return hash_val % OLD_TABLE_SIZE;
+}
+
+static void oldInsert(const char *key, TokenCategory category, int token_value) {
+    unsigned int index = oldHash(key);
+    while (oldTable[index].key[0] != '\0') {
+        index = (index + 1) % OLD_TABLE_SIZE;
+    }
+    strcpy(oldTable[index].key, key);
+    oldTable[index].category = category;
+    oldTable[index].tokenValue = token_value;
+}
+
+static OldHashEntry *oldLookUp(const char *key) {
+    unsigned int index = oldHash(key);
+    unsigned int start = index;
+    do {
+        if (oldTable[index].key[0] == '\0') return NULL;
+        if (strcmp(oldTable[index].key, key) == 0) return &oldTable[index];
+        index = (index + 1) % OLD_TABLE_SIZE;
+    } while (index != start);
+    return NULL;
+}
+//---- end of the previous table ----
+
+#define WORD_STRING(word, category, value) word,
+static const char *keywords[] = {
+    WORD_LIST(WORD_STRING)
+};
+#define KEYWORD_COUNT (int)(sizeof(keywords) / sizeof(keywords[0]))
+
+//identifier names of the kind real programs use
+static const char *identifiers[] = {
+    "counter", "total", "i", "j", "x", "msg", "ratio", "result", "value", "index",
+    "sum", "temp", "buffer", "name", "length", "count", "kungfu", "balikan", "tama2",
+    "average", "numbers", "flag", "isValid", "maxValue", "n", "str", "pangalan", "edad",
+};
+#define IDENTIFIER_COUNT (int)(sizeof(identifiers) / sizeof(identifiers[0]))
+
+typedef struct {
+    const char *text;
+    size_t length;
+} Sample;
+
+static volatile long benchSink; //keeps the lookups from being optimized away
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// keywordPercent of the samples are table words, the rest identifiers
+static void buildSamples(Sample *samples, int keywordPercent) {
+    unsigned int seed = 12345;
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        seed = seed * 1103515245u + 12345u;
+        const char *text = (int)((seed >> 16) % 100) < keywordPercent
+            ? keywords[(seed >> 8) % KEYWORD_COUNT]
+            : identifiers[(seed >> 8) % IDENTIFIER_COUNT];
+        samples[i].text = text;
+        samples[i].length = strlen(text);
+    }
+}
+
+static double timeOld(const Sample *samples) {
+    double best = 1e9;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        long found = 0;
+        double start = nowSeconds();
+        for (int i = 0; i < LOOKUPS_PER_RUN; i++) {
+            found += oldLookUp(samples[i & (SAMPLE_COUNT - 1)].text) != NULL;
+        }
+        double elapsed = nowSeconds() - start;
+        benchSink = found;
+        if (elapsed < best) best = elapsed;
+    }
+    return best * 1e9 / LOOKUPS_PER_RUN;
+}
+
+static double timePerfect(const Sample *samples) {
+    double best = 1e9;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        long found = 0;
+        double start = nowSeconds();
+        for (int i = 0; i < LOOKUPS_PER_RUN; i++) {
+            const Sample *s = &samples[i & (SAMPLE_COUNT - 1)];
+            found += wordLookup(s->text, s->length) != NULL;
+        }
+        double elapsed = nowSeconds() - start;
+        benchSink = found;
+        if (elapsed < best) best = elapsed;
+    }
+    return best * 1e9 / LOOKUPS_PER_RUN;
+}
+
+// Both tables must agree on every sample
+static int sameAnswers(const Sample *samples) {
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        OldHashEntry *old = oldLookUp(samples[i].text);
+        const HashEntry *entry = wordLookup(samples[i].text, samples[i].length);
+        if (!old != !entry) return 0;
+        if (old && (old->category != entry->category || old->tokenValue != entry->tokenValue)) return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    static Sample samples[SAMPLE_COUNT];
+    static const struct { const char *name; int keywordPercent; } mixes[] = {
+        { "keywords only", 100 },
+        { "identifiers only", 0 },
+        { "mixed (40% keywords)", 40 },
+    };
+
+#define WORD_INSERT(word, category, value) oldInsert(word, category, value);
+    WORD_LIST(WORD_INSERT)
+
+    printf("%-22s %10s %14s %6s\n", "lookup mix", "old ns/op", "perfect ns/op", "same");
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        buildSamples(samples, mixes[m].keywordPercent);
+        printf("%-22s %10.2f %14.2f %6s\n", mixes[m].name,
+               timeOld(samples), timePerfect(samples), sameAnswers(samples) ? "yes" : "NO");
+    }
+    return EXIT_SUCCESS;
+}
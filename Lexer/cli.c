@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "cli.h"
+
+#ifndef _WIN32
+#include <glob.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <direct.h>
+#endif
+
+static int appendPath(InputList *inputs, const char *path) {
+    if (inputs->count == inputs->capacity) {
+        size_t capacity = inputs->capacity ? inputs->capacity * 2 : 64;
+        char **grown = realloc(inputs->paths, capacity * sizeof(char *));
+        if (!grown) return 0;
+        inputs->paths = grown;
+        inputs->capacity = capacity;
+    }
+    char *copy = malloc(strlen(path) + 1);
+    if (!copy) return 0;
+    strcpy(copy, path);
+    inputs->paths[inputs->count++] = copy;
+    return 1;
+}
+
+// Patterns the shell left alone (quoted, or read from a list file) are expanded
+// here. A pattern that matches nothing is kept as it is, so opening it fails and
+// gets reported like any other missing file.
+int addInput(InputList *inputs, const char *pattern) {
+#ifndef _WIN32
+    if (strcmp(pattern, "-") != 0 && strpbrk(pattern, "*?[")) {
+        glob_t matches;
+        int ok = 1;
+        if (glob(pattern, GLOB_NOCHECK, NULL, &matches) != 0) return 0;
+        for (size_t i = 0; ok && i < matches.gl_pathc; i++) {
+            ok = appendPath(inputs, matches.gl_pathv[i]);
+        }
+        globfree(&matches);
+        return ok;
+    }
+#endif
+    return appendPath(inputs, pattern);
+}
+
+int addInputsFromFile(InputList *inputs, const char *listFile) {
+    FILE *file = strcmp(listFile, "-") == 0 ? stdin : fopen(listFile, "r");
+    if (!file) return 0;
+
+    char *line = NULL;
+    size_t capacity = 0, length = 0;
+    int ok = 1, c;
+    do { //lines of any length; blank lines are skipped
+        c = fgetc(file);
+        if (c == '\n' || c == EOF) {
+            while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ')) length--;
+            if (length > 0) {
+                line[length] = '\0';
+                ok = addInput(inputs, line);
+            }
+            length = 0;
+        } else {
+            if (length + 1 >= capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                char *grown = realloc(line, capacity);
+                if (!grown) {
+                    ok = 0;
+                    break;
+                }
+                line = grown;
+            }
+            line[length++] = (char)c;
+        }
+    } while (ok && c != EOF);
+
+    if (ferror(file)) ok = 0;
+    if (file != stdin) fclose(file);
+    free(line);
+    return ok;
+}
+
+void freeInputList(InputList *inputs) {
+    for (size_t i = 0; i < inputs->count; i++) free(inputs->paths[i]);
+    free(inputs->paths);
+    inputs->paths = NULL;
+    inputs->count = 0;
+    inputs->capacity = 0;
+}
+
+static int makeDirectory(const char *dir) {
+#ifndef _WIN32
+    if (mkdir(dir, 0777) == 0 || errno == EEXIST) return 1;
+#else
+    if (_mkdir(dir) == 0 || errno == EEXIST) return 1;
+#endif
+    return 0;
+}
+
+int makeDirectories(const char *dir) {
+    char *path = malloc(strlen(dir) + 1);
+    if (!path) return 0;
+    strcpy(path, dir);
+
+    int ok = 1;
+    for (char *p = path + 1; ok && *p; p++) { //each parent first
+        if (*p == '/') {
+            *p = '\0';
+            ok = makeDirectory(path);
+            *p = '/';
+        }
+    }
+    ok = ok && makeDirectory(path);
+    free(path);
+    return ok;
+}
+
+int parseCount(const char *text, int min, int max, int *count) {
+    char *end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < min || value > max) return 0;
+    *count = (int)value;
+    return 1;
+}
+
+//The name an input's outputs are called after: its file name without the extension
+static const char *inputStem(const char *input, size_t *stemLength) {
+    if (strcmp(input, "-") == 0) {
+        *stemLength = strlen("stdin");
+        return "stdin";
+    }
+    const char *slash = strrchr(input, '/');
+#ifdef _WIN32
+    const char *backslash = strrchr(input, '\\');
+    if (backslash && (!slash || backslash > slash)) slash = backslash;
+#endif
+    const char *stem = slash ? slash + 1 : input;
+    const char *dot = strrchr(stem, '.');
+    *stemLength = (dot && dot != stem) ? (size_t)(dot - stem) : strlen(stem);
+    return stem;
+}
+
+typedef struct {
+    const char *stem;
+    size_t length;
+    size_t index;
+} StemEntry;
+
+static int compareStems(const void *a, const void *b) {
+    const StemEntry *x = a, *y = b;
+    size_t common = x->length < y->length ? x->length : y->length;
+    int order = memcmp(x->stem, y->stem, common);
+    if (order == 0 && x->length != y->length) order = x->length < y->length ? -1 : 1;
+    if (order == 0) order = x->index < y->index ? -1 : 1;
+    return order;
+}
+
+unsigned char *findStemCollisions(const InputList *inputs) {
+    unsigned char *collides = calloc(inputs->count ? inputs->count : 1, 1);
+    StemEntry *entries = malloc((inputs->count ? inputs->count : 1) * sizeof(StemEntry));
+    if (!collides || !entries) {
+        free(collides);
+        free(entries);
+        return NULL;
+    }
+    for (size_t i = 0; i < inputs->count; i++) {
+        entries[i].stem = inputStem(inputs->paths[i], &entries[i].length);
+        entries[i].index = i;
+    }
+    //sorted by stem, then by position, so the first of each run keeps its names
+    qsort(entries, inputs->count, sizeof(StemEntry), compareStems);
+    for (size_t i = 1; i < inputs->count; i++) {
+        if (entries[i].length == entries[i - 1].length &&
+            memcmp(entries[i].stem, entries[i - 1].stem, entries[i].length) == 0) {
+            collides[entries[i].index] = 1;
+        }
+    }
+    free(entries);
+    return collides;
+}
+
+char *outputPath(const char *dir, const char *input, const char *name, int prefixStem) {
+    size_t stemLength;
+    const char *stem = inputStem(input, &stemLength);
+
+    const char *separator = "/";
+    if (strcmp(dir, ".") == 0) { //plain names in the current directory
+        dir = "";
+        separator = "";
+    }
+    size_t length = strlen(dir) + 1 + (prefixStem ? stemLength + 1 : 0) + strlen(name) + 1;
+    char *path = malloc(length);
+    if (!path) return NULL;
+    if (prefixStem) {
+        sprintf(path, "%s%s%.*s.%s", dir, separator, (int)stemLength, stem, name);
+    } else {
+        sprintf(path, "%s%s%s", dir, separator, name);
+    }
+    return path;
+}
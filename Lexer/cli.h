@@ -0,0 +1,37 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <stddef.h>
+
+//Batch command-line support shared by the lexer and parser executables:
+//input lists built from paths, glob patterns and list files, and output
+//file names inside an output directory.
+
+//Exit status of one input, and of a whole run (the worst of its inputs)
+#define STATUS_OK 0             //processed, no errors
+#define STATUS_INPUT_ERRORS 1   //processed, but the input has errors (e.g. syntax errors)
+#define STATUS_FAILED 2         //could not be read or its outputs could not be written
+
+//"-" stands for standard input
+typedef struct {
+    char **paths;
+    size_t count;
+    size_t capacity;
+} InputList;
+
+//function prototypes
+int addInput(InputList *inputs, const char *pattern);          //a path, or a glob pattern expanded in sorted order; returns 1 on success
+int addInputsFromFile(InputList *inputs, const char *listFile); //one path or pattern per line ("-": read them from stdin)
+void freeInputList(InputList *inputs);
+int makeDirectories(const char *dir);                          //like mkdir -p, returns 1 if dir exists afterwards
+int parseCount(const char *text, int min, int max, int *count); //a whole decimal number in [min, max]; returns 1 if it is one
+
+//dir/name, or dir/<input stem>.name when prefixStem is set (the stem of "-" is "stdin").
+//Returns a malloc'd path, NULL if out of memory.
+char *outputPath(const char *dir, const char *input, const char *name, int prefixStem);
+//A flag per input, set if an earlier input has the same stem, so with prefixStem
+//both would write the same outputs (a/x.usb and b/x.usb, x.usb and x.usbt).
+//Returns a malloc'd array, NULL if out of memory.
+unsigned char *findStemCollisions(const InputList *inputs);
+
+#endif
@@ -0,0 +1,99 @@
+// Generates wordhash_table.h: a collision-free (perfect) hash table for the
+// words in wordlist.h.
+//
+// Build and run: gcc gen_wordhash.c -o gen_wordhash && ./gen_wordhash > wordhash_table.h
+//
+// The hash only looks at the length, the first two bytes and the last byte:
+//     h = (length + s[0]*A + s[1]*B + s[length-1]*C) mod SIZE
+// The generator tries multipliers until every word lands in its own slot.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tokens.h"
+#include "wordlist.h"
+
+#define TABLE_SIZE 64   //power of two so the mod is a mask
+#define MAX_MULTIPLIER 64
+
+typedef struct {
+    const char *word;
+    const char *category;
+    const char *value;
+} Word;
+
+#define WORD_ENTRY(word, category, value) { word, #category, #value },
+static const Word words[] = {
+    WORD_LIST(WORD_ENTRY)
+};
+#define WORD_COUNT (int)(sizeof(words) / sizeof(words[0]))
+
+static unsigned int hashWord(const char *word, unsigned int a, unsigned int b, unsigned int c) {
+    const unsigned char *s = (const unsigned char *)word;
+    size_t length = strlen(word);
+    return (unsigned int)(length + s[0] * a + s[1] * b + s[length - 1] * c) & (TABLE_SIZE - 1);
+}
+
+// Returns 1 if (a, b, c) sends every word to a different slot
+static int isPerfect(unsigned int a, unsigned int b, unsigned int c, int slots[TABLE_SIZE]) {
+    for (int i = 0; i < TABLE_SIZE; i++) slots[i] = -1;
+    for (int i = 0; i < WORD_COUNT; i++) {
+        unsigned int h = hashWord(words[i].word, a, b, c);
+        if (slots[h] != -1) return 0;
+        slots[h] = i;
+    }
+    return 1;
+}
+
+int main(void) {
+    int slots[TABLE_SIZE];
+    size_t minLength = (size_t)-1, maxLength = 0;
+    unsigned int firstBytes[8] = {0};
+
+    for (int i = 0; i < WORD_COUNT; i++) {
+        size_t length = strlen(words[i].word);
+        if (length < 2) {
+            fprintf(stderr, "\"%s\": words must be at least 2 characters long\n", words[i].word);
+            return EXIT_FAILURE;
+        }
+        if (length < minLength) minLength = length;
+        if (length > maxLength) maxLength = length;
+        unsigned char first = (unsigned char)words[i].word[0];
+        firstBytes[first >> 5] |= 1u << (first & 31);
+    }
+
+    for (unsigned int a = 1; a < MAX_MULTIPLIER; a++) {
+        for (unsigned int b = 0; b < MAX_MULTIPLIER; b++) {
+            for (unsigned int c = 0; c < MAX_MULTIPLIER; c++) {
+                if (!isPerfect(a, b, c, slots)) continue;
+
+                printf("// Generated by gen_wordhash.c from wordlist.h -- do not edit.\n");
+                printf("// Regenerate: gcc gen_wordhash.c -o gen_wordhash && ./gen_wordhash > wordhash_table.h\n");
+                printf("#ifndef WORDHASH_TABLE_H\n#define WORDHASH_TABLE_H\n\n");
+                printf("#define WORDHASH_SIZE %d\n", TABLE_SIZE);
+                printf("#define WORDHASH_MIN_LENGTH %zu\n", minLength);
+                printf("#define WORDHASH_MAX_LENGTH %zu\n", maxLength);
+                printf("#define WORDHASH(s, length) \\\n");
+                printf("    (((length) + (s)[0] * %uu + (s)[1] * %uu + (s)[(length) - 1] * %uu) & (WORDHASH_SIZE - 1))\n\n",
+                       a, b, c);
+
+                printf("//Bit n is set when some word starts with byte n\n");
+                printf("static const unsigned int wordFirstBytes[8] = {\n   ");
+                for (int i = 0; i < 8; i++) printf(" 0x%08xu%s", firstBytes[i], i < 7 ? "," : "\n");
+                printf("};\n\n");
+
+                printf("static const HashEntry wordTable[WORDHASH_SIZE] = {\n");
+                for (int h = 0; h < TABLE_SIZE; h++) {
+                    if (slots[h] == -1) continue;
+                    const Word *w = &words[slots[h]];
+                    printf("    [%2d] = { \"%s\", %zu, %s, %s },\n",
+                           h, w->word, strlen(w->word), w->category, w->value);
+                }
+                printf("};\n\n#endif\n");
+                return EXIT_SUCCESS;
+            }
+        }
+    }
+
+    fprintf(stderr, "no perfect hash found for %d words in %d slots\n", WORD_COUNT, TABLE_SIZE);
+    return EXIT_FAILURE;
+}
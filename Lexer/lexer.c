@@ -0,0 +1,475 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tokens.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include "wordhash.h"
+#include "lexer.h"
+#include "lexer_spec.h"
+#include "skip.h"
+
+// ============ TABLES (expanded from lexer_spec.h) ============
+
+#define LEX_CHAR_ENTRY(ch, cls) [(unsigned char)(ch)] = cls,
+static const unsigned char charClass[256] = {
+    LEXER_CHARS(LEX_CHAR_ENTRY)
+};
+
+#define LEX_TOKEN_ENTRY(name, cat, value) [name] = { cat, value },
+static const struct { unsigned char category, value; } acceptTokens[ACC_COUNT] = {
+    LEXER_ACCEPTS(LEX_TOKEN_ENTRY)
+};
+
+#define LEX_SINGLE_ENTRY(ch, cat, value) [(unsigned char)(ch)] = { cat, value },
+static const struct { unsigned char category, value; } singleCharTokens[256] = {
+    LEXER_SINGLE_CHAR_TOKENS(LEX_SINGLE_ENTRY)
+};
+
+#define LEX_FILL_CLASS(cls, state, cell) [state][cls] = cell,
+#define LEX_ROW(state, cell) LEXER_CHAR_CLASSES(LEX_FILL_CLASS, state, cell)
+#define LEX_ON(state, cls, cell) [state][cls] = cell,
+//Each ON overrides its ROW's cell on purpose (see LEXER_TRANSITIONS)
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverride-init"
+#endif
+static const unsigned short lexerTable[S_DONE + 1][CC_COUNT] = {
+    LEXER_TRANSITIONS(LEX_ROW, LEX_ON)
+};
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// Accept-action dispatch: turn a finished lexeme into a token. The token only
+// records the lexeme's span, nothing is copied.
+static Token acceptToken(int accept, const unsigned char *source, size_t offset, size_t length,
+                         int lineNumber) {
+    const unsigned char *lexeme = source + offset;
+    TokenCategory category = acceptTokens[accept].category;
+    int tokenValue = acceptTokens[accept].value;
+    switch (accept) {
+        case ACC_IDENTIFIER: {
+            const HashEntry *entry = wordLookup((const char *)lexeme, length);
+            if (entry) {
+                category = entry->category;
+                tokenValue = entry->tokenValue;
+            }
+            break;
+        }
+        case ACC_LUTANG:
+            if (lexeme[length - 1] == '.') { // e.g., "123."
+                category = CAT_UNKNOWN;
+                tokenValue = 0;
+            }
+            break;
+        case ACC_SINGLE_CHAR:
+            category = singleCharTokens[lexeme[0]].category;
+            tokenValue = singleCharTokens[lexeme[0]].value;
+            break;
+    }
+    return makeToken(category, tokenValue, offset, length, lineNumber);
+}
+
+static void appendToken(TokenList *list, Token tok) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 1024;
+        Token *grown = realloc(list->tokens, list->capacity * sizeof(Token));
+        if (!grown) {
+            fprintf(stderr, "Lexer Error: out of memory after %zu tokens.\n", list->count);
+            exit(EXIT_FAILURE);
+        }
+        list->tokens = grown;
+    }
+    list->tokens[list->count++] = tok;
+}
+
+// Table-driven DFA over the source buffer. Each character costs one class
+// lookup and one transition lookup, except inside whitespace, identifiers,
+// comments and string bodies, which the skip kernels cross many bytes at a
+// time; the accept action only runs when a lexeme ends.
+//
+// Lexes from cursor (in S_START, on line *lineNumber) and appends to list until
+// the lexer is back in S_START at or past limit, or the input ends. A token that
+// starts before limit is finished even if it runs past it. With a speculative
+// token list (lexer_parallel.c), it also stops where a token would start at the
+// same place as speculative->tokens[*resyncIndex]: from there on both runs are
+// the same. Returns the stop position; *lineNumber is the line there.
+const char *lexTokenRange(const char *source, const char *from, const char *limit, size_t length,
+                          int *lineNumber, TokenList *list,
+                          const TokenList *speculative, size_t *resyncIndex) {
+    const unsigned char *base = (const unsigned char *)source;
+    const unsigned char *cursor = (const unsigned char *)from; //next unread character
+    const unsigned char *stop = (const unsigned char *)limit;
+    const unsigned char *end = base + length;
+    const unsigned char *tokenStart = cursor;
+    LexerState currentState = S_START;
+    int line = *lineNumber;
+    int tokenStartLine = line;
+    size_t next = 0; //first speculative token not yet behind us
+
+    while (true) {
+        //long runs are skipped in bulk (skip.c); the DFA then takes the byte that ends the run
+        switch (currentState) {
+            case S_START: cursor = skipSpace(cursor, stop, &line); break;
+            case S_IDENTIFIER: cursor = skipIdentifier(cursor, end); break;
+            case S_COMMENT_SINGLE: cursor = skipLine(cursor, end); break;
+            case S_COMMENT_MULTI_HEAD: cursor = skipComment(cursor, end, &line); break;
+            case S_KWERDAS_BODY: cursor = skipString(cursor, end); break;
+            default: break;
+        }
+        if (currentState == S_START) { //every lexeme begins in S_START
+            if (cursor >= stop) break;
+            if (speculative) {
+                size_t offset = cursor - base;
+                while (next < speculative->count && speculative->tokens[next].offset < offset) next++;
+                if (next < speculative->count && speculative->tokens[next].offset == offset) {
+                    *resyncIndex = next;
+                    break;
+                }
+            }
+            tokenStart = cursor;
+            tokenStartLine = line;
+        }
+        int charClassOf = (cursor < end) ? charClass[*cursor] : CC_EOF;
+        unsigned int cell = lexerTable[currentState][charClassOf];
+        unsigned int flags = LEX_FLAGS(cell);
+
+        currentState = LEX_NEXT(cell);
+        cursor += flags & LEX_CONSUME;
+        if (flags & LEX_NEWLINE) line++;
+        if (flags & (LEX_EMIT | LEX_STOP)) {
+            if (flags & LEX_STOP) break;
+            appendToken(list, acceptToken(LEX_ACCEPT(cell), base, tokenStart - base,
+                                          cursor - tokenStart, tokenStartLine));
+        }
+    }
+    *lineNumber = line;
+    return (const char *)cursor;
+}
+
+void lexTokens(const char *source, size_t length, TokenList *list) {
+    int lineNumber = 1;
+    list->tokens = NULL;
+    list->count = 0;
+    list->capacity = 0;
+    lexTokenRange(source, source, source + length, length, &lineNumber, list, NULL, NULL);
+}
+
+void freeTokenList(TokenList *list) {
+    free(list->tokens);
+    list->tokens = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// Text symbol table: header line, then one printToken line per token
+void writeSymbolTable(FILE *file, const char *source, const TokenList *list) {
+    fprintf(file, "Lexeme           | Token Name\n");
+    for (size_t i = 0; i < list->count; i++) {
+        printToken(file, source, &list->tokens[i]);
+    }
+}
+
+// Lexer function: lexes the whole buffer, then writes the symbol table
+void lexer (const char *source, size_t length, FILE *symbolFileAppend) {
+    TokenList list;
+    lexTokens(source, length, &list);
+    for (size_t i = 0; i < list.count; i++) {
+        printToken(symbolFileAppend, source, &list.tokens[i]);
+    }
+    freeTokenList(&list);
+}
+
+// Streaming lexer: the same DFA over a window that is refilled from a FILE*.
+// The window only has to hold the lexeme being lexed, so memory stays at the
+// window size (plus the longest lexeme, when it outgrows the window) however
+// large the input is. Lexed tokens wait in a small ring for lookahead, each
+// with its own copy of the lexeme.
+
+int openTokenStream(TokenStream *ts, FILE *input) {
+    memset(ts, 0, sizeof(*ts));
+    ts->input = input;
+    ts->lineNumber = 1;
+    ts->windowSize = TOKEN_STREAM_WINDOW;
+    ts->window = malloc(ts->windowSize);
+    return ts->window != NULL;
+}
+
+void closeTokenStream(TokenStream *ts) {
+    for (int i = 0; i < TOKEN_STREAM_SLOTS; i++) free(ts->slots[i].lexeme);
+    free(ts->window);
+    ts->window = NULL;
+}
+
+// Drop the window before keep, then read more input behind what is left;
+// the window doubles only when keep..filled already fills it
+static void refillStream(TokenStream *ts, size_t keep) {
+    memmove(ts->window, ts->window + keep, ts->filled - keep);
+    ts->windowStart += keep;
+    ts->position -= keep;
+    ts->filled -= keep;
+    if (ts->filled == ts->windowSize) {
+        unsigned char *grown = realloc(ts->window, ts->windowSize * 2);
+        if (!grown) {
+            fprintf(stderr, "Lexer Error: out of memory for a %zu-byte lexeme.\n", ts->filled);
+            exit(EXIT_FAILURE);
+        }
+        ts->window = grown;
+        ts->windowSize *= 2;
+    }
+    size_t n = fread(ts->window + ts->filled, 1, ts->windowSize - ts->filled, ts->input);
+    ts->filled += n;
+    if (n == 0) ts->atEnd = 1; //end of file or read error: either way no more input
+}
+
+// Lex the next token into slot; returns 0 at the end of the input
+static int lexStreamToken(TokenStream *ts, StreamToken *slot) {
+    LexerState currentState = S_START;
+    size_t tokenStart = ts->position;
+    int tokenStartLine = ts->lineNumber;
+    int accept = 0;
+
+    while (true) {
+        if (ts->position == ts->filled && !ts->atEnd) {
+            size_t keep = currentState == S_START ? ts->position : tokenStart;
+            refillStream(ts, keep);
+            tokenStart -= keep;
+            continue;
+        }
+        const unsigned char *cursor = ts->window + ts->position;
+        const unsigned char *end = ts->window + ts->filled;
+        switch (currentState) {
+            case S_START: cursor = skipSpace(cursor, end, &ts->lineNumber); break;
+            case S_IDENTIFIER: cursor = skipIdentifier(cursor, end); break;
+            case S_COMMENT_SINGLE: cursor = skipLine(cursor, end); break;
+            case S_COMMENT_MULTI_HEAD: cursor = skipComment(cursor, end, &ts->lineNumber); break;
+            case S_KWERDAS_BODY: cursor = skipString(cursor, end); break;
+            default: break;
+        }
+        ts->position = cursor - ts->window;
+        if (ts->position == ts->filled && !ts->atEnd) continue; //the run may go on past the window
+
+        if (currentState == S_START) {
+            tokenStart = ts->position;
+            tokenStartLine = ts->lineNumber;
+        }
+        int charClassOf = (cursor < end) ? charClass[*cursor] : CC_EOF;
+        unsigned int cell = lexerTable[currentState][charClassOf];
+        unsigned int flags = LEX_FLAGS(cell);
+
+        currentState = LEX_NEXT(cell);
+        ts->position += flags & LEX_CONSUME;
+        if (flags & LEX_NEWLINE) ts->lineNumber++;
+        if (flags & LEX_STOP) return 0;
+        if (flags & LEX_EMIT) {
+            accept = LEX_ACCEPT(cell);
+            break;
+        }
+    }
+
+    size_t length = ts->position - tokenStart;
+    if (length + 1 > slot->lexemeCapacity) {
+        size_t capacity = slot->lexemeCapacity ? slot->lexemeCapacity : 64;
+        while (capacity < length + 1) capacity *= 2;
+        char *grown = realloc(slot->lexeme, capacity);
+        if (!grown) {
+            fprintf(stderr, "Lexer Error: out of memory for a %zu-byte lexeme.\n", length);
+            exit(EXIT_FAILURE);
+        }
+        slot->lexeme = grown;
+        slot->lexemeCapacity = capacity;
+    }
+    memcpy(slot->lexeme, ts->window + tokenStart, length);
+    slot->lexeme[length] = '\0';
+    slot->token = acceptToken(accept, ts->window, tokenStart, length, tokenStartLine);
+    slot->token.offset += ts->windowStart; //from the start of the stream
+    return 1;
+}
+
+// Fill the ring up to k + 1 tokens ahead (or to the end of the input)
+static int bufferTokens(TokenStream *ts, int k) {
+    while (ts->buffered <= k && !ts->finished) {
+        StreamToken *slot = &ts->slots[(ts->first + ts->buffered) % TOKEN_STREAM_SLOTS];
+        if (lexStreamToken(ts, slot)) ts->buffered++;
+        else ts->finished = 1;
+    }
+    return ts->buffered > k;
+}
+
+// Take the next token; it stays valid until the next call to nextToken.
+// Returns NULL at the end of the input.
+const StreamToken *nextToken(TokenStream *ts) {
+    if (!bufferTokens(ts, 0)) return NULL;
+    const StreamToken *t = &ts->slots[ts->first];
+    ts->first = (ts->first + 1) % TOKEN_STREAM_SLOTS;
+    ts->buffered--;
+    return t;
+}
+
+// Look at the token k places after the next one (k = 0 is what nextToken
+// returns next) without taking it. Returns NULL past the end of the input,
+// or when k is beyond TOKEN_STREAM_LOOKAHEAD.
+const StreamToken *peekToken(TokenStream *ts, int k) {
+    if (k < 0 || k >= TOKEN_STREAM_LOOKAHEAD || !bufferTokens(ts, k)) return NULL;
+    return &ts->slots[(ts->first + k) % TOKEN_STREAM_SLOTS];
+}
+
+// Lexer function over a stream: writes the same lines as lexer() without
+// holding the input or the token list in memory
+int lexStream(FILE *input, FILE *symbolFileAppend) {
+    TokenStream ts;
+    if (!openTokenStream(&ts, input)) return 0;
+    const StreamToken *t;
+    while ((t = nextToken(&ts))) {
+        Token local = t->token;
+        local.offset = 0; //the lexeme is the slot's copy
+        printToken(symbolFileAppend, t->lexeme, &local);
+    }
+    closeTokenStream(&ts);
+    return 1;
+}
+
+//tokenValue to String
+const char *token_value_name(const Token *t) {
+    if (!t) return "(null)";
+    switch (t->category) {
+        case CAT_DELIMITER:
+            switch (t->tokenValue) {
+                case D_LPAREN: return "D_LPAREN";
+                case D_RPAREN: return "D_RPAREN";
+                case D_LBRACE: return "D_LBRACE";
+                case D_RBRACE: return "D_RBRACE";
+                case D_LBRACKET: return "D_LBRACKET";
+                case D_RBRACKET: return "D_RBRACKET";
+                case D_COMMA: return "D_COMMA";
+                case D_SEMICOLON: return "D_SEMICOLON";
+                case D_COLON: return "D_COLON";
+                case D_DOT: return "D_DOT";
+                case D_QUOTE: return "D_QUOTE";
+                case D_SQUOTE: return "D_SQUOTE";
+                default: return "D_UNKNOWN";
+            }
+
+        case CAT_OPERATOR:
+            switch (t->tokenValue) {
+                case O_PLUS: return "O_PLUS";
+                case O_MINUS: return "O_MINUS";
+                case O_MULTIPLY: return "O_MULTIPLY";
+                case O_DIVIDE: return "O_DIVIDE";
+                case O_POW: return "O_POW";
+                case O_MODULO: return "O_MODULO";
+                case O_ASSIGN: return "O_ASSIGN";
+                case O_EQUAL: return "O_EQUAL";
+                case O_NOT_EQUAL: return "O_NOT_EQUAL";
+                case O_LESS: return "O_LESS";
+                case O_GREATER: return "O_GREATER";
+                case O_LESS_EQ: return "O_LESS_EQ";
+                case O_GREATER_EQ: return "O_GREATER_EQ";
+                case O_AND: return "O_AND";
+                case O_OR: return "O_OR";
+                case O_NOT: return "O_NOT";
+                default: return "O_UNKNOWN";
+            }
+
+        case CAT_LITERAL:
+            switch (t->tokenValue) {
+                case L_IDENTIFIER: return "L_IDENTIFIER";
+                case L_BILANG_LITERAL: return "L_BILANG_LITERAL";
+                case L_LUTANG_LITERAL: return "L_LUTANG_LITERAL";
+                case L_KWERDAS_LITERAL: return "L_KWERDAS_LITERAL";
+                case L_TITIK_LITERAL: return "L_TITIK_LITERAL";
+                case L_BULYAN_LITERAL: return "L_BULYAN_LITERAL";
+                default: return "L_UNKNOWN";
+            }
+
+         case CAT_KEYWORD:
+            switch (t->tokenValue) {
+                case K_ANI: return "K_ANI";
+                case K_TANIM: return "K_TANIM";
+                case K_PARA: return "K_PARA";
+                case K_HABANG: return "K_HABANG";
+                case K_KUNG: return "K_KUNG";
+                case K_KUNDI: return "K_KUNDI";
+                case K_KUNDIMAN: return "K_KUNDIMAN";
+                case K_GAWIN: return "K_GAWIN";
+                case K_TIBAG: return "K_TIBAG";
+                case K_TULOY: return "K_TULOY";
+                case K_PANGKAT: return "K_PANGKAT";
+                case K_STATIK: return "K_STATIK";
+                case K_PRIBADO: return "K_PRIBADO";
+                case K_PROTEKTADO: return "K_PROTEKTADO";
+                case K_PUBLIKO: return "K_PUBLIKO";
+                default: return "K_UNKNOWN";
+            };
+
+        case CAT_RESERVED:
+            switch (t->tokenValue) {
+                case R_TAMA: return "R_TAMA";
+                case R_MALI: return "R_MALI";
+                case R_UGAT: return "R_UGAT";
+                case R_BALIK: return "R_BALIK";
+                case R_BILANG: return "R_BILANG";
+                case R_KWERDAS: return "R_KWERDAS";
+                case R_TITIK: return "R_TITIK";
+                case R_LUTANG: return "R_LUTANG";
+                case R_BULYAN: return "R_BULYAN";
+                case R_DOBLE: return "R_DOBLE";
+                case R_WALA: return "R_WALA";
+                case R_PI: return "R_PI";
+                case R_E_NUM: return "R_E_NUM";
+                case R_Kiss: return "R_Kiss";
+                case R_SAMPLE_CONST_STRING: return "R_SAMPLE_CONST_STRING";
+                default: return "R_UNKNOWN";
+            };
+
+        case CAT_NOISEWORD:
+            switch (t->tokenValue) {
+                case N_NG: return "N_NG";
+                case N_AY: return "N_AY";
+                case N_BUNGA: return "N_BUNGA";
+                case N_WAKAS: return "N_WAKAS";
+                case N_SA: return "N_SA";
+                case N_ANG: return "N_ANG";
+                case N_MULA: return "N_MULA";
+                case N_ITAKDA: return "N_ITAKDA";
+                default: return "N_UNKNOWN";
+            };
+         case CAT_COMMENT:
+            switch (t->tokenValue) {
+                case C_SINGLE_LINE: return "C_SINGLE_LINE";
+                case C_MULTI_LINE: return "C_MULTI_LINE";
+                default: return "C_UNKNOWN";
+            }
+        default: 
+            return "UNKNOWN_CATEGORY";
+    }
+}
+
+//Print token as in this format:
+// Lexeme | Token | LineNumber
+// (the precision stops at the span end, or at a NUL byte like the old C string did)
+void printToken(FILE *file, const char *source, const Token *t) {
+    const char *name = token_value_name(t);
+    fprintf(file, "%-15.*s | %-20s | %d \n", (int)t->length, source + t->offset, name, t -> lineNumber);
+}
+
+//create a token
+Token makeToken(TokenCategory cat, int tokenValue, size_t offset, size_t length, int lineNumber) {
+    Token t;
+    t.category = cat;
+    t.tokenValue = tokenValue;
+    t.offset = offset;
+    t.length = (unsigned int)length;
+    t.lineNumber = lineNumber;
+    return t;
+}
+
+//copy a token's lexeme out as a C string, for callers that must keep or rewrite it
+char *tokenLexeme(const char *source, const Token *t) {
+    char *text = malloc(t->length + 1);
+    if (!text) return NULL;
+    memcpy(text, source + t->offset, t->length);
+    text[t->length] = '\0';
+    return text;
+}
@@ -1,8 +1,74 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stdio.h>
+#include <stddef.h>
+#include "tokens.h"
+
 // Expose the hash table functions
-void initialize_table(void);
 int hashLookup(const char *lexeme, int *category, int *value);
 
-#endif
\ No newline at end of file
+// Tokens of one source buffer, grown by doubling so a whole file costs a
+// handful of allocations; lexemes stay in the source buffer
+typedef struct {
+    Token *tokens;
+    size_t count;
+    size_t capacity;
+} TokenList;
+
+// Lexer: scans an in-memory source buffer into a token list
+void lexTokens(const char *source, size_t length, TokenList *list);
+// Same tokens, lexed in newline-aligned chunks on a pool of threads (lexer_parallel.c)
+void lexTokensParallel(const char *source, size_t length, TokenList *list, int threads);
+// One stretch of the buffer; the building block of both (see lexer.c)
+const char *lexTokenRange(const char *source, const char *from, const char *limit, size_t length,
+                          int *lineNumber, TokenList *list,
+                          const TokenList *speculative, size_t *resyncIndex);
+void freeTokenList(TokenList *list);
+
+// Streaming lexer: pulls tokens from a FILE* one at a time in constant memory,
+// with up to TOKEN_STREAM_LOOKAHEAD tokens of lookahead (see lexer.c)
+#ifndef TOKEN_STREAM_WINDOW
+#define TOKEN_STREAM_WINDOW (64 * 1024)     //input read per refill
+#endif
+#define TOKEN_STREAM_LOOKAHEAD 8
+#define TOKEN_STREAM_SLOTS (TOKEN_STREAM_LOOKAHEAD + 1) //+1 keeps the last token taken
+
+typedef struct {
+    Token token;            //offset counts bytes from the start of the stream
+    char *lexeme;           //NUL-terminated copy of the lexeme
+    size_t lexemeCapacity;
+} StreamToken;
+
+typedef struct {
+    FILE *input;
+    unsigned char *window;  //unread input, plus the lexeme in progress
+    size_t windowSize;      //grows only for a lexeme longer than the window
+    size_t windowStart;     //stream offset of window[0]
+    size_t position;        //next unread byte in the window
+    size_t filled;          //window bytes holding input
+    int atEnd;              //no more input to read
+    int finished;           //lexer reached the end of the input
+    int lineNumber;
+    StreamToken slots[TOKEN_STREAM_SLOTS]; //ring of lexed tokens
+    int first;              //slot of the next token
+    int buffered;           //tokens lexed but not yet taken
+} TokenStream;
+
+int openTokenStream(TokenStream *ts, FILE *input);  //returns 1 on success; input stays open
+const StreamToken *nextToken(TokenStream *ts);
+const StreamToken *peekToken(TokenStream *ts, int k);
+void closeTokenStream(TokenStream *ts);
+// Lexer: scans an in-memory source buffer and writes each token to symbolFileAppend
+void lexer(const char *source, size_t length, FILE *symbolFileAppend);
+// Same output, lexed from a stream instead of a buffer; returns 1 on success
+int lexStream(FILE *input, FILE *symbolFileAppend);
+Token makeToken(TokenCategory cat, int tokenValue, size_t offset, size_t length, int lineNumber);
+char *tokenLexeme(const char *source, const Token *t);
+const char *token_value_name(const Token *t);
+void printToken(FILE *file, const char *source, const Token *t);
+void writeSymbolTable(FILE *file, const char *source, const TokenList *list);
+// Binary token file (tokenfile.c, format in tokenfile.h), returns 1 on success
+int writeTokenFile(const char *filename, const char *source, const TokenList *list);
+
+#endif
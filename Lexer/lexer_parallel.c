@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tokens.h"
+#include "lexer.h"
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Parallel lexing of large sources.
+//
+// The buffer is cut into chunks that each begin right after a '\n'. At such a
+// point the sequential lexer can only be in one of two places: S_START, or
+// inside a /* */ comment. Every other token (identifiers, numbers, kwerdas and
+// titik literals, // comments) ends at the newline without taking it, so it
+// never crosses one. Each chunk is therefore lexed speculatively from S_START,
+// with line numbers counted from 0, and owns the tokens that start inside it.
+//
+// The chunks are then stitched in order. When the previous chunk stopped
+// exactly at this chunk's start the guess was right, and its tokens are copied
+// with their lines shifted. When a comment ran into the chunk, the chunk is
+// lexed again from where the comment ended, until a token starts at the same
+// place as one of the speculative tokens; both runs agree from there on, so the
+// rest of the speculative tokens are reused. The result is the same token list
+// lexTokens produces.
+
+#ifndef LEX_MIN_CHUNK
+#define LEX_MIN_CHUNK (256 * 1024)  //smaller sources are lexed sequentially
+#endif
+#define LEX_CHUNKS_PER_THREAD 4     //spare chunks even out uneven ones
+
+typedef struct {
+    const char *start;      //first byte, just after a '\n' (or the source start)
+    const char *limit;      //start of the next chunk
+    const char *stop;       //where the speculative lexer stopped, at or past limit
+    int endLine;            //its line there, counted from the chunk start
+    TokenList tokens;       //tokens starting in [start, limit), speculative lines
+} LexChunk;
+
+typedef struct {
+    const char *source;
+    size_t length;
+    LexChunk *chunks;
+    size_t chunkCount;
+    size_t nextChunk;       //next chunk to hand out
+#ifndef _WIN32
+    pthread_mutex_t lock;
+#endif
+} LexJob;
+
+static void lexChunk(const LexJob *job, LexChunk *chunk) {
+    chunk->endLine = 0;
+    chunk->tokens.tokens = NULL;
+    chunk->tokens.count = 0;
+    chunk->tokens.capacity = 0;
+    chunk->stop = lexTokenRange(job->source, chunk->start, chunk->limit, job->length,
+                                &chunk->endLine, &chunk->tokens, NULL, NULL);
+}
+
+#ifndef _WIN32
+static void *lexWorker(void *arg) {
+    LexJob *job = arg;
+    while (1) {
+        pthread_mutex_lock(&job->lock);
+        size_t i = job->nextChunk++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->chunkCount) break;
+        lexChunk(job, &job->chunks[i]);
+    }
+    return NULL;
+}
+#endif
+
+// Append tokens, moving them from the chunk's line numbers to the file's
+static void appendShifted(TokenList *list, const Token *tokens, size_t count, int lineShift) {
+    if (list->count + count > list->capacity) {
+        size_t capacity = list->capacity ? list->capacity : 1024;
+        while (capacity < list->count + count) capacity *= 2;
+        Token *grown = realloc(list->tokens, capacity * sizeof(Token));
+        if (!grown) {
+            fprintf(stderr, "Out of memory while lexing\n");
+            exit(EXIT_FAILURE);
+        }
+        list->tokens = grown;
+        list->capacity = capacity;
+    }
+    Token *out = list->tokens + list->count;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = tokens[i];
+        out[i].lineNumber += lineShift;
+    }
+    list->count += count;
+}
+
+// Cut the source into chunks of about equal size, each starting after a newline
+static size_t splitChunks(const char *source, size_t length, LexChunk *chunks, size_t chunkCount) {
+    const char *end = source + length;
+    const char *start = source;
+    size_t n = 0;
+    for (size_t i = 1; i <= chunkCount && start < end; i++) {
+        const char *limit = end;
+        if (i < chunkCount) {
+            const char *target = source + length / chunkCount * i;
+            if (target < start) target = start;
+            const char *newline = memchr(target, '\n', end - target);
+            limit = newline ? newline + 1 : end;
+        }
+        if (limit == start) continue;
+        chunks[n].start = start;
+        chunks[n].limit = limit;
+        n++;
+        start = limit;
+    }
+    return n;
+}
+
+void lexTokensParallel(const char *source, size_t length, TokenList *list, int threads) {
+    size_t chunkCount = threads > 1 ? (size_t)threads * LEX_CHUNKS_PER_THREAD : 1;
+    if (chunkCount > length / LEX_MIN_CHUNK) chunkCount = length / LEX_MIN_CHUNK;
+#ifdef _WIN32
+    chunkCount = 0; //no thread pool here
+#endif
+    if (chunkCount < 2) {
+        lexTokens(source, length, list);
+        return;
+    }
+
+    LexJob job;
+    job.source = source;
+    job.length = length;
+    job.chunks = malloc(chunkCount * sizeof(LexChunk));
+    if (!job.chunks) {
+        lexTokens(source, length, list);
+        return;
+    }
+    job.chunkCount = splitChunks(source, length, job.chunks, chunkCount);
+    job.nextChunk = 0;
+
+#ifndef _WIN32
+    pthread_t *workers = malloc(threads * sizeof(pthread_t));
+    int started = 0;
+    pthread_mutex_init(&job.lock, NULL);
+    while (workers && started < threads && pthread_create(&workers[started], NULL, lexWorker, &job) == 0) {
+        started++;
+    }
+    lexWorker(&job); //the calling thread works too, and finishes alone if no worker started
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    pthread_mutex_destroy(&job.lock);
+    free(workers);
+#endif
+
+    //stitch: the first chunk starts at line 1 in S_START, so its guess is always right
+    const char *resume = source; //where the sequential lexer is back in S_START
+    int line = 1;                //and its line there
+    list->tokens = NULL;
+    list->count = 0;
+    list->capacity = 0;
+    for (size_t i = 0; i < job.chunkCount; i++) {
+        LexChunk *chunk = &job.chunks[i];
+        if (resume >= chunk->limit) { //swallowed by a comment from an earlier chunk
+            freeTokenList(&chunk->tokens);
+            continue;
+        }
+        size_t reuse = 0;
+        int shift = line;
+        if (resume != chunk->start) { //wrong guess: lex again until the two runs meet
+            reuse = chunk->tokens.count;
+            resume = lexTokenRange(source, resume, chunk->limit, length, &line, list, &chunk->tokens, &reuse);
+            if (reuse == chunk->tokens.count) { //never met; the fresh run covered the whole chunk
+                freeTokenList(&chunk->tokens);
+                continue;
+            }
+            shift = line - chunk->tokens.tokens[reuse].lineNumber;
+        }
+        appendShifted(list, chunk->tokens.tokens + reuse, chunk->tokens.count - reuse, shift);
+        resume = chunk->stop;
+        line = chunk->endLine + shift;
+        freeTokenList(&chunk->tokens);
+    }
+    free(job.chunks);
+}
@@ -0,0 +1,283 @@
+#ifndef LEXER_SPEC_H
+#define LEXER_SPEC_H
+
+#include "tokens.h"
+
+//States
+typedef enum {
+    S_START,   //Start state
+
+    //Words without quotes(" ")
+    S_IDENTIFIER,       
+    S_KEYWORD,  // Note: These are final states, decided *after* S_IDENTIFIER
+    S_RESERVE,  // Note: These are final states, decided *after* S_IDENTIFIER
+    S_NOISE,    // Note: These are final states, decided *after* S_IDENTIFIER
+
+    //Numbers
+    S_NUMBER_BILANG,
+    S_NUMBER_LUTANG,
+
+    //Strings & characters
+    S_KWERDAS_HEAD,   //for double quote start
+    S_KWERDAS_BODY,    //main string
+    S_KWERDAS_TAIL,    //last double quote
+
+    //Strings & characters
+    S_TITIK_HEAD,   //for single quote start
+    S_TITIK_BODY,    //main charatcer 
+    S_TITIK_TAIL,    //last single quote
+
+    // Operators
+    S_OP_PLUS,
+    S_OP_MINUS,        
+    S_OP_MULTIPLY,
+    S_OP_POW,
+    S_OP_MOD,      
+    S_OP_DIVIDE_HEAD,      // /  (may lead to comments)
+    S_OP_INT_DIVIDE,  // (\)    
+    S_OP_ASSIGN_HEAD,      // =
+    S_OP_ASSIGN_TAIL,  // == (Final State)
+    S_OP_NOT_HEAD,         // !
+    S_OP_NOT_TAIL,     // != or ! (Final State)
+    S_OP_LESS_HEAD,        // <
+    S_OP_LESS_TAIL,    // <= or < (Final State)
+    S_OP_GREATER_HEAD,     // >
+    S_OP_GREATER_TAIL, // >= or > (Final State)
+    S_OP_AND_HEAD,     //&
+    S_OP_AND_TAIL,     // && (Final State)
+    S_OP_OR_HEAD,      // |  
+    S_OP_OR_TAIL,      // || (Final State)
+
+    //Comments
+    S_COMMENT_SINGLE,  // //
+    S_COMMENT_MULTI_HEAD,   // /*
+    S_COMMENT_MULTI_TAIL, // checking for */
+
+    // Delimiters
+    S_DELIMITER,       // ( ) { } [ ] , . ; etc. (Final State)
+
+    // End / Unknown
+    S_UNKNOWN,
+    S_DONE // (Unused in this implementation)
+} LexerState;
+
+// ============ TOKEN SPECIFICATION ============
+// Everything the table-driven lexer in lexer.c knows about the language is
+// listed here once. The lists are X-macros: lexer.c expands them into constant
+// tables at compile time, so there is no runtime set-up.
+
+//Character classes (the DFA looks at the class of a character, not the character).
+//CC_OTHER must stay first: bytes not listed in LEXER_CHARS get class 0.
+#define LEXER_CHAR_CLASSES(X, a, b) \
+    X(CC_OTHER, a, b)      \
+    X(CC_EOF, a, b)        \
+    X(CC_SPACE, a, b)      /* ' ' \t \v \f \r */ \
+    X(CC_NEWLINE, a, b)    \
+    X(CC_ALPHA, a, b)      \
+    X(CC_DIGIT, a, b)      \
+    X(CC_UNDERSCORE, a, b) \
+    X(CC_DQUOTE, a, b)     \
+    X(CC_SQUOTE, a, b)     \
+    X(CC_SLASH, a, b)      \
+    X(CC_STAR, a, b)       \
+    X(CC_AMP, a, b)        \
+    X(CC_PIPE, a, b)       \
+    X(CC_EQUALS, a, b)     \
+    X(CC_BANG, a, b)       \
+    X(CC_LESS, a, b)       \
+    X(CC_GREATER, a, b)    \
+    X(CC_DOT, a, b)        \
+    X(CC_OPERATOR, a, b)   /* + - ^ % */ \
+    X(CC_BACKSLASH, a, b)  \
+    X(CC_DELIMITER, a, b)  /* ; { } ( ) [ ] , */ \
+    X(CC_NUL, a, b)        /* '\0' ends an unknown lexeme like the operator characters do */
+
+#define LEX_ENUM_NAME(name, a, b) name,
+typedef enum { LEXER_CHAR_CLASSES(LEX_ENUM_NAME, _, _) CC_COUNT } CharClass;
+
+//Character -> class
+#define LEXER_CHARS(X) \
+    X(' ', CC_SPACE) X('\t', CC_SPACE) X('\v', CC_SPACE) X('\f', CC_SPACE) X('\r', CC_SPACE) \
+    X('\n', CC_NEWLINE) \
+    X('a', CC_ALPHA) X('b', CC_ALPHA) X('c', CC_ALPHA) X('d', CC_ALPHA) X('e', CC_ALPHA) \
+    X('f', CC_ALPHA) X('g', CC_ALPHA) X('h', CC_ALPHA) X('i', CC_ALPHA) X('j', CC_ALPHA) \
+    X('k', CC_ALPHA) X('l', CC_ALPHA) X('m', CC_ALPHA) X('n', CC_ALPHA) X('o', CC_ALPHA) \
+    X('p', CC_ALPHA) X('q', CC_ALPHA) X('r', CC_ALPHA) X('s', CC_ALPHA) X('t', CC_ALPHA) \
+    X('u', CC_ALPHA) X('v', CC_ALPHA) X('w', CC_ALPHA) X('x', CC_ALPHA) X('y', CC_ALPHA) \
+    X('z', CC_ALPHA) \
+    X('A', CC_ALPHA) X('B', CC_ALPHA) X('C', CC_ALPHA) X('D', CC_ALPHA) X('E', CC_ALPHA) \
+    X('F', CC_ALPHA) X('G', CC_ALPHA) X('H', CC_ALPHA) X('I', CC_ALPHA) X('J', CC_ALPHA) \
+    X('K', CC_ALPHA) X('L', CC_ALPHA) X('M', CC_ALPHA) X('N', CC_ALPHA) X('O', CC_ALPHA) \
+    X('P', CC_ALPHA) X('Q', CC_ALPHA) X('R', CC_ALPHA) X('S', CC_ALPHA) X('T', CC_ALPHA) \
+    X('U', CC_ALPHA) X('V', CC_ALPHA) X('W', CC_ALPHA) X('X', CC_ALPHA) X('Y', CC_ALPHA) \
+    X('Z', CC_ALPHA) \
+    X('0', CC_DIGIT) X('1', CC_DIGIT) X('2', CC_DIGIT) X('3', CC_DIGIT) X('4', CC_DIGIT) \
+    X('5', CC_DIGIT) X('6', CC_DIGIT) X('7', CC_DIGIT) X('8', CC_DIGIT) X('9', CC_DIGIT) \
+    X('_', CC_UNDERSCORE) X('"', CC_DQUOTE) X('\'', CC_SQUOTE) \
+    X('/', CC_SLASH) X('*', CC_STAR) X('&', CC_AMP) X('|', CC_PIPE) \
+    X('=', CC_EQUALS) X('!', CC_BANG) X('<', CC_LESS) X('>', CC_GREATER) X('.', CC_DOT) \
+    X('+', CC_OPERATOR) X('-', CC_OPERATOR) X('^', CC_OPERATOR) X('%', CC_OPERATOR) \
+    X('\\', CC_BACKSLASH) \
+    X(';', CC_DELIMITER) X('{', CC_DELIMITER) X('}', CC_DELIMITER) X('(', CC_DELIMITER) \
+    X(')', CC_DELIMITER) X('[', CC_DELIMITER) X(']', CC_DELIMITER) X(',', CC_DELIMITER) \
+    X('\0', CC_NUL)
+
+//Accept actions: the token a lexeme becomes when it ends.
+//ACC_IDENTIFIER, ACC_LUTANG and ACC_SINGLE_CHAR are refined in lexer.c.
+#define LEXER_ACCEPTS(X) \
+    X(ACC_NONE,           CAT_UNKNOWN,   0) \
+    X(ACC_UNKNOWN,        CAT_UNKNOWN,   0) \
+    X(ACC_IDENTIFIER,     CAT_LITERAL,   L_IDENTIFIER)      /* unless it is a keyword/reserved/noise word */ \
+    X(ACC_BILANG,         CAT_LITERAL,   L_BILANG_LITERAL)  \
+    X(ACC_LUTANG,         CAT_LITERAL,   L_LUTANG_LITERAL)  /* unknown if it ends in '.' */ \
+    X(ACC_KWERDAS,        CAT_LITERAL,   L_KWERDAS_LITERAL) \
+    X(ACC_TITIK,          CAT_LITERAL,   L_TITIK_LITERAL)   \
+    X(ACC_QUOTE,          CAT_DELIMITER, D_QUOTE)           \
+    X(ACC_SQUOTE,         CAT_DELIMITER, D_SQUOTE)          \
+    X(ACC_SINGLE_CHAR,    CAT_UNKNOWN,   0)                 /* see LEXER_SINGLE_CHAR_TOKENS */ \
+    X(ACC_DIVIDE,         CAT_OPERATOR,  O_DIVIDE)          \
+    X(ACC_ASSIGN,         CAT_OPERATOR,  O_ASSIGN)          \
+    X(ACC_EQUAL,          CAT_OPERATOR,  O_EQUAL)           \
+    X(ACC_NOT,            CAT_OPERATOR,  O_NOT)             \
+    X(ACC_NOT_EQUAL,      CAT_OPERATOR,  O_NOT_EQUAL)       \
+    X(ACC_LESS,           CAT_OPERATOR,  O_LESS)            \
+    X(ACC_LESS_EQ,        CAT_OPERATOR,  O_LESS_EQ)         \
+    X(ACC_GREATER,        CAT_OPERATOR,  O_GREATER)         \
+    X(ACC_GREATER_EQ,     CAT_OPERATOR,  O_GREATER_EQ)      \
+    X(ACC_AND,            CAT_OPERATOR,  O_AND)             \
+    X(ACC_OR,             CAT_OPERATOR,  O_OR)              \
+    X(ACC_COMMENT_SINGLE, CAT_COMMENT,   C_SINGLE_LINE)     \
+    X(ACC_COMMENT_MULTI,  CAT_COMMENT,   C_MULTI_LINE)
+
+typedef enum { LEXER_ACCEPTS(LEX_ENUM_NAME) ACC_COUNT } AcceptAction;
+
+//Operators and delimiters that are a token all by themselves
+#define LEXER_SINGLE_CHAR_TOKENS(X) \
+    X('+', CAT_OPERATOR, O_PLUS) X('-', CAT_OPERATOR, O_MINUS) X('*', CAT_OPERATOR, O_MULTIPLY) \
+    X('^', CAT_OPERATOR, O_POW) X('%', CAT_OPERATOR, O_MODULO) X('\\', CAT_OPERATOR, O_INT_DIVIDE) \
+    X(';', CAT_DELIMITER, D_SEMICOLON) X('{', CAT_DELIMITER, D_LBRACE) X('}', CAT_DELIMITER, D_RBRACE) \
+    X('(', CAT_DELIMITER, D_LPAREN) X(')', CAT_DELIMITER, D_RPAREN) X('[', CAT_DELIMITER, D_LBRACKET) \
+    X(']', CAT_DELIMITER, D_RBRACKET) X(',', CAT_DELIMITER, D_COMMA) X('.', CAT_DELIMITER, D_DOT)
+
+//Transition cells: next state (6 bits) | action flags (4 bits) | accept action (6 bits)
+#define LEX_CONSUME 1   //take the character into the lexeme (otherwise it is read again)
+#define LEX_EMIT    2   //the lexeme is complete: emit it and go back to S_START
+#define LEX_NEWLINE 4   //count a line
+#define LEX_STOP    8   //end of input in S_START
+
+#define LEX_CELL(next, flags, accept) ((unsigned short)((next) | ((flags) << 6) | ((accept) << 10)))
+#define LEX_NEXT(cell)   ((LexerState)((cell) & 0x3F))
+#define LEX_FLAGS(cell)  (((cell) >> 6) & 0xF)
+#define LEX_ACCEPT(cell) ((cell) >> 10)
+
+#define LEX_SHIFT(next)    LEX_CELL(next, LEX_CONSUME, ACC_NONE)
+#define LEX_SHIFT_NL(next) LEX_CELL(next, LEX_CONSUME | LEX_NEWLINE, ACC_NONE)
+#define LEX_RETRY(next)    LEX_CELL(next, 0, ACC_NONE)
+#define LEX_EMIT_AS(acc)   LEX_CELL(S_START, LEX_EMIT, acc)
+#define LEX_EMIT_NL(acc)   LEX_CELL(S_START, LEX_EMIT | LEX_NEWLINE, acc)
+#define LEX_TAKE_EMIT(acc) LEX_CELL(S_START, LEX_CONSUME | LEX_EMIT, acc)
+#define LEX_END            LEX_CELL(S_START, LEX_STOP, ACC_NONE)
+
+//Transitions. ROW(state, cell) sets every class of a state, ON(state, class, cell)
+//then overrides one class (later entries win). Rows that shift by default must
+//override CC_EOF, because end of input can't be consumed.
+//The *_NL emits keep the old lexer's line count: the newline that ends an
+//unterminated string, character or unknown lexeme is counted there and again
+//when S_START reads it.
+#define LEXER_TRANSITIONS(ROW, ON) \
+    ROW(S_START,                                LEX_SHIFT(S_UNKNOWN)) \
+    ON(S_START, CC_EOF,                         LEX_END) \
+    ON(S_START, CC_SPACE,                       LEX_SHIFT(S_START)) \
+    ON(S_START, CC_NEWLINE,                     LEX_SHIFT_NL(S_START)) \
+    ON(S_START, CC_ALPHA,                       LEX_SHIFT(S_IDENTIFIER)) \
+    ON(S_START, CC_DIGIT,                       LEX_SHIFT(S_NUMBER_BILANG)) \
+    ON(S_START, CC_DQUOTE,                      LEX_SHIFT(S_KWERDAS_HEAD)) \
+    ON(S_START, CC_SQUOTE,                      LEX_SHIFT(S_TITIK_HEAD)) \
+    ON(S_START, CC_SLASH,                       LEX_SHIFT(S_OP_DIVIDE_HEAD)) \
+    ON(S_START, CC_AMP,                         LEX_SHIFT(S_OP_AND_HEAD)) \
+    ON(S_START, CC_PIPE,                        LEX_SHIFT(S_OP_OR_HEAD)) \
+    ON(S_START, CC_EQUALS,                      LEX_SHIFT(S_OP_ASSIGN_HEAD)) \
+    ON(S_START, CC_BANG,                        LEX_SHIFT(S_OP_NOT_HEAD)) \
+    ON(S_START, CC_LESS,                        LEX_SHIFT(S_OP_LESS_HEAD)) \
+    ON(S_START, CC_GREATER,                     LEX_SHIFT(S_OP_GREATER_HEAD)) \
+    ON(S_START, CC_STAR,                        LEX_TAKE_EMIT(ACC_SINGLE_CHAR)) \
+    ON(S_START, CC_OPERATOR,                    LEX_TAKE_EMIT(ACC_SINGLE_CHAR)) \
+    ON(S_START, CC_BACKSLASH,                   LEX_TAKE_EMIT(ACC_SINGLE_CHAR)) \
+    ON(S_START, CC_DELIMITER,                   LEX_TAKE_EMIT(ACC_SINGLE_CHAR)) \
+    ON(S_START, CC_DOT,                         LEX_TAKE_EMIT(ACC_SINGLE_CHAR)) \
+    \
+    ROW(S_IDENTIFIER,                           LEX_EMIT_AS(ACC_IDENTIFIER)) \
+    ON(S_IDENTIFIER, CC_ALPHA,                  LEX_SHIFT(S_IDENTIFIER)) \
+    ON(S_IDENTIFIER, CC_DIGIT,                  LEX_SHIFT(S_IDENTIFIER)) \
+    ON(S_IDENTIFIER, CC_UNDERSCORE,             LEX_SHIFT(S_IDENTIFIER)) \
+    \
+    ROW(S_NUMBER_BILANG,                        LEX_EMIT_AS(ACC_BILANG)) \
+    ON(S_NUMBER_BILANG, CC_DIGIT,               LEX_SHIFT(S_NUMBER_BILANG)) \
+    ON(S_NUMBER_BILANG, CC_DOT,                 LEX_SHIFT(S_NUMBER_LUTANG)) \
+    ON(S_NUMBER_BILANG, CC_ALPHA,               LEX_SHIFT(S_UNKNOWN)) \
+    ROW(S_NUMBER_LUTANG,                        LEX_EMIT_AS(ACC_LUTANG)) \
+    ON(S_NUMBER_LUTANG, CC_DIGIT,               LEX_SHIFT(S_NUMBER_LUTANG)) \
+    \
+    ROW(S_KWERDAS_HEAD,                         LEX_SHIFT(S_KWERDAS_BODY)) \
+    ON(S_KWERDAS_HEAD, CC_DQUOTE,               LEX_TAKE_EMIT(ACC_KWERDAS)) \
+    ON(S_KWERDAS_HEAD, CC_NEWLINE,              LEX_EMIT_NL(ACC_QUOTE)) \
+    ON(S_KWERDAS_HEAD, CC_EOF,                  LEX_EMIT_AS(ACC_QUOTE)) \
+    ROW(S_KWERDAS_BODY,                         LEX_SHIFT(S_KWERDAS_BODY)) \
+    ON(S_KWERDAS_BODY, CC_DQUOTE,               LEX_TAKE_EMIT(ACC_KWERDAS)) \
+    ON(S_KWERDAS_BODY, CC_NEWLINE,              LEX_EMIT_NL(ACC_UNKNOWN)) \
+    ON(S_KWERDAS_BODY, CC_EOF,                  LEX_EMIT_AS(ACC_UNKNOWN)) \
+    \
+    ROW(S_TITIK_HEAD,                           LEX_SHIFT(S_TITIK_BODY)) \
+    ON(S_TITIK_HEAD, CC_SQUOTE,                 LEX_EMIT_AS(ACC_SQUOTE)) \
+    ON(S_TITIK_HEAD, CC_NEWLINE,                LEX_EMIT_NL(ACC_SQUOTE)) \
+    ON(S_TITIK_HEAD, CC_EOF,                    LEX_EMIT_AS(ACC_SQUOTE)) \
+    ROW(S_TITIK_BODY,                           LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_TITIK_BODY, CC_SQUOTE,                 LEX_TAKE_EMIT(ACC_TITIK)) \
+    \
+    ROW(S_OP_DIVIDE_HEAD,                       LEX_EMIT_AS(ACC_DIVIDE)) \
+    ON(S_OP_DIVIDE_HEAD, CC_SLASH,              LEX_SHIFT(S_COMMENT_SINGLE)) \
+    ON(S_OP_DIVIDE_HEAD, CC_STAR,               LEX_SHIFT(S_COMMENT_MULTI_HEAD)) \
+    ROW(S_COMMENT_SINGLE,                       LEX_SHIFT(S_COMMENT_SINGLE)) \
+    ON(S_COMMENT_SINGLE, CC_NEWLINE,            LEX_EMIT_AS(ACC_COMMENT_SINGLE)) \
+    ON(S_COMMENT_SINGLE, CC_EOF,                LEX_EMIT_AS(ACC_COMMENT_SINGLE)) \
+    ROW(S_COMMENT_MULTI_HEAD,                   LEX_SHIFT(S_COMMENT_MULTI_HEAD)) \
+    ON(S_COMMENT_MULTI_HEAD, CC_STAR,           LEX_SHIFT(S_COMMENT_MULTI_TAIL)) \
+    ON(S_COMMENT_MULTI_HEAD, CC_NEWLINE,        LEX_SHIFT_NL(S_COMMENT_MULTI_HEAD)) \
+    ON(S_COMMENT_MULTI_HEAD, CC_EOF,            LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ROW(S_COMMENT_MULTI_TAIL,                   LEX_SHIFT(S_COMMENT_MULTI_HEAD)) \
+    ON(S_COMMENT_MULTI_TAIL, CC_SLASH,          LEX_TAKE_EMIT(ACC_COMMENT_MULTI)) \
+    ON(S_COMMENT_MULTI_TAIL, CC_STAR,           LEX_SHIFT(S_COMMENT_MULTI_TAIL)) \
+    ON(S_COMMENT_MULTI_TAIL, CC_NEWLINE,        LEX_SHIFT_NL(S_COMMENT_MULTI_HEAD)) \
+    ON(S_COMMENT_MULTI_TAIL, CC_EOF,            LEX_EMIT_AS(ACC_UNKNOWN)) \
+    \
+    ROW(S_OP_ASSIGN_HEAD,                       LEX_EMIT_AS(ACC_ASSIGN)) \
+    ON(S_OP_ASSIGN_HEAD, CC_EQUALS,             LEX_TAKE_EMIT(ACC_EQUAL)) \
+    ROW(S_OP_NOT_HEAD,                          LEX_EMIT_AS(ACC_NOT)) \
+    ON(S_OP_NOT_HEAD, CC_EQUALS,                LEX_TAKE_EMIT(ACC_NOT_EQUAL)) \
+    ROW(S_OP_LESS_HEAD,                         LEX_EMIT_AS(ACC_LESS)) \
+    ON(S_OP_LESS_HEAD, CC_EQUALS,               LEX_TAKE_EMIT(ACC_LESS_EQ)) \
+    ROW(S_OP_GREATER_HEAD,                      LEX_EMIT_AS(ACC_GREATER)) \
+    ON(S_OP_GREATER_HEAD, CC_EQUALS,            LEX_TAKE_EMIT(ACC_GREATER_EQ)) \
+    ROW(S_OP_AND_HEAD,                          LEX_RETRY(S_UNKNOWN)) \
+    ON(S_OP_AND_HEAD, CC_AMP,                   LEX_TAKE_EMIT(ACC_AND)) \
+    ROW(S_OP_OR_HEAD,                           LEX_RETRY(S_UNKNOWN)) \
+    ON(S_OP_OR_HEAD, CC_PIPE,                   LEX_TAKE_EMIT(ACC_OR)) \
+    \
+    ROW(S_UNKNOWN,                              LEX_SHIFT(S_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_EOF,                       LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_SPACE,                     LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_NEWLINE,                   LEX_EMIT_NL(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_SLASH,                     LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_STAR,                      LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_AMP,                       LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_PIPE,                      LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_EQUALS,                    LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_BANG,                      LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_LESS,                      LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_GREATER,                   LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_DOT,                       LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_OPERATOR,                  LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_DELIMITER,                 LEX_EMIT_AS(ACC_UNKNOWN)) \
+    ON(S_UNKNOWN, CC_NUL,                       LEX_EMIT_AS(ACC_UNKNOWN))
+
+#endif
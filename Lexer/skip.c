@@ -0,0 +1,360 @@
+#include <stdint.h>
+#include <string.h>
+#include "skip.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ============ SCALAR: one byte at a time, like the DFA ============
+
+static int isSpaceByte(unsigned int c) {
+    return c == ' ' || c - '\t' <= '\r' - '\t'; // \t \n \v \f \r are contiguous
+}
+
+static int isIdentifierByte(unsigned int c) {
+    return (c | 0x20) - 'a' < 26u || c - '0' < 10u || c == '_';
+}
+
+static const unsigned char *scalarSpace(const unsigned char *p, const unsigned char *end, int *lines) {
+    for (; p < end && isSpaceByte(*p); p++) {
+        *lines += *p == '\n';
+    }
+    return p;
+}
+
+static const unsigned char *scalarIdentifier(const unsigned char *p, const unsigned char *end) {
+    while (p < end && isIdentifierByte(*p)) p++;
+    return p;
+}
+
+static const unsigned char *scalarLine(const unsigned char *p, const unsigned char *end) {
+    while (p < end && *p != '\n') p++;
+    return p;
+}
+
+static const unsigned char *scalarComment(const unsigned char *p, const unsigned char *end, int *lines) {
+    for (; p < end && *p != '*'; p++) {
+        *lines += *p == '\n';
+    }
+    return p;
+}
+
+static const unsigned char *scalarString(const unsigned char *p, const unsigned char *end) {
+    while (p < end && *p != '"' && *p != '\n') p++;
+    return p;
+}
+
+// ============ SWAR: eight bytes per 64-bit word ============
+// Masks have the high bit of a byte set when the byte matches. Each byte's
+// sums stay below 0x100, so no carry ever crosses into the next byte.
+
+#define SWAR_ONES 0x0101010101010101ull
+#define SWAR_HIGH 0x8080808080808080ull
+
+static uint64_t load64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v); //byte 0 in the low bits, as on little-endian
+#endif
+    return v;
+}
+
+static uint64_t swarInRange(uint64_t v, unsigned int lo, unsigned int hi) {
+    uint64_t low7 = v & ~SWAR_HIGH;
+    uint64_t atLeastLo = low7 + SWAR_ONES * (0x80 - lo);
+    uint64_t aboveHi = low7 + SWAR_ONES * (0x7F - hi);
+    return atLeastLo & ~aboveHi & ~v & SWAR_HIGH;
+}
+
+static uint64_t swarEq(uint64_t v, unsigned int c) {
+    return swarInRange(v, c, c);
+}
+
+//index of the first matching byte / mask of the bytes before it
+#define SWAR_FIRST(mask) ((size_t)__builtin_ctzll(mask) >> 3)
+#define SWAR_BEFORE(mask) (((mask) & (0 - (mask))) - 1)
+
+static const unsigned char *swarSpace(const unsigned char *p, const unsigned char *end, int *lines) {
+    while (end - p >= 8) {
+        uint64_t v = load64(p);
+        uint64_t stop = ~(swarEq(v, ' ') | swarInRange(v, '\t', '\r')) & SWAR_HIGH;
+        uint64_t newlines = swarEq(v, '\n');
+        if (stop) {
+            *lines += __builtin_popcountll(newlines & SWAR_BEFORE(stop));
+            return p + SWAR_FIRST(stop);
+        }
+        *lines += __builtin_popcountll(newlines);
+        p += 8;
+    }
+    return scalarSpace(p, end, lines);
+}
+
+static const unsigned char *swarIdentifier(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 8) {
+        uint64_t v = load64(p);
+        uint64_t word = swarInRange(v | SWAR_ONES * 0x20, 'a', 'z') | swarInRange(v, '0', '9') |
+                        swarEq(v, '_');
+        uint64_t stop = ~word & SWAR_HIGH;
+        if (stop) return p + SWAR_FIRST(stop);
+        p += 8;
+    }
+    return scalarIdentifier(p, end);
+}
+
+static const unsigned char *swarLine(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 8) {
+        uint64_t stop = swarEq(load64(p), '\n');
+        if (stop) return p + SWAR_FIRST(stop);
+        p += 8;
+    }
+    return scalarLine(p, end);
+}
+
+static const unsigned char *swarComment(const unsigned char *p, const unsigned char *end, int *lines) {
+    while (end - p >= 8) {
+        uint64_t v = load64(p);
+        uint64_t stop = swarEq(v, '*');
+        uint64_t newlines = swarEq(v, '\n');
+        if (stop) {
+            *lines += __builtin_popcountll(newlines & SWAR_BEFORE(stop));
+            return p + SWAR_FIRST(stop);
+        }
+        *lines += __builtin_popcountll(newlines);
+        p += 8;
+    }
+    return scalarComment(p, end, lines);
+}
+
+static const unsigned char *swarString(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 8) {
+        uint64_t v = load64(p);
+        uint64_t stop = swarEq(v, '"') | swarEq(v, '\n');
+        if (stop) return p + SWAR_FIRST(stop);
+        p += 8;
+    }
+    return scalarString(p, end);
+}
+
+// ============ SSE2: sixteen bytes per vector ============
+// The same five kernels; what is left after the last full vector goes to SWAR.
+
+#if defined(__SSE2__)
+
+#define FIRST(mask) ((size_t)__builtin_ctz(mask))
+#define BEFORE(mask) (((mask) & (0u - (mask))) - 1)
+
+static __m128i sse2InRange(__m128i x, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8((char)(hi - lo))), shifted);
+}
+
+static unsigned int sse2Eq(__m128i x, char c) {
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8(c)));
+}
+
+static const unsigned char *sse2Space(const unsigned char *p, const unsigned char *end, int *lines) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), sse2InRange(x, '\t', '\r'));
+        unsigned int stop = ~(unsigned int)_mm_movemask_epi8(space) & 0xFFFF;
+        unsigned int newlines = sse2Eq(x, '\n');
+        if (stop) {
+            *lines += __builtin_popcount(newlines & BEFORE(stop));
+            return p + FIRST(stop);
+        }
+        *lines += __builtin_popcount(newlines);
+        p += 16;
+    }
+    return swarSpace(p, end, lines);
+}
+
+static const unsigned char *sse2Identifier(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i word = _mm_or_si128(_mm_or_si128(sse2InRange(lower, 'a', 'z'), sse2InRange(x, '0', '9')),
+                                    _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+        unsigned int stop = ~(unsigned int)_mm_movemask_epi8(word) & 0xFFFF;
+        if (stop) return p + FIRST(stop);
+        p += 16;
+    }
+    return swarIdentifier(p, end);
+}
+
+static const unsigned char *sse2Line(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 16) {
+        unsigned int stop = sse2Eq(_mm_loadu_si128((const __m128i *)p), '\n');
+        if (stop) return p + FIRST(stop);
+        p += 16;
+    }
+    return swarLine(p, end);
+}
+
+static const unsigned char *sse2Comment(const unsigned char *p, const unsigned char *end, int *lines) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        unsigned int stop = sse2Eq(x, '*');
+        unsigned int newlines = sse2Eq(x, '\n');
+        if (stop) {
+            *lines += __builtin_popcount(newlines & BEFORE(stop));
+            return p + FIRST(stop);
+        }
+        *lines += __builtin_popcount(newlines);
+        p += 16;
+    }
+    return swarComment(p, end, lines);
+}
+
+static const unsigned char *sse2String(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        unsigned int stop = sse2Eq(x, '"') | sse2Eq(x, '\n');
+        if (stop) return p + FIRST(stop);
+        p += 16;
+    }
+    return swarString(p, end);
+}
+
+#endif
+
+// ============ AVX2: thirty-two bytes per vector ============
+
+#if defined(__AVX2__)
+
+static __m256i avx2InRange(__m256i x, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8((char)(hi - lo))), shifted);
+}
+
+static unsigned int avx2Eq(__m256i x, char c) {
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(c)));
+}
+
+static const unsigned char *avx2Space(const unsigned char *p, const unsigned char *end, int *lines) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                                        avx2InRange(x, '\t', '\r'));
+        unsigned int stop = ~(unsigned int)_mm256_movemask_epi8(space);
+        unsigned int newlines = avx2Eq(x, '\n');
+        if (stop) {
+            *lines += __builtin_popcount(newlines & BEFORE(stop));
+            return p + FIRST(stop);
+        }
+        *lines += __builtin_popcount(newlines);
+        p += 32;
+    }
+    return sse2Space(p, end, lines);
+}
+
+static const unsigned char *avx2Identifier(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i word = _mm256_or_si256(_mm256_or_si256(avx2InRange(lower, 'a', 'z'), avx2InRange(x, '0', '9')),
+                                       _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+        unsigned int stop = ~(unsigned int)_mm256_movemask_epi8(word);
+        if (stop) return p + FIRST(stop);
+        p += 32;
+    }
+    return sse2Identifier(p, end);
+}
+
+static const unsigned char *avx2Line(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 32) {
+        unsigned int stop = avx2Eq(_mm256_loadu_si256((const __m256i *)p), '\n');
+        if (stop) return p + FIRST(stop);
+        p += 32;
+    }
+    return sse2Line(p, end);
+}
+
+static const unsigned char *avx2Comment(const unsigned char *p, const unsigned char *end, int *lines) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        unsigned int stop = avx2Eq(x, '*');
+        unsigned int newlines = avx2Eq(x, '\n');
+        if (stop) {
+            *lines += __builtin_popcount(newlines & BEFORE(stop));
+            return p + FIRST(stop);
+        }
+        *lines += __builtin_popcount(newlines);
+        p += 32;
+    }
+    return sse2Comment(p, end, lines);
+}
+
+static const unsigned char *avx2String(const unsigned char *p, const unsigned char *end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        unsigned int stop = avx2Eq(x, '"') | avx2Eq(x, '\n');
+        if (stop) return p + FIRST(stop);
+        p += 32;
+    }
+    return sse2String(p, end);
+}
+
+#endif
+
+// ============ KERNEL SETS ============
+
+static const SkipKernels scalarKernels = {
+    "scalar", scalarSpace, scalarIdentifier, scalarLine, scalarComment, scalarString
+};
+static const SkipKernels swarKernels = {
+    "SWAR", swarSpace, swarIdentifier, swarLine, swarComment, swarString
+};
+#if defined(__SSE2__)
+static const SkipKernels sse2Kernels = {
+    "SSE2", sse2Space, sse2Identifier, sse2Line, sse2Comment, sse2String
+};
+#endif
+#if defined(__AVX2__)
+static const SkipKernels avx2Kernels = {
+    "AVX2", avx2Space, avx2Identifier, avx2Line, avx2Comment, avx2String
+};
+#endif
+
+const SkipKernels *const skipKernelSets[] = {
+#if defined(__AVX2__)
+    &avx2Kernels,
+#endif
+#if defined(__SSE2__)
+    &sse2Kernels,
+#endif
+    &swarKernels,
+    &scalarKernels,
+    NULL
+};
+
+#if defined(__AVX2__)
+#define BEST(kernel) avx2##kernel
+#elif defined(__SSE2__)
+#define BEST(kernel) sse2##kernel
+#else
+#define BEST(kernel) swar##kernel
+#endif
+
+const unsigned char *skipSpace(const unsigned char *p, const unsigned char *end, int *lines) {
+    return BEST(Space)(p, end, lines);
+}
+
+const unsigned char *skipIdentifier(const unsigned char *p, const unsigned char *end) {
+    return BEST(Identifier)(p, end);
+}
+
+const unsigned char *skipLine(const unsigned char *p, const unsigned char *end) {
+    return BEST(Line)(p, end);
+}
+
+const unsigned char *skipComment(const unsigned char *p, const unsigned char *end, int *lines) {
+    return BEST(Comment)(p, end, lines);
+}
+
+const unsigned char *skipString(const unsigned char *p, const unsigned char *end) {
+    return BEST(String)(p, end);
+}
@@ -0,0 +1,42 @@
+#ifndef SKIP_H
+#define SKIP_H
+
+#include <stddef.h>
+
+//Fast-skip kernels for the lexer's long-running states. Each one returns the
+//first byte that ends the run (or end); the DFA then takes that byte as usual.
+//Kernels that may pass newlines add them to *lines so lineNumber stays exact.
+//
+//  skipSpace       S_START whitespace: ' ' \t \v \f \r \n
+//  skipIdentifier  S_IDENTIFIER body: [A-Za-z0-9_]
+//  skipLine        S_COMMENT_SINGLE: up to '\n'
+//  skipComment     S_COMMENT_MULTI_HEAD: up to '*'
+//  skipString      S_KWERDAS_BODY: up to '"' or '\n'
+//
+//The lexer uses the widest implementation the compiler targets: AVX2 when built
+//with -mavx2 (or -march=native), else SSE2 (always there on x86-64), else SWAR
+//on 64-bit words, which works on any CPU.
+typedef const unsigned char *(*SkipFn)(const unsigned char *p, const unsigned char *end);
+typedef const unsigned char *(*SkipLinesFn)(const unsigned char *p, const unsigned char *end, int *lines);
+
+typedef struct {
+    const char *name;
+    SkipLinesFn space;
+    SkipFn identifier;
+    SkipFn line;
+    SkipLinesFn comment;
+    SkipFn string;
+} SkipKernels;
+
+//Every implementation built into this binary, widest first, ending with the
+//plain byte loop the kernels are checked and benchmarked against
+extern const SkipKernels *const skipKernelSets[];
+
+//The kernels the lexer calls
+const unsigned char *skipSpace(const unsigned char *p, const unsigned char *end, int *lines);
+const unsigned char *skipIdentifier(const unsigned char *p, const unsigned char *end);
+const unsigned char *skipLine(const unsigned char *p, const unsigned char *end);
+const unsigned char *skipComment(const unsigned char *p, const unsigned char *end, int *lines);
+const unsigned char *skipString(const unsigned char *p, const unsigned char *end);
+
+#endif
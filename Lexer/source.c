@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "source.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define READ_BLOCK_SIZE (1 << 16) //64 KB per fread when the input can't be mapped
+
+// Read a whole stream into a malloc'd buffer, one large block at a time
+int readSourceStream(SourceBuffer *src, FILE *stream) {
+    size_t capacity = READ_BLOCK_SIZE;
+    size_t length = 0;
+    char *data = malloc(capacity);
+    if (!data) return 0;
+
+    while (!feof(stream) && !ferror(stream)) {
+        if (capacity - length < READ_BLOCK_SIZE) { //double the buffer when it runs low
+            char *grown = realloc(data, capacity * 2);
+            if (!grown) {
+                free(data);
+                return 0;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+        length += fread(data + length, 1, capacity - length, stream);
+    }
+    if (ferror(stream)) {
+        free(data);
+        return 0;
+    }
+
+    src->data = data;
+    src->length = length;
+    src->mapped = 0;
+    return 1;
+}
+
+// Map the whole file into memory; falls back to block reads where mmap is unavailable
+int openSource(SourceBuffer *src, const char *filename) {
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            close(fd);
+#ifdef MADV_SEQUENTIAL
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL); //lexer reads front to back
+#endif
+            src->data = data;
+            src->length = (size_t)st.st_size;
+            src->mapped = 1;
+            return 1;
+        }
+    }
+    close(fd);
+#endif
+    //empty files, pipes and non-POSIX systems: read it in blocks instead
+    FILE *file = fopen(filename, "rb");
+    if (!file) return 0;
+    int ok = readSourceStream(src, file);
+    fclose(file);
+    return ok;
+}
+
+void closeSource(SourceBuffer *src) {
+#ifndef _WIN32
+    if (src->mapped) {
+        munmap((void *)src->data, src->length);
+    } else
+#endif
+    {
+        free((void *)src->data);
+    }
+    src->data = NULL;
+    src->length = 0;
+    src->mapped = 0;
+}
@@ -0,0 +1,20 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+//Whole source file held in memory so the lexer can walk it with a pointer
+//instead of calling fgetc/ungetc for every character.
+typedef struct {
+    const char *data;   //file contents (not null terminated)
+    size_t length;      //number of bytes in data
+    int mapped;         //1 if data is a memory mapping, 0 if it was malloc'd
+} SourceBuffer;
+
+//function prototypes
+int openSource(SourceBuffer *src, const char *filename);  //map (or read) a whole file, returns 1 on success
+int readSourceStream(SourceBuffer *src, FILE *stream);    //read a stream (e.g. stdin) in large blocks
+void closeSource(SourceBuffer *src);
+
+#endif
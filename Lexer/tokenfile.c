@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tokens.h"
+#include "lexer.h"
+#include "tokenfile.h"
+
+#define CATEGORY_SLOTS 8   //TokenCategory values
+#define VALUE_SLOTS 32     //token values per category
+#define NO_ID 0xFFFFFFFFu
+
+// Lexeme interning: open addressing over lexeme ids, keyed by the lexeme bytes
+typedef struct {
+    uint32_t *slots;        //lexeme id or NO_ID
+    size_t slotCount;       //power of two
+    size_t *firstOffset;    //where lexeme id i first appears in the source
+    unsigned int *length;   //its length
+    size_t count;
+    size_t capacity;
+} LexemeDictionary;
+
+static uint32_t hashLexeme(const unsigned char *s, size_t length) {
+    uint32_t h = 2166136261u; //FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        h = (h ^ s[i]) * 16777619u;
+    }
+    return h;
+}
+
+static int growSlots(LexemeDictionary *dict, const char *source) {
+    size_t slotCount = dict->slotCount ? dict->slotCount * 2 : 1024;
+    uint32_t *slots = malloc(slotCount * sizeof(uint32_t));
+    if (!slots) return 0;
+    memset(slots, 0xFF, slotCount * sizeof(uint32_t));
+
+    for (size_t id = 0; id < dict->count; id++) { //rehash the existing lexemes
+        const unsigned char *s = (const unsigned char *)source + dict->firstOffset[id];
+        size_t slot = hashLexeme(s, dict->length[id]) & (slotCount - 1);
+        while (slots[slot] != NO_ID) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = (uint32_t)id;
+    }
+    free(dict->slots);
+    dict->slots = slots;
+    dict->slotCount = slotCount;
+    return 1;
+}
+
+// Returns the lexeme id of a token, adding the lexeme on first sight; NO_ID if out of memory
+static uint32_t internLexeme(LexemeDictionary *dict, const char *source, const Token *t) {
+    if ((dict->count + 1) * 2 > dict->slotCount && !growSlots(dict, source)) return NO_ID;
+
+    const unsigned char *s = (const unsigned char *)source + t->offset;
+    size_t slot = hashLexeme(s, t->length) & (dict->slotCount - 1);
+    while (dict->slots[slot] != NO_ID) {
+        uint32_t id = dict->slots[slot];
+        if (dict->length[id] == t->length &&
+            memcmp(source + dict->firstOffset[id], s, t->length) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & (dict->slotCount - 1);
+    }
+
+    if (dict->count == dict->capacity) {
+        size_t capacity = dict->capacity ? dict->capacity * 2 : 1024;
+        size_t *offsets = realloc(dict->firstOffset, capacity * sizeof(size_t));
+        if (!offsets) return NO_ID;
+        dict->firstOffset = offsets;
+        unsigned int *lengths = realloc(dict->length, capacity * sizeof(unsigned int));
+        if (!lengths) return NO_ID;
+        dict->length = lengths;
+        dict->capacity = capacity;
+    }
+    dict->firstOffset[dict->count] = t->offset;
+    dict->length[dict->count] = t->length;
+    dict->slots[slot] = (uint32_t)dict->count;
+    return (uint32_t)dict->count++;
+}
+
+static void freeDictionary(LexemeDictionary *dict) {
+    free(dict->slots);
+    free(dict->firstOffset);
+    free(dict->length);
+}
+
+static size_t putVarint(unsigned char *out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+static int writeU32(FILE *file, uint32_t value) {
+    value = tokenFileU32(value);
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+// Write a token list as a binary token file (format in tokenfile.h); returns 1 on success
+int writeTokenFile(const char *filename, const char *source, const TokenList *list) {
+    uint32_t kindIds[CATEGORY_SLOTS][VALUE_SLOTS];
+    const Token *kindTokens[TOKEN_FILE_MAX_KINDS]; //one token of each kind, for its name
+    uint32_t kindCount = 0;
+    LexemeDictionary dict = {0};
+    uint32_t *tokenLexemes = malloc((list->count ? list->count : 1) * sizeof(uint32_t));
+    unsigned char *tokenKinds = malloc(list->count ? list->count : 1);
+    unsigned char *lineDeltas = malloc(list->count * 5 + 1); //a varint of 32 bits is at most 5 bytes
+    size_t lineBytes = 0;
+    int previousLine = 1;
+    int ok = tokenLexemes && tokenKinds && lineDeltas && list->count <= UINT32_MAX;
+
+    memset(kindIds, 0xFF, sizeof(kindIds));
+    for (size_t i = 0; ok && i < list->count; i++) {
+        const Token *t = &list->tokens[i];
+        if ((unsigned)t->category >= CATEGORY_SLOTS || (unsigned)t->tokenValue >= VALUE_SLOTS ||
+            t->lineNumber < previousLine) {
+            ok = 0; //not representable (the lexer never produces these)
+            break;
+        }
+        uint32_t *kind = &kindIds[t->category][t->tokenValue];
+        if (*kind == NO_ID) {
+            kindTokens[kindCount] = t;
+            *kind = kindCount++;
+        }
+        tokenKinds[i] = (unsigned char)*kind;
+        uint32_t lexemeId = internLexeme(&dict, source, t);
+        if (lexemeId == NO_ID) {
+            ok = 0;
+            break;
+        }
+        tokenLexemes[i] = tokenFileU32(lexemeId);
+        lineBytes += putVarint(lineDeltas + lineBytes, (uint32_t)(t->lineNumber - previousLine));
+        previousLine = t->lineNumber;
+    }
+
+    FILE *file = ok ? fopen(filename, "wb") : NULL;
+    if (file) {
+        //string pool sizes: kind names, then lexemes, each with a terminator
+        size_t stringBytes = 0;
+        for (uint32_t k = 0; k < kindCount; k++) stringBytes += strlen(token_value_name(kindTokens[k])) + 1;
+        for (size_t id = 0; id < dict.count; id++) stringBytes += dict.length[id] + 1;
+        ok = stringBytes <= UINT32_MAX;
+
+        TokenFileHeader header;
+        memcpy(header.magic, TOKEN_FILE_MAGIC, sizeof(header.magic));
+        header.version = tokenFileU16(TOKEN_FILE_VERSION);
+        header.headerSize = tokenFileU16(sizeof(TokenFileHeader));
+        header.tokenCount = tokenFileU32((uint32_t)list->count);
+        header.kindCount = tokenFileU32(kindCount);
+        header.lexemeCount = tokenFileU32((uint32_t)dict.count);
+        header.stringBytes = tokenFileU32((uint32_t)stringBytes);
+        header.lineBytes = tokenFileU32((uint32_t)lineBytes);
+        header.reserved = 0;
+        ok = ok && fwrite(&header, sizeof(header), 1, file) == 1;
+
+        uint32_t offset = 0;
+        for (uint32_t k = 0; ok && k < kindCount; k++) {
+            ok = writeU32(file, offset);
+            offset += (uint32_t)strlen(token_value_name(kindTokens[k])) + 1;
+        }
+        for (size_t id = 0; ok && id < dict.count; id++) {
+            ok = writeU32(file, offset);
+            offset += dict.length[id] + 1;
+        }
+        ok = ok && writeU32(file, offset);
+
+        ok = ok && fwrite(tokenLexemes, sizeof(uint32_t), list->count, file) == list->count;
+        ok = ok && fwrite(tokenKinds, 1, list->count, file) == list->count;
+        ok = ok && fwrite(lineDeltas, 1, lineBytes, file) == lineBytes;
+
+        for (uint32_t k = 0; ok && k < kindCount; k++) {
+            const char *name = token_value_name(kindTokens[k]);
+            ok = fwrite(name, 1, strlen(name) + 1, file) == strlen(name) + 1;
+        }
+        for (size_t id = 0; ok && id < dict.count; id++) {
+            ok = fwrite(source + dict.firstOffset[id], 1, dict.length[id], file) == dict.length[id] &&
+                 fputc('\0', file) != EOF;
+        }
+        if (fclose(file) != 0) ok = 0;
+    } else {
+        ok = 0;
+    }
+
+    freeDictionary(&dict);
+    free(tokenLexemes);
+    free(tokenKinds);
+    free(lineDeltas);
+    return ok;
+}
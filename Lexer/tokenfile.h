@@ -0,0 +1,75 @@
+#ifndef TOKENFILE_H
+#define TOKENFILE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "source.h"
+
+//Binary token stream file (".usbt"), written by the lexer and mapped by the parser.
+//All integers are little-endian. Layout, in file order:
+//
+//  TokenFileHeader                          32 bytes
+//  uint32 stringOffsets[kindCount + lexemeCount + 1]
+//                                           start of every string in the pool: the
+//                                           token kind names first, then the lexemes;
+//                                           the last entry is stringBytes
+//  uint32 tokenLexemes[tokenCount]          lexeme id of each token (interned)
+//  uint8  tokenKinds[tokenCount]            kind id of each token (< kindCount)
+//  uint8  lineDeltas[lineBytes]             per token: line - previous line (first
+//                                           token: line - 1), unsigned LEB128 varint
+//  char   strings[stringBytes]              string pool, every string NUL-terminated
+//
+//A lexeme's length is the distance to the next offset minus its terminator, so
+//lexemes holding NUL bytes survive the trip.
+#define TOKEN_FILE_MAGIC "USBT"
+#define TOKEN_FILE_VERSION 1
+#define TOKEN_FILE_MAX_KINDS 256
+
+typedef struct {
+    char magic[4];          //"USBT"
+    uint16_t version;       //TOKEN_FILE_VERSION
+    uint16_t headerSize;    //sizeof(TokenFileHeader)
+    uint32_t tokenCount;
+    uint32_t kindCount;
+    uint32_t lexemeCount;
+    uint32_t stringBytes;
+    uint32_t lineBytes;
+    uint32_t reserved;      //0
+} TokenFileHeader;
+
+//A token file mapped into memory; the section pointers point into the mapping
+typedef struct {
+    SourceBuffer file;
+    TokenFileHeader header;         //already converted to host byte order
+    const unsigned char *stringOffsets;
+    const unsigned char *tokenLexemes;
+    const unsigned char *tokenKinds;
+    const unsigned char *lineDeltas;
+    const char *strings;
+} TokenFile;
+
+//File byte order <-> host byte order (the conversion is its own inverse)
+static inline uint32_t tokenFileU32(uint32_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap32(v);
+#else
+    return v;
+#endif
+}
+
+static inline uint16_t tokenFileU16(uint16_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap16(v);
+#else
+    return v;
+#endif
+}
+
+//Read entry i of a uint32 section (sections are 4-byte aligned in the file)
+static inline uint32_t tokenFileEntry(const unsigned char *section, size_t i) {
+    uint32_t v;
+    memcpy(&v, section + i * sizeof(uint32_t), sizeof(v));
+    return tokenFileU32(v);
+}
+
+#endif
@@ -1,5 +1,8 @@
 #ifndef TOKENS_H
 #define TOKENS_H
+
+#include <stddef.h>
+
 //Category
 typedef enum {
     CAT_KEYWORD,
@@ -117,11 +120,19 @@ typedef enum {
     C_MULTI_LINE    // /* */
 } CommentToken;
 
+//Category and value packed into one small integer, the token's kind, for
+//code that compares or indexes by token (e.g. the parser)
+#define TOKEN_KIND_VALUE_BITS 5     //up to 32 values per category
+#define TOKEN_KIND(category, value) (((category) << TOKEN_KIND_VALUE_BITS) | (value))
+#define TOKEN_KIND_COUNT 256        //8 categories of 32 values
+
 //General structure for a Token
+//The lexeme is not copied: the token records where it sits in the source buffer
 typedef struct {
     TokenCategory category;
     int tokenValue;          // Holds actual enum value from KeywordToken, OperatorToken, etc.
-    char* lexeme;         // The actual string from the source code
+    size_t offset;           // Start of the lexeme in the source buffer
+    unsigned int length;     // Length of the lexeme in bytes
     int lineNumber;    // Line number in source code
 } Token;
 
@@ -1,29 +1,26 @@
 #ifndef WORDHASH_H
 #define WORDHASH_H
 
+#include <stddef.h>
 #include <stdbool.h>
 #include "tokens.h"
 
 //HASH TABLE STUFF
-#define TABLE_SIZE 100
-#define MAX 100
-
+//The keyword/reserved/noise word table is a perfect hash built at compile time:
+//the words live in wordlist.h and gen_wordhash.c turns them into wordhash_table.h.
+//Every word has its own slot, so a lookup is one hash and at most one compare.
 typedef struct {
-    char key[MAX];
+    const char *key;
+    unsigned char length;
     TokenCategory category;
     int tokenValue;
 } HashEntry;
 
-extern HashEntry hash_table[TABLE_SIZE]; //declare hash table
-
 //function prototypes
-unsigned int hash(const char *key);
-void hashhashInsert(const char *key, TokenCategory category, int token_value);
-HashEntry* hashLookUp(const char *key);
-void initialize_table(void);
-
+const HashEntry *wordLookup(const char *lexeme, size_t length);
+const HashEntry *hashLookUp(const char *key);
 
 // new function for parser to use
 int hashLookup(const char *lexeme, int *category, int *value);
 
-#endif
\ No newline at end of file
+#endif
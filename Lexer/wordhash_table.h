@@ -0,0 +1,58 @@
+// Generated by gen_wordhash.c from wordlist.h -- do not edit.
+// Regenerate: gcc gen_wordhash.c -o gen_wordhash && ./gen_wordhash > wordhash_table.h
+#ifndef WORDHASH_TABLE_H
+#define WORDHASH_TABLE_H
+
+#define WORDHASH_SIZE 64
+#define WORDHASH_MIN_LENGTH 2
+#define WORDHASH_MAX_LENGTH 17
+#define WORDHASH(s, length) \
+    (((length) + (s)[0] * 17u + (s)[1] * 18u + (s)[(length) - 1] * 63u) & (WORDHASH_SIZE - 1))
+
+//Bit n is set when some word starts with byte n
+static const unsigned int wordFirstBytes[8] = {
+    0x00000000u, 0x00000000u, 0x00000020u, 0x00b97b96u, 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u
+};
+
+static const HashEntry wordTable[WORDHASH_SIZE] = {
+    [ 0] = { "gawin", 5, CAT_KEYWORD, K_GAWIN },
+    [ 2] = { "publiko", 7, CAT_KEYWORD, K_PUBLIKO },
+    [ 3] = { "bilang", 6, CAT_RESERVED, R_BILANG },
+    [ 5] = { "lutang", 6, CAT_RESERVED, R_LUTANG },
+    [ 6] = { "itakda", 6, CAT_NOISEWORD, N_ITAKDA },
+    [ 7] = { "ani", 3, CAT_KEYWORD, K_ANI },
+    [ 9] = { "ang", 3, CAT_NOISEWORD, N_ANG },
+    [11] = { "wakas", 5, CAT_NOISEWORD, N_WAKAS },
+    [12] = { "pribado", 7, CAT_KEYWORD, K_PRIBADO },
+    [13] = { "kwerdas", 7, CAT_RESERVED, R_KWERDAS },
+    [14] = { "kiss", 4, CAT_RESERVED, R_Kiss },
+    [15] = { "protektado", 10, CAT_KEYWORD, K_PROTEKTADO },
+    [18] = { "doble", 5, CAT_RESERVED, R_DOBLE },
+    [19] = { "ugat", 4, CAT_RESERVED, R_UGAT },
+    [20] = { "bulyan", 6, CAT_RESERVED, R_BULYAN },
+    [21] = { "pangkat", 7, CAT_KEYWORD, K_PANGKAT },
+    [22] = { "sa", 2, CAT_NOISEWORD, N_SA },
+    [25] = { "habang", 6, CAT_KEYWORD, K_HABANG },
+    [26] = { "mula", 4, CAT_NOISEWORD, N_MULA },
+    [27] = { "E_num", 5, CAT_RESERVED, R_E_NUM },
+    [28] = { "wala", 4, CAT_RESERVED, R_WALA },
+    [30] = { "tanim", 5, CAT_KEYWORD, K_TANIM },
+    [31] = { "sampleConstString", 17, CAT_RESERVED, R_SAMPLE_CONST_STRING },
+    [32] = { "bunga", 5, CAT_NOISEWORD, N_BUNGA },
+    [37] = { "para", 4, CAT_KEYWORD, K_PARA },
+    [38] = { "statik", 6, CAT_KEYWORD, K_STATIK },
+    [39] = { "ng", 2, CAT_NOISEWORD, N_NG },
+    [41] = { "tama", 4, CAT_RESERVED, R_TAMA },
+    [42] = { "mali", 4, CAT_RESERVED, R_MALI },
+    [43] = { "pi", 2, CAT_RESERVED, R_PI },
+    [46] = { "balik", 5, CAT_RESERVED, R_BALIK },
+    [47] = { "kundiman", 8, CAT_KEYWORD, K_KUNDIMAN },
+    [48] = { "titik", 5, CAT_RESERVED, R_TITIK },
+    [49] = { "kundi", 5, CAT_KEYWORD, K_KUNDI },
+    [50] = { "kung", 4, CAT_KEYWORD, K_KUNG },
+    [52] = { "tibag", 5, CAT_KEYWORD, K_TIBAG },
+    [58] = { "tuloy", 5, CAT_KEYWORD, K_TULOY },
+    [60] = { "ay", 2, CAT_NOISEWORD, N_AY },
+};
+
+#endif
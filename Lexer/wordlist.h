@@ -0,0 +1,51 @@
+#ifndef WORDLIST_H
+#define WORDLIST_H
+
+//Every keyword, reserved word and noise word of the language: X(word, category, token value).
+//gen_wordhash.c builds the perfect hash table in wordhash_table.h from this list,
+//so regenerate that header after changing it.
+#define WORD_LIST(X) \
+    /* Keywords */ \
+    X("ani", CAT_KEYWORD, K_ANI) \
+    X("tanim", CAT_KEYWORD, K_TANIM) \
+    X("para", CAT_KEYWORD, K_PARA) \
+    X("habang", CAT_KEYWORD, K_HABANG) \
+    X("kung", CAT_KEYWORD, K_KUNG) \
+    X("kundi", CAT_KEYWORD, K_KUNDI) \
+    X("kundiman", CAT_KEYWORD, K_KUNDIMAN) \
+    X("gawin", CAT_KEYWORD, K_GAWIN) \
+    X("tibag", CAT_KEYWORD, K_TIBAG) \
+    X("tuloy", CAT_KEYWORD, K_TULOY) \
+    X("pangkat", CAT_KEYWORD, K_PANGKAT) \
+    X("statik", CAT_KEYWORD, K_STATIK) \
+    X("pribado", CAT_KEYWORD, K_PRIBADO) \
+    X("protektado", CAT_KEYWORD, K_PROTEKTADO) \
+    X("publiko", CAT_KEYWORD, K_PUBLIKO) \
+    /* Reserved words */ \
+    X("tama", CAT_RESERVED, R_TAMA) \
+    X("mali", CAT_RESERVED, R_MALI) \
+    X("ugat", CAT_RESERVED, R_UGAT) \
+    X("balik", CAT_RESERVED, R_BALIK) \
+    X("bilang", CAT_RESERVED, R_BILANG) \
+    X("kwerdas", CAT_RESERVED, R_KWERDAS) \
+    X("titik", CAT_RESERVED, R_TITIK) \
+    X("lutang", CAT_RESERVED, R_LUTANG) \
+    X("bulyan", CAT_RESERVED, R_BULYAN) \
+    X("doble", CAT_RESERVED, R_DOBLE) \
+    X("wala", CAT_RESERVED, R_WALA) \
+    /* Noise words */ \
+    X("ng", CAT_NOISEWORD, N_NG) \
+    X("ay", CAT_NOISEWORD, N_AY) \
+    X("bunga", CAT_NOISEWORD, N_BUNGA) \
+    X("wakas", CAT_NOISEWORD, N_WAKAS) \
+    X("sa", CAT_NOISEWORD, N_SA) \
+    X("ang", CAT_NOISEWORD, N_ANG) \
+    X("mula", CAT_NOISEWORD, N_MULA) \
+    X("itakda", CAT_NOISEWORD, N_ITAKDA) \
+    /* Const */ \
+    X("pi", CAT_RESERVED, R_PI) \
+    X("E_num", CAT_RESERVED, R_E_NUM) \
+    X("kiss", CAT_RESERVED, R_Kiss) \
+    X("sampleConstString", CAT_RESERVED, R_SAMPLE_CONST_STRING)
+
+#endif
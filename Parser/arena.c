@@ -0,0 +1,50 @@
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_FIRST_BLOCK 16384
+#define ARENA_MAX_BLOCK (16 * 1024 * 1024)
+#define ARENA_ALIGN 16
+
+// Block headers are rounded up so the data after them stays aligned
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+void arena_init(Arena* arena) {
+    arena->blocks = NULL;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaBlock* block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        size_t block_size = block ? block->size * 2 : ARENA_FIRST_BLOCK;
+        if (block_size > ARENA_MAX_BLOCK) block_size = ARENA_MAX_BLOCK;
+        if (block_size < size) block_size = size;
+        ArenaBlock* grown = (ArenaBlock*)malloc(ARENA_HEADER + block_size);
+        if (!grown) return NULL;
+        grown->next = block;
+        grown->size = block_size;
+        grown->used = 0;
+        arena->blocks = block = grown;
+    }
+    void* memory = (char*)block + ARENA_HEADER + block->used;
+    block->used += size;
+    return memory;
+}
+
+char* arena_strdup(Arena* arena, const char* text) {
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)arena_alloc(arena, length);
+    if (copy) memcpy(copy, text, length);
+    return copy;
+}
+
+void arena_free(Arena* arena) {
+    ArenaBlock* block = arena->blocks;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
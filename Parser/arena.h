@@ -0,0 +1,28 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator for data that lives and dies together, like one parse's tree.
+// Memory comes from blocks that double in size, so a parse of n nodes touches
+// O(log n) blocks, and everything is released at once by arena_free; there is
+// no per-object free.
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;
+    size_t used;
+    // block data follows, aligned for any object
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* blocks;    // newest first
+} Arena;
+
+void arena_init(Arena* arena);
+// Uninitialized memory for size bytes, aligned like malloc's; NULL when out of memory
+void* arena_alloc(Arena* arena, size_t size);
+// Copy of a string kept in the arena; NULL when out of memory
+char* arena_strdup(Arena* arena, const char* text);
+void arena_free(Arena* arena);
+
+#endif
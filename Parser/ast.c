@@ -0,0 +1,496 @@
+#include "ast.h"
+#include "grammar.h"
+#include "diagnostics.h"
+#include "output.h"
+
+static const char* ast_kind_names[] = {
+#define AST_KIND_NAME(kind, name) name,
+    AST_NODE_KINDS(AST_KIND_NAME)
+#undef AST_KIND_NAME
+};
+
+const char* ast_kind_name(AstKind kind) {
+    return ast_kind_names[kind];
+}
+
+// ============ NODES ============
+
+// A node whose span starts at the current token (and is empty until ended)
+static AstNode* new_node(Parser* p, AstKind kind, TokenKind token, const char* value) {
+    AstNode* node = (AstNode*)arena_alloc(&p->nodes, sizeof(AstNode));
+    if (!node) return NULL;
+    node->kind = kind;
+    node->token = token;
+    node->value = value;
+    node->first_token = p->pos;
+    node->last_token = p->pos - 1;
+    node->first_child = NULL;
+    node->last_child = NULL;
+    node->next_sibling = NULL;
+    return node;
+}
+
+// Ends node's span at the last token taken
+static AstNode* end_node(Parser* p, AstNode* node) {
+    if (node) node->last_token = p->pos - 1;
+    return node;
+}
+
+// A node for the current token, which it takes
+static AstNode* token_node(Parser* p, AstKind kind) {
+    AstNode* node = new_node(p, kind, p->current_token->kind, p->current_token->lexeme);
+    advance(p);
+    return end_node(p, node);
+}
+
+static void add(AstNode* parent, AstNode* child) {
+    if (parent == NULL || child == NULL) return;
+    if (parent->last_child) {
+        parent->last_child->next_sibling = child;
+    } else {
+        parent->first_child = child;
+    }
+    parent->last_child = child;
+}
+
+// ============ TOKENS ============
+
+static bool check_first(Parser* p, GrammarNonterminal nonterminal) {
+    return token_set_has(grammar_first(nonterminal), lookahead_symbol(p->current_token));
+}
+
+static GrammarProduction predict(Parser* p, GrammarNonterminal nonterminal) {
+    return grammar_choice(nonterminal, lookahead_symbol(p->current_token),
+                          lookahead_symbol(peek_ahead(p, 1)));
+}
+
+// Takes the expected token; otherwise reports it as match() does and takes nothing
+static bool expect(Parser* p, TokenKind expected) {
+    if (check_token(p, expected)) {
+        advance(p);
+        return true;
+    }
+    parser_error_expected(p, expected);
+    return false;
+}
+
+// Panic mode: skips the rest of a bad statement, through its ';' or up to the
+// next '}' or token that starts a statement other than an assignment
+static void skip_statement(Parser* p) {
+    while (p->current_token && !check_token(p, T_D_RBRACE)) {
+        bool end = check_token(p, T_D_SEMICOLON);
+        advance(p);
+        if (end || (check_first(p, G_STATEMENT) && !check_token(p, T_L_IDENTIFIER))) return;
+    }
+}
+
+// ============ EXPRESSIONS ============
+
+static AstKind operator_kind(TokenKind kind) {
+    switch (kind) {
+    case T_O_OR:         return AST_OR;
+    case T_O_AND:        return AST_AND;
+    case T_O_EQUAL:      return AST_EQUAL;
+    case T_O_NOT_EQUAL:  return AST_NOT_EQUAL;
+    case T_O_LESS:       return AST_LESS;
+    case T_O_GREATER:    return AST_GREATER;
+    case T_O_LESS_EQ:    return AST_LESS_EQ;
+    case T_O_GREATER_EQ: return AST_GREATER_EQ;
+    case T_O_PLUS:       return AST_ADD;
+    case T_O_MINUS:      return AST_SUBTRACT;
+    case T_O_MULTIPLY:   return AST_MULTIPLY;
+    case T_O_DIVIDE:     return AST_DIVIDE;
+    case T_O_MODULO:     return AST_MODULO;
+    case T_O_POW:        return AST_POWER;
+    default:             return AST_ERROR;
+    }
+}
+
+static int current_power(Parser* p) {
+    return p->current_token ? binary_power(p->current_token->kind) : 0;
+}
+
+static AstNode* parse_expression(Parser* p, int min_power);
+
+// A prefix operator over its operand, a parenthesized expression or a Factor's token
+static AstNode* parse_operand(Parser* p) {
+    if (check_token(p, T_O_MINUS) || check_token(p, T_O_NOT)) {
+        AstNode* node = new_node(p, check_token(p, T_O_NOT) ? AST_NOT : AST_NEGATE,
+                                 p->current_token->kind, p->current_token->lexeme);
+        advance(p);
+        add(node, parse_expression(p, POWER_UNARY));
+        return end_node(p, node);
+    }
+
+    switch (predict(p, G_FACTOR)) {
+    case P_FACTOR_IDENTIFIER:
+        return token_node(p, AST_IDENTIFIER);
+    case P_FACTOR_PARENTHESES: {
+        int open = p->pos;
+        advance(p);
+        AstNode* inner = parse_expression(p, 1);
+        if (expect(p, T_D_RPAREN)) return inner;
+        AstNode* error = new_node(p, AST_ERROR, T_NONE, "missing_rparen");
+        if (error) error->first_token = open;
+        add(error, inner);
+        return end_node(p, error);
+    }
+    case P_NONE:
+        break;
+    default:
+        return token_node(p, AST_LITERAL);
+    }
+
+    if (current_power(p) > 0) {
+        parser_error(p, DIAG_DOUBLE_OPERATOR);
+        advance(p);
+        if (p->current_token && !check_token(p, T_D_SEMICOLON) && !check_token(p, T_D_RPAREN)) {
+            return parse_operand(p);
+        }
+        return new_node(p, AST_ERROR, T_NONE, "unexpected_operator");
+    }
+    parser_error(p, DIAG_EXPECTED_OPERAND);
+    AstNode* error = new_node(p, AST_ERROR, T_NONE, "invalid_operand");
+    if (p->current_token && !check_token(p, T_D_SEMICOLON) && !check_token(p, T_D_RPAREN)) {
+        advance(p);
+    }
+    return end_node(p, error);
+}
+
+// Precedence climbing over binary_power: left-associative operators climb to
+// power + 1 for their right operand, ^ stays at its own
+static AstNode* parse_expression(Parser* p, int min_power) {
+    AstNode* left = parse_operand(p);
+    int power;
+    while ((power = current_power(p)) >= min_power) {
+        AstNode* node = new_node(p, operator_kind(p->current_token->kind),
+                                 p->current_token->kind, p->current_token->lexeme);
+        advance(p);
+        if (node && left) node->first_token = left->first_token;
+        add(node, left);
+        add(node, parse_expression(p, power == POWER_POW ? power : power + 1));
+        left = end_node(p, node);
+    }
+    return left;
+}
+
+// '(' Expression ')'
+static AstNode* parse_condition(Parser* p) {
+    expect(p, T_D_LPAREN);
+    AstNode* condition = parse_expression(p, 1);
+    expect(p, T_D_RPAREN);
+    return condition;
+}
+
+// ============ STATEMENTS ============
+
+static AstNode* parse_block(Parser* p);
+
+// DataType identifier (',' identifier ('=' Expression)?)* ';' - only the
+// identifiers after the first may be initialized
+static AstNode* parse_declaration(Parser* p) {
+    AstNode* node = token_node(p, AST_DECLARATION);
+    for (bool first = true;; first = false) {
+        if (!check_token(p, T_L_IDENTIFIER)) {
+            expect(p, T_L_IDENTIFIER);
+            break;
+        }
+        AstNode* variable = token_node(p, AST_VARIABLE);
+        if (!first && check_token(p, T_O_ASSIGN)) {
+            advance(p);
+            add(variable, parse_expression(p, 1));
+            end_node(p, variable);
+        }
+        add(node, variable);
+        if (!check_token(p, T_D_COMMA)) break;
+        advance(p);
+    }
+    expect(p, T_D_SEMICOLON);
+    return end_node(p, node);
+}
+
+// identifier '=' (identifier '=')* Expression, without the ';'. A chain nests
+// to the right and all of it ends with the value.
+static AstNode* parse_assignment(Parser* p) {
+    AstNode* root = NULL;
+    AstNode* target = NULL;
+    do {
+        AstNode* node = new_node(p, AST_ASSIGNMENT, T_L_IDENTIFIER, p->current_token->lexeme);
+        advance(p);
+        expect(p, T_O_ASSIGN);
+        if (target) add(target, node);
+        else root = node;
+        target = node;
+    } while (check_token(p, T_L_IDENTIFIER) && peek_ahead(p, 1) && peek_ahead(p, 1)->kind == T_O_ASSIGN);
+
+    AstNode* value = parse_expression(p, 1);
+    add(target, value);
+    for (AstNode* node = root; node && node != value; node = node->first_child) {
+        end_node(p, node);
+    }
+    return root;
+}
+
+// kung '(' Expression ')' Block, then kundiman ... (a nested Conditional) or kundi Block
+static AstNode* parse_conditional(Parser* p) {
+    AstNode* node = new_node(p, AST_CONDITIONAL, p->current_token->kind, p->current_token->lexeme);
+    advance(p);
+    add(node, parse_condition(p));
+    add(node, parse_block(p));
+    if (check_token(p, T_K_KUNDIMAN)) {
+        add(node, parse_conditional(p));
+    } else if (check_token(p, T_K_KUNDI)) {
+        advance(p);
+        add(node, parse_block(p));
+    }
+    return end_node(p, node);
+}
+
+// para '(' (Declaration | Assignment ';') Expression ';' Assignment? ')' Block
+static AstNode* parse_for_loop(Parser* p) {
+    AstNode* node = new_node(p, AST_FOR_LOOP, p->current_token->kind, p->current_token->lexeme);
+    advance(p);
+    expect(p, T_D_LPAREN);
+
+    if (check_first(p, G_DECLARATION)) {
+        add(node, parse_declaration(p));
+    } else if (check_token(p, T_L_IDENTIFIER)) {
+        add(node, parse_assignment(p));
+        expect(p, T_D_SEMICOLON);
+    } else {
+        parser_error(p, DIAG_FOR_INIT);
+        add(node, new_node(p, AST_ERROR, T_NONE, "missing_init"));
+    }
+
+    add(node, parse_expression(p, 1));
+    expect(p, T_D_SEMICOLON);
+
+    if (check_token(p, T_L_IDENTIFIER)) {
+        add(node, parse_assignment(p));
+    } else {
+        add(node, new_node(p, AST_EMPTY, T_NONE, NULL));
+    }
+    expect(p, T_D_RPAREN);
+    add(node, parse_block(p));
+    return end_node(p, node);
+}
+
+// habang '(' Expression ')' Block
+static AstNode* parse_while_loop(Parser* p) {
+    AstNode* node = new_node(p, AST_WHILE_LOOP, p->current_token->kind, p->current_token->lexeme);
+    advance(p);
+    add(node, parse_condition(p));
+    add(node, parse_block(p));
+    return end_node(p, node);
+}
+
+// gawin Block habang '(' Expression ')' ';'
+static AstNode* parse_do_while_loop(Parser* p) {
+    AstNode* node = new_node(p, AST_DO_WHILE_LOOP, p->current_token->kind, p->current_token->lexeme);
+    advance(p);
+    add(node, parse_block(p));
+    expect(p, T_K_HABANG);
+    add(node, parse_condition(p));
+    expect(p, T_D_SEMICOLON);
+    return end_node(p, node);
+}
+
+// ani '(' Expression (',' Expression)* ')' ';'
+// tanim '(' identifier (',' identifier)* ')' ';'
+static AstNode* parse_print_or_scan(Parser* p, bool print) {
+    AstNode* node = new_node(p, print ? AST_PRINT : AST_SCAN, p->current_token->kind, p->current_token->lexeme);
+    advance(p);
+    expect(p, T_D_LPAREN);
+    for (;;) {
+        if (print) {
+            add(node, parse_expression(p, 1));
+        } else if (check_token(p, T_L_IDENTIFIER)) {
+            add(node, token_node(p, AST_IDENTIFIER));
+        } else {
+            expect(p, T_L_IDENTIFIER);
+            break;
+        }
+        if (!check_token(p, T_D_COMMA)) break;
+        advance(p);
+    }
+    expect(p, T_D_RPAREN);
+    expect(p, T_D_SEMICOLON);
+    return end_node(p, node);
+}
+
+static AstNode* parse_statement(Parser* p) {
+    switch (predict(p, G_STATEMENT)) {
+    case P_STATEMENT_DECLARATION:
+        return parse_declaration(p);
+    case P_STATEMENT_ASSIGNMENT: {
+        AstNode* node = parse_assignment(p);
+        expect(p, T_D_SEMICOLON);
+        return end_node(p, node);
+    }
+    case P_STATEMENT_CONDITIONAL:
+        return parse_conditional(p);
+    case P_STATEMENT_ITERATIVE:
+        if (check_token(p, T_K_PARA)) return parse_for_loop(p);
+        if (check_token(p, T_K_HABANG)) return parse_while_loop(p);
+        return parse_do_while_loop(p);
+    case P_STATEMENT_PRINT:
+        return parse_print_or_scan(p, true);
+    case P_STATEMENT_SCAN:
+        return parse_print_or_scan(p, false);
+    default:
+        break;
+    }
+
+    parser_error(p, DIAG_UNEXPECTED_IN_BLOCK);
+    AstNode* error = new_node(p, AST_ERROR, T_NONE, "invalid_statement");
+    skip_statement(p);
+    return end_node(p, error);
+}
+
+// '{' Statement* '}'. Every statement takes at least one token, so the loop
+// ends; a missing '}' ends the block at end of input, a missing '{' leaves it
+// empty.
+static AstNode* parse_block(Parser* p) {
+    AstNode* node = new_node(p, AST_BLOCK, T_NONE, NULL);
+    if (!expect(p, T_D_LBRACE)) return node;   // the statements stay with the enclosing block
+    while (p->current_token && !check_token(p, T_D_RBRACE)) {
+        add(node, parse_statement(p));
+    }
+    expect(p, T_D_RBRACE);
+    return end_node(p, node);
+}
+
+// ============ PROGRAM STRUCTURE ============
+
+// ReturnType ugat '(' (kwerdas '[' ']' identifier)? ')' Block
+static AstNode* parse_function(Parser* p) {
+    AstNode* node = new_node(p, AST_FUNCTION, p->current_token->kind, NULL);
+    advance(p);
+    if (node && check_token(p, T_R_UGAT)) node->value = p->current_token->lexeme;
+    expect(p, T_R_UGAT);
+    expect(p, T_D_LPAREN);
+    if (check_token(p, T_R_KWERDAS)) {
+        AstNode* parameter = new_node(p, AST_VARIABLE, T_L_IDENTIFIER, NULL);
+        advance(p);
+        expect(p, T_D_LBRACKET);
+        expect(p, T_D_RBRACKET);
+        if (parameter && check_token(p, T_L_IDENTIFIER)) parameter->value = p->current_token->lexeme;
+        expect(p, T_L_IDENTIFIER);
+        add(node, end_node(p, parameter));
+    }
+    expect(p, T_D_RPAREN);
+    add(node, parse_block(p));
+    return end_node(p, node);
+}
+
+// pangkat identifier '{' '}'
+static AstNode* parse_class(Parser* p) {
+    AstNode* node = new_node(p, AST_CLASS, T_NONE, NULL);
+    advance(p);
+    if (node && check_token(p, T_L_IDENTIFIER)) {
+        node->token = T_L_IDENTIFIER;
+        node->value = p->current_token->lexeme;
+    }
+    expect(p, T_L_IDENTIFIER);
+    expect(p, T_D_LBRACE);
+    expect(p, T_D_RBRACE);
+    return end_node(p, node);
+}
+
+bool parse_program_ast(Parser* p) {
+    parser_log("\n=== Starting Syntax Analysis (AST) ===\n");
+    AstNode* program = new_node(p, AST_PROGRAM, T_NONE, NULL);
+
+    if (!check_first(p, G_PROGRAM)) {
+        parser_error(p, DIAG_EXPECTED_PROGRAM);
+        while (p->current_token && !check_first(p, G_PROGRAM)) advance(p);
+    }
+    if (check_first(p, G_MAIN_FUNCTION)) {
+        add(program, parse_function(p));
+    } else {
+        while (check_token(p, T_K_PANGKAT)) add(program, parse_class(p));
+    }
+    if (p->current_token) {
+        parser_error(p, DIAG_TRAILING_TOKEN);
+    }
+
+    p->ast = end_node(p, program);
+    parser_log("Program parsing complete!\n");
+    parser_log("Total errors found: %d\n", p->error_count);
+    return (p->error_count == 0);
+}
+
+// ============ OUTPUT ============
+
+static void write_ast_line(Output* out, const Parser* p, const AstNode* node, size_t depth) {
+    output_spaces(out, 2 * depth);
+    output_string(out, ast_kind_name(node->kind));
+    if (node->kind == AST_LITERAL || node->kind == AST_FUNCTION) {
+        output_char(out, ' ');
+        output_string(out, token_kind_name(node->token));
+    }
+    if (node->value) {
+        output_write(out, " [", 2);
+        output_string(out, node->value);
+        output_char(out, ']');
+    }
+    if (node->last_token >= node->first_token) {
+        ParserToken token;
+        int first = read_token(&p->tokens, node->first_token, &token)->line;
+        int last = read_token(&p->tokens, node->last_token, &token)->line;
+        if (first == last) output_format(out, " (line %d)", first);
+        else output_format(out, " (lines %d-%d)", first, last);
+    }
+    output_char(out, '\n');
+}
+
+// Preorder, indented two spaces a level. The stack holds the next node to
+// write at each open level, so a deep tree costs no call stack.
+static bool write_ast(Output* out, const Parser* p, const AstNode* root) {
+    size_t capacity = 64, depth = 0;
+    const AstNode** next = (const AstNode**)malloc(capacity * sizeof(*next));
+    if (!next) return false;
+    bool ok = true;
+    next[depth++] = root;
+    while (depth > 0) {
+        const AstNode* node = next[depth - 1];
+        if (!node) {
+            depth--;
+            continue;
+        }
+        next[depth - 1] = node->next_sibling;
+        write_ast_line(out, p, node, depth - 1);
+        if (!node->first_child) continue;
+        if (depth == capacity) {
+            const AstNode** grown = (const AstNode**)realloc(next, 2 * capacity * sizeof(*next));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            next = grown;
+            capacity *= 2;
+        }
+        next[depth++] = node->first_child;
+    }
+    free(next);
+    return ok;
+}
+
+bool write_ast_to_file(const char* filename, const Parser* p) {
+    Output out;
+    if (!output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create output file '%s'\n", filename);
+        return false;
+    }
+
+    output_string(&out, "ABSTRACT SYNTAX TREE\n");
+    output_string(&out, "Generated by Recursive Descent Parser (AST mode)\n");
+    output_string(&out, "======================================================================\n\n");
+    bool ok = !p->ast || write_ast(&out, p, p->ast);
+    output_string(&out, "\n======================================================================\n");
+    output_string(&out, "End of Abstract Syntax Tree\n");
+
+    ok = output_close(&out) && ok;
+    parser_log("AST written to '%s'\n", filename);
+    return ok;
+}
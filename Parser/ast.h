@@ -0,0 +1,101 @@
+#ifndef AST_H
+#define AST_H
+
+#include "parser.h"
+
+// Abstract syntax tree: the program's structure without the grammar's
+// scaffolding (ε leaves, delimiters, Statement/Tail/Term chains). It is built
+// directly while parsing, with no parse tree and no transitions in between.
+//
+// Children by kind:
+//   Program       Class..., or Function
+//   Class         none; value is the class name
+//   Function      the Variable parameter if any, then the body Block; value is
+//                 the function name, token the return type
+//   Block         its statements
+//   Declaration   Variable...; value and token are the data type
+//   Variable      its initializer expression if any; value is the name
+//   Assignment    the assigned value, an expression or another Assignment for
+//                 a chain (a = b = 1); value is the target
+//   Conditional   condition, Block, then an else-if Conditional or else Block
+//   ForLoop       init (Declaration or Assignment), condition, increment
+//                 (Assignment or Empty), body Block
+//   WhileLoop     condition, body Block
+//   DoWhileLoop   body Block, condition
+//   Print         argument expressions
+//   Scan          Identifier...
+//   operators     two operands (one for Negate and Not); value and token are
+//                 the operator's
+//   Identifier, Literal   none; a literal's token tells its type (a literal
+//                 kind or a constant such as tama or pi)
+//   Error         what could be parsed of the bad construct, if anything
+#define AST_NODE_KINDS(X) \
+    X(AST_PROGRAM,        "Program") \
+    X(AST_CLASS,          "Class") \
+    X(AST_FUNCTION,       "Function") \
+    X(AST_BLOCK,          "Block") \
+    X(AST_DECLARATION,    "Declaration") \
+    X(AST_VARIABLE,       "Variable") \
+    X(AST_ASSIGNMENT,     "Assignment") \
+    X(AST_CONDITIONAL,    "Conditional") \
+    X(AST_FOR_LOOP,       "ForLoop") \
+    X(AST_WHILE_LOOP,     "WhileLoop") \
+    X(AST_DO_WHILE_LOOP,  "DoWhileLoop") \
+    X(AST_PRINT,          "Print") \
+    X(AST_SCAN,           "Scan") \
+    X(AST_OR,             "Or") \
+    X(AST_AND,            "And") \
+    X(AST_EQUAL,          "Equal") \
+    X(AST_NOT_EQUAL,      "NotEqual") \
+    X(AST_LESS,           "Less") \
+    X(AST_GREATER,        "Greater") \
+    X(AST_LESS_EQ,        "LessEqual") \
+    X(AST_GREATER_EQ,     "GreaterEqual") \
+    X(AST_ADD,            "Add") \
+    X(AST_SUBTRACT,       "Subtract") \
+    X(AST_MULTIPLY,       "Multiply") \
+    X(AST_DIVIDE,         "Divide") \
+    X(AST_MODULO,         "Modulo") \
+    X(AST_POWER,          "Power") \
+    X(AST_NEGATE,         "Negate") \
+    X(AST_NOT,            "Not") \
+    X(AST_IDENTIFIER,     "Identifier") \
+    X(AST_LITERAL,        "Literal") \
+    X(AST_EMPTY,          "Empty") \
+    X(AST_ERROR,          "Error")
+
+typedef enum {
+#define AST_KIND_ENUM(kind, name) kind,
+    AST_NODE_KINDS(AST_KIND_ENUM)
+#undef AST_KIND_ENUM
+    AST_KIND_COUNT
+} AstKind;
+
+// AST node, allocated from the parser's arena like the parse tree's nodes.
+// The span is the node's tokens, first_token to last_token inclusive; the
+// store's lines column turns it into source lines. An Empty node's span is
+// empty (last_token = first_token - 1).
+typedef struct AstNode {
+    AstKind kind;
+    TokenKind token;                // T_NONE for none
+    const char* value;              // the token's lexeme or a note, NULL for none
+    int first_token;
+    int last_token;
+    struct AstNode* first_child;
+    struct AstNode* last_child;
+    struct AstNode* next_sibling;
+} AstNode;
+
+const char* ast_kind_name(AstKind kind);
+
+// Parses the program into p->ast, which is never NULL afterwards. Conditions
+// take any expression, as in the compact expression mode. Error recovery is
+// per statement: a bad statement is reported, skipped up to its ';' (or the
+// next statement keyword or '}') and kept as an Error node. Returns true
+// when there were no syntax errors.
+bool parse_program_ast(Parser* p);
+
+// Indented listing, one node per line with its value and source lines
+bool write_ast_to_file(const char* filename, const Parser* p);
+
+#endif
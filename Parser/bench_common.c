@@ -0,0 +1,73 @@
+#include <time.h>
+#include "bench_common.h"
+
+static const char* sample_block =
+    "habang (n > 0) {\n"
+    "bilang a, b;\n"
+    "x = 3.9;\n"
+    "z = x + y * 2;\n"
+    "a = b = c = 5;\n"
+    "msg = \"Hello USBong\";\n"
+    "ani(\"Hello\", x);\n"
+    "tanim(a, b);\n"
+    "kung (y == 20) { z = 100; } kundiman (y > 15) { z = 50; } kundi { z = 0; }\n"
+    "para (counter = 0; counter < 10; counter = counter + 1) { i = i + counter; ani(i); }\n"
+    "gawin { y = y - 1; ani(y); } habang (y > 0);\n"
+    "}\n";
+
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+char* generate_program(int blocks, size_t* length) {
+    size_t block = strlen(sample_block);
+    char* data = (char*)malloc(block * blocks + 64);
+    if (!data) return NULL;
+    size_t n = sprintf(data, "wala ugat() {\n");
+    for (int i = 0; i < blocks; i++) {
+        memcpy(data + n, sample_block, block);
+        n += block;
+    }
+    n += sprintf(data + n, "}\n");
+    *length = n;
+    return data;
+}
+
+bool same_tree(const ParseTreeNode* a, const ParseTreeNode* b) {
+    size_t capacity = 1024, depth = 0;
+    const ParseTreeNode** stack = (const ParseTreeNode**)malloc(2 * capacity * sizeof(*stack));
+    if (!stack) return false;
+    bool same = true;
+    stack[depth++] = a;
+    stack[depth++] = b;
+    while (same && depth > 0) {
+        b = stack[--depth];
+        a = stack[--depth];
+        if (!a || !b) {
+            same = a == b;
+            continue;
+        }
+        if (a->kind != b->kind || (a->value == NULL) != (b->value == NULL) ||
+            (a->value && strcmp(a->value, b->value) != 0)) {
+            same = false;
+            continue;
+        }
+        if (depth + 4 > 2 * capacity) {
+            const ParseTreeNode** grown = (const ParseTreeNode**)realloc(stack, 4 * capacity * sizeof(*stack));
+            if (!grown) {
+                same = false;
+                break;
+            }
+            stack = grown;
+            capacity *= 2;
+        }
+        stack[depth++] = a->next_sibling;
+        stack[depth++] = b->next_sibling;
+        stack[depth++] = a->first_child;
+        stack[depth++] = b->first_child;
+    }
+    free(stack);
+    return same;
+}
@@ -0,0 +1,21 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "parser.h"
+
+// What the parser benchmarks and test_parser share: a generated program, a
+// clock and a tree comparison. Linked into each of them, not into the parser.
+
+// Seconds on a monotonic clock
+double now_seconds(void);
+
+// "wala ugat() {", blocks copies of one block of statements covering every
+// construct, each in a loop of its own so the tree's depth stays that of a
+// real program, and "}". NUL-terminated; NULL when out of memory.
+char* generate_program(int blocks, size_t* length);
+
+// Same kinds and values in the same shape; preorder, the pending pairs on a
+// stack since the statement lists nest as deep as the program is long
+bool same_tree(const ParseTreeNode* a, const ParseTreeNode* b);
+
+#endif
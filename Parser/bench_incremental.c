@@ -0,0 +1,234 @@
+// Incremental reparsing benchmark: the time from an edit to the updated tree,
+// against lexing and parsing the edited program from scratch, for generated
+// programs of growing size. Each edit is made and then undone in the middle of
+// the program: a literal changed (relexes one token), a statement inserted
+// (reparses the rest of one block) and an if typed in front of a statement
+// without its '}'. That one is the worst case: its block takes the loop's '}',
+// so the loop and the function body end elsewhere and the body's statements
+// up to the edit are taken over one by one, a cost that grows with the file
+// but stays far below a fresh parse. After every edit the tokens, tree and
+// diagnostics are checked against a fresh parse of the same text; the check
+// reads the whole tree, so the times are those of an edit made with the
+// caches cold, as after an editor's own work between keystrokes.
+//
+// --check types each file in one keystroke at a time, deletes half of it again
+// from the middle and then makes random edits with pieces of its own text,
+// checking against a fresh parse after every edit. Built with
+// -g -fsanitize=address,undefined instead of -O2 it also checks the index and
+// the tree for stale slots and nodes.
+//
+// Build: gcc -O2 bench_incremental.c incremental.c parser.c grammar.c table_parser.c ast.c transitions.c output.c treefile.c
+//            diagnostics.c frontend.c arena.c bench_common.c ../Lexer/lexer.c ../Lexer/source.c ../Lexer/WordHash.c
+//            ../Lexer/tokenfile.c ../Lexer/skip.c -o bench_incremental
+//        (or: make bench)
+// Usage: bench_incremental [blocks ...]   (default: 100 1000 10000)
+//        bench_incremental --check file.usb ...
+#include "incremental.h"
+#include "bench_common.h"
+#include "frontend.h"
+#include "../Lexer/source.h"
+
+#define BENCH_RUNS 20
+#define CHECK_RANDOM_EDITS 2000
+
+typedef struct {
+    const char* name;
+    const char* anchor;     // edited at its first match in the middle block ...
+    size_t skip;            // ... this many bytes in
+    size_t removed;
+    const char* text;
+} BenchEdit;
+
+static const BenchEdit bench_edits[] = {
+    { "change a literal",   "x = 3.9;",    4, 3, "4.25" },
+    { "insert a statement", "tanim(a, b);", 0, 0, "ani(x);\n" },
+    { "open an if",         "tanim(a, b);", 0, 0, "kung (x > 0) { " },
+};
+#define BENCH_EDIT_COUNT (int)(sizeof(bench_edits) / sizeof(bench_edits[0]))
+
+// Same tokens, tree and diagnostics
+static bool same_parse(const Parser* a, const Parser* b) {
+    if (a->token_count != b->token_count || a->error_count != b->error_count) return false;
+    for (int i = 0; i < a->token_count; i++) {
+        ParserToken x, y;
+        read_token(&a->tokens, i, &x);
+        read_token(&b->tokens, i, &y);
+        if (x.kind != y.kind || x.line != y.line || strcmp(x.lexeme, y.lexeme) != 0) return false;
+    }
+    for (int i = 0; i < a->error_count; i++) {
+        const Diagnostic* x = &a->diagnostics[i];
+        const Diagnostic* y = &b->diagnostics[i];
+        if (x->code != y->code || x->nonterminal != y->nonterminal || x->expected != y->expected ||
+            x->token != y->token || x->line != y->line) {
+            return false;
+        }
+    }
+    return same_tree(a->parse_tree, b->parse_tree);
+}
+
+// Lexes and parses the text from scratch; the parser, NULL when out of memory
+static Parser* parse_fresh(const char* source, size_t length, ExpressionTree expression_tree) {
+    TokenStore tokens;
+    init_token_store(&tokens);
+    if (!lex_source(source, length, &tokens, NULL)) return NULL;
+    Parser* parser = create_parser(&tokens);
+    if (!parser) return NULL;
+    parser->expression_tree = expression_tree;
+    parse_program(parser);
+    return parser;
+}
+
+// Whether the incremental parse is what a fresh parse of its text makes
+static bool matches_fresh(IncrementalParse* ip) {
+    Parser* fresh = parse_fresh(incremental_source(ip), ip->length, ip->expression_tree);
+    bool same = fresh && same_parse(ip->parser, fresh);
+    if (fresh) free_parser(fresh);
+    return same;
+}
+
+static bool bench_size(int blocks) {
+    size_t length;
+    char* program = generate_program(blocks, &length);
+    IncrementalParse ip;
+    if (!program || !incremental_open(&ip, program, length, EXPRESSION_TREE_TEXTBOOK)) {
+        fprintf(stderr, "out of memory\n");
+        free(program);
+        return false;
+    }
+    printf("%d blocks: %d tokens\n", blocks, ip.parser->token_count);
+
+    double best_fresh = 1e9;
+    Parser* original = NULL;
+    for (int run = 0; run < BENCH_RUNS / 4; run++) {
+        double start = now_seconds();
+        Parser* parser = parse_fresh(program, length, EXPRESSION_TREE_TEXTBOOK);
+        double elapsed = now_seconds() - start;
+        if (elapsed < best_fresh) best_fresh = elapsed;
+        if (!original) original = parser;
+        else if (parser) free_parser(parser);
+    }
+    printf("  fresh lex and parse:  %9.1f us\n", best_fresh * 1e6);
+
+    // Each edit leaves one of two texts, so their fresh parses are made once
+    bool same = original != NULL;
+    size_t middle = length / 2;
+    for (int e = 0; same && e < BENCH_EDIT_COUNT; e++) {
+        const BenchEdit* edit = &bench_edits[e];
+        const char* at = strstr(program + middle, edit->anchor);
+        if (!at) continue;
+        size_t offset = (size_t)(at - program) + edit->skip;
+        size_t text_length = strlen(edit->text);
+        char* removed = (char*)malloc(edit->removed + 1);
+        char* edited = (char*)malloc(length - edit->removed + text_length);
+        if (!removed || !edited) {
+            free(removed);
+            free(edited);
+            same = false;
+            break;
+        }
+        memcpy(removed, program + offset, edit->removed);
+        removed[edit->removed] = '\0';
+        memcpy(edited, program, offset);
+        memcpy(edited + offset, edit->text, text_length);
+        memcpy(edited + offset + text_length, program + offset + edit->removed, length - offset - edit->removed);
+        Parser* expected = parse_fresh(edited, length - edit->removed + text_length, EXPRESSION_TREE_TEXTBOOK);
+        SourceEdit apply = { offset, edit->removed, edit->text, text_length };
+        SourceEdit undo = { offset, text_length, removed, edit->removed };
+
+        double best = 1e9;
+        IncrementalStats stats = { 0 };
+        same = expected != NULL;
+        for (int run = 0; same && run < BENCH_RUNS; run++) {
+            double start = now_seconds();
+            bool applied = incremental_edit(&ip, &apply);
+            double elapsed = now_seconds() - start;
+            if (elapsed < best && applied && !ip.stats.fresh) {
+                best = elapsed;
+                stats = ip.stats;
+            }
+            if (!applied || !same_parse(ip.parser, expected) ||
+                !incremental_edit(&ip, &undo) || !same_parse(ip.parser, original)) {
+                same = false;
+            }
+        }
+        if (!same) fprintf(stderr, "  %s: edit failed or differs from a fresh parse\n", edit->name);
+        if (expected) free_parser(expected);
+        free(edited);
+        free(removed);
+        printf("  %-20s  %9.1f us  (relexed %d, reparsed %d tokens, reused %d lists%s)\n", edit->name,
+               best * 1e6, stats.relexed, stats.reparsed, stats.reused,
+               stats.whole_program ? ", whole program" : "");
+    }
+
+    if (original) free_parser(original);
+    incremental_close(&ip);
+    free(program);
+    return same;
+}
+
+static unsigned long long check_state = 88172645463325252ull;
+
+static size_t check_random(size_t n) {
+    check_state ^= check_state << 13;
+    check_state ^= check_state >> 7;
+    check_state ^= check_state << 17;
+    return n > 0 ? (size_t)(check_state % n) : 0;
+}
+
+// Makes the edit and checks it; false (and says so) on a mismatch
+static bool check_edit(IncrementalParse* ip, const char* path, const SourceEdit* edit, int number) {
+    if (incremental_edit(ip, edit) && matches_fresh(ip)) return true;
+    fprintf(stderr, "%s: edit %d (%zu bytes at %zu for %zu) differs from a fresh parse\n", path, number,
+            edit->removed, edit->offset, edit->length);
+    return false;
+}
+
+static bool check_file(const char* path) {
+    SourceBuffer source;
+    if (!openSource(&source, path)) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    IncrementalParse ip;
+    if (!incremental_open(&ip, "", 0, EXPRESSION_TREE_TEXTBOOK)) {
+        fprintf(stderr, "out of memory\n");
+        closeSource(&source);
+        return false;
+    }
+    int edits = 0;
+    bool same = true;
+    for (size_t i = 0; same && i < source.length; i++) {
+        SourceEdit edit = { i, 0, source.data + i, 1 };
+        same = check_edit(&ip, path, &edit, ++edits);
+    }
+    for (size_t i = source.length / 2; same && i > 0; i--) {
+        SourceEdit edit = { i - 1, 1, "", 0 };
+        same = check_edit(&ip, path, &edit, ++edits);
+    }
+    for (int e = 0; same && e < CHECK_RANDOM_EDITS; e++) {
+        size_t offset = check_random(ip.length + 1);
+        size_t removed = check_random(3) == 0 ? check_random(ip.length - offset < 40 ? ip.length - offset + 1 : 40) : 0;
+        size_t from = check_random(source.length);
+        size_t length = check_random(source.length - from < 40 ? source.length - from + 1 : 40);
+        SourceEdit edit = { offset, removed, source.data + from, length };
+        same = check_edit(&ip, path, &edit, ++edits);
+    }
+    if (same) printf("%s: %d edits, each the same as a fresh parse\n", path, edits);
+    incremental_close(&ip);
+    closeSource(&source);
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    static const int default_sizes[] = { 100, 1000, 10000 };
+    parser_verbosity = 0;
+    bool ok = true;
+    if (argc > 1 && strcmp(argv[1], "--check") == 0) {
+        for (int i = 2; i < argc; i++) ok = check_file(argv[i]) && ok;
+    } else if (argc > 1) {
+        for (int i = 1; i < argc; i++) ok = bench_size(atoi(argv[i])) && ok;
+    } else {
+        for (int i = 0; i < 3; i++) ok = bench_size(default_sizes[i]) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+// Parse-time benchmark: nanoseconds per token and tree memory for each parsing
+// engine on a generated program, lexing excluded. Console chatter is off, as in
+// the batch CLI. Each engine is timed with the transition log reset and on
+// ("parse", as for the transition reports) and with it off ("quiet"); build
+// with -DPARSER_TRACE=0 to time the hooks compiled out.
+//
+// Build: gcc -O2 bench_parser.c parser.c grammar.c table_parser.c ast.c transitions.c output.c treefile.c diagnostics.c incremental.c frontend.c arena.c
+//            bench_common.c ../Lexer/lexer.c ../Lexer/source.c ../Lexer/WordHash.c ../Lexer/tokenfile.c ../Lexer/skip.c -o bench_parser
+//        (or: make bench)
+// Usage: bench_parser [file.usb [descent|compact|table|ast]]
+//   (no file: a generated program of ~2000 statements; no engine: all;
+//   compact is the descent engine building compact expression trees)
+#include "parser.h"
+#include "frontend.h"
+#include "table_parser.h"
+#include "ast.h"
+#include "transitions.h"
+#include "bench_common.h"
+#include "../Lexer/source.h"
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#define BENCH_RUNS 200
+#define GENERATED_BLOCKS 100
+
+static const struct {
+    const char* name;
+    bool (*parse)(Parser* p);
+    ExpressionTree expressions;
+} engines[] = {
+    { "descent", parse_program,       EXPRESSION_TREE_TEXTBOOK },
+    { "compact", parse_program,       EXPRESSION_TREE_COMPACT },
+    { "table",   parse_program_table, EXPRESSION_TREE_TEXTBOOK },
+    { "ast",     parse_program_ast,   EXPRESSION_TREE_TEXTBOOK },
+};
+#define ENGINE_COUNT (int)(sizeof(engines) / sizeof(engines[0]))
+
+// Bytes of the parser's arena in use: the tree's nodes
+static size_t tree_bytes(const Parser* parser) {
+    size_t used = 0;
+    for (const ArenaBlock* block = parser->nodes.blocks; block; block = block->next) {
+        used += block->used;
+    }
+    return used;
+}
+
+int main(int argc, char* argv[]) {
+    SourceBuffer source;
+    char* generated = NULL;
+    if (argc > 1) {
+        if (!openSource(&source, argv[1])) {
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+    } else {
+        generated = generate_program(GENERATED_BLOCKS, &source.length);
+        source.data = generated;
+    }
+
+#ifdef __GLIBC__
+    // Keep freed trees and logs mapped from run to run, or every run pays for
+    // page faults as glibc hands the large blocks back to the system
+    mallopt(M_TRIM_THRESHOLD, 256 * 1024 * 1024);
+    mallopt(M_MMAP_THRESHOLD, 256 * 1024 * 1024);
+#endif
+    parser_verbosity = 0;
+    TokenStore tokens;
+    init_token_store(&tokens);
+    if (!lex_source(source.data, source.length, &tokens, NULL) || tokens.count == 0) {
+        fprintf(stderr, "nothing to parse\n");
+        return EXIT_FAILURE;
+    }
+    int count = tokens.count;
+    free_token_store(&tokens);
+
+    printf("%d tokens\n", count);
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        if (argc > 2 && strcmp(argv[2], engines[e].name) != 0) continue;
+        double best[2] = { 1e9, 1e9 }, best_free = 1e9;  // by tracing off, on
+        int errors = 0;
+        size_t bytes = 0;
+        for (int run = 0; run < 2 * BENCH_RUNS; run++) {
+            // The parser takes over its tokens, so each run lexes again (untimed)
+            lex_source(source.data, source.length, &tokens, NULL);
+            Parser* parser = create_parser(&tokens);
+            parser->expression_tree = engines[e].expressions;
+            int traced = run < BENCH_RUNS;
+            transition_tracing = traced;
+            init_transition_tracking();
+
+            double start = now_seconds();
+            engines[e].parse(parser);
+            double elapsed = now_seconds() - start;
+            if (elapsed < best[traced]) best[traced] = elapsed;
+            errors = parser->error_count;
+            bytes = tree_bytes(parser);
+
+            start = now_seconds();
+            free_parser(parser);
+            elapsed = now_seconds() - start;
+            if (elapsed < best_free) best_free = elapsed;
+        }
+
+        printf("%s: %d syntax errors\n", engines[e].name, errors);
+        printf("  parse: %.1f ns/token (%.2f ms per parse, best of %d)\n",
+               best[1] * 1e9 / count, best[1] * 1e3, BENCH_RUNS);
+        printf("  quiet: %.1f ns/token (no transition log)\n", best[0] * 1e9 / count);
+        printf("  free:  %.1f ns/token (tree and tokens)\n", best_free * 1e9 / count);
+        printf("  tree:  %.1f bytes/token (%zu KB)\n", (double)bytes / count, bytes / 1024);
+    }
+    if (generated) free(generated);
+    else closeSource(&source);
+    return EXIT_SUCCESS;
+}
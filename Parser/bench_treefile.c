@@ -0,0 +1,241 @@
+// Parse tree formats benchmark: size and write time of the two text layouts,
+// JSON and the binary image for one parse tree, and the time another program
+// needs to get the tree back: loading the JSON into nodes, mapping and walking
+// the image, or for the text layouts just mapping the file and counting its
+// lines, a floor under any script that re-parses them.
+//
+// Build: gcc -O2 bench_treefile.c parser.c grammar.c table_parser.c ast.c transitions.c output.c treefile.c diagnostics.c incremental.c frontend.c arena.c
+//            bench_common.c ../Lexer/lexer.c ../Lexer/source.c ../Lexer/WordHash.c ../Lexer/tokenfile.c ../Lexer/skip.c -o bench_treefile
+//        (or: make bench)
+// Usage: bench_treefile [file.usb]
+//   (no file: a generated program of ~2000 statements; the files are written
+//   to bench_tree.tmp in the current directory and removed afterwards)
+// The JSON and image trees read back are compared node by node with the
+// parsed one; the exit status is nonzero if one differs.
+#include "parser.h"
+#include "frontend.h"
+#include "treefile.h"
+#include "bench_common.h"
+#include "../Lexer/source.h"
+
+#define BENCH_RUNS 10
+#define GENERATED_BLOCKS 100
+#define BENCH_FILE "bench_tree.tmp"
+
+enum { FORMAT_VISUAL, FORMAT_PARENTHESIZED, FORMAT_JSON, FORMAT_BINARY, FORMAT_COUNT };
+static const char* format_names[FORMAT_COUNT] = { "visual", "parenthesized", "json", "binary" };
+
+static bool write_format(int format, const ParseTreeNode* tree) {
+    switch (format) {
+        case FORMAT_VISUAL:        return write_parse_tree_to_file(BENCH_FILE, (ParseTreeNode*)tree, true);
+        case FORMAT_PARENTHESIZED: return write_parse_tree_to_file(BENCH_FILE, (ParseTreeNode*)tree, false);
+        case FORMAT_JSON:          return write_parse_tree_json(BENCH_FILE, tree);
+        default:                   return write_parse_tree_image(BENCH_FILE, tree);
+    }
+}
+
+// Gets the tree back from the file; returns how many nodes (lines for text)
+static size_t read_format(int format) {
+    size_t count = 0;
+    if (format == FORMAT_JSON) {
+        LoadedParseTree tree;
+        if (!load_parse_tree_json(BENCH_FILE, &tree)) return 0;
+        // Walk it, as a tool would: preorder, the pending siblings on a stack
+        size_t capacity = 1024, depth = 0;
+        const ParseTreeNode** stack = (const ParseTreeNode**)malloc(capacity * sizeof(*stack));
+        if (stack && tree.root) stack[depth++] = tree.root;
+        while (depth > 0) {
+            const ParseTreeNode* node = stack[--depth];
+            count++;
+            if (depth + 2 > capacity) {
+                const ParseTreeNode** grown = (const ParseTreeNode**)realloc(stack, 2 * capacity * sizeof(*stack));
+                if (!grown) break;
+                stack = grown;
+                capacity *= 2;
+            }
+            if (node->next_sibling) stack[depth++] = node->next_sibling;
+            if (node->first_child) stack[depth++] = node->first_child;
+        }
+        free(stack);
+        free_loaded_parse_tree(&tree);
+    } else if (format == FORMAT_BINARY) {
+        TreeImage image;
+        if (!open_tree_image(BENCH_FILE, &image)) return 0;
+        size_t name_bytes = 0;
+        for (uint32_t i = 0; i < image.header.node_count; i++) {
+            TreeImageNode node = tree_image_node(&image, i);
+            name_bytes += tree_image_kind_name(&image, &node)[0];
+            count++;
+        }
+        if (name_bytes == 0) count = 0;
+        close_tree_image(&image);
+    } else {
+        SourceBuffer file;
+        if (!openSource(&file, BENCH_FILE)) return 0;
+        for (const char* p = file.data; (p = memchr(p, '\n', file.data + file.length - p)) != NULL; p++) {
+            count++;
+        }
+        closeSource(&file);
+    }
+    return count;
+}
+
+// Same kind and value, node for node in the same child order, as the tree the
+// file was written from: the JSON loaded back or the image walked in preorder.
+// The text layouts cannot be read back, they pass.
+static bool same_as_written(int format, const ParseTreeNode* tree) {
+    if (format != FORMAT_JSON && format != FORMAT_BINARY) return true;
+    LoadedParseTree loaded;
+    TreeImage image;
+    if (format == FORMAT_JSON ? !load_parse_tree_json(BENCH_FILE, &loaded) : !open_tree_image(BENCH_FILE, &image)) {
+        return false;
+    }
+
+    // Pending pairs: a written node and its counterpart, the loaded node or
+    // the image node's index
+    typedef struct {
+        const ParseTreeNode* written;
+        const ParseTreeNode* loaded;
+        uint32_t index;
+    } Pair;
+    size_t capacity = 1024, depth = 0;
+    uint32_t visited = 0;
+    Pair* stack = (Pair*)malloc(capacity * sizeof(*stack));
+    bool same = stack != NULL;
+    if (same) {
+        if (format == FORMAT_JSON) same = (tree == NULL) == (loaded.root == NULL);
+        else same = tree != NULL || image.header.node_count == 0;
+        if (same && tree) stack[depth++] = (Pair){ tree, format == FORMAT_JSON ? loaded.root : NULL, 0 };
+    }
+    while (same && depth > 0) {
+        Pair pair = stack[--depth];
+        const ParseTreeNode* node = pair.written;
+        const char* kind;
+        const char* value;
+        bool has_child, has_sibling;
+        Pair child = { node->first_child, NULL, 0 }, sibling = { node->next_sibling, NULL, 0 };
+        if (format == FORMAT_JSON) {
+            const ParseTreeNode* other = pair.loaded;
+            kind = node_name(other);
+            value = other->value;
+            has_child = other->first_child != NULL;
+            has_sibling = other->next_sibling != NULL;
+            child.loaded = other->first_child;
+            sibling.loaded = other->next_sibling;
+        } else {
+            if (pair.index >= image.header.node_count) {
+                same = false;
+                break;
+            }
+            TreeImageNode other = tree_image_node(&image, pair.index);
+            kind = tree_image_kind_name(&image, &other);
+            value = tree_image_value(&image, &other);
+            has_child = other.first_child != TREE_IMAGE_NONE;
+            has_sibling = other.next_sibling != TREE_IMAGE_NONE;
+            child.index = other.first_child;
+            sibling.index = other.next_sibling;
+        }
+        visited++;
+        same = strcmp(kind, node_name(node)) == 0 &&
+               (value == NULL) == (node->value == NULL) && (!value || strcmp(value, node->value) == 0) &&
+               has_child == (node->first_child != NULL) && has_sibling == (node->next_sibling != NULL);
+        if (!same) break;
+        if (depth + 2 > capacity) {
+            Pair* grown = (Pair*)realloc(stack, 2 * capacity * sizeof(*stack));
+            if (!grown) {
+                same = false;
+                break;
+            }
+            stack = grown;
+            capacity *= 2;
+        }
+        if (has_sibling) stack[depth++] = sibling;
+        if (has_child) stack[depth++] = child;
+    }
+    // Each image node once: preorder leaves none out and none over
+    if (same && format == FORMAT_BINARY) same = visited == image.header.node_count;
+    free(stack);
+    if (format == FORMAT_JSON) free_loaded_parse_tree(&loaded);
+    else close_tree_image(&image);
+    return same;
+}
+
+static long file_size(const char* filename) {
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+int main(int argc, char* argv[]) {
+    SourceBuffer source;
+    char* generated = NULL;
+    if (argc > 1) {
+        if (!openSource(&source, argv[1])) {
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+    } else {
+        generated = generate_program(GENERATED_BLOCKS, &source.length);
+        source.data = generated;
+    }
+
+    parser_verbosity = 0;
+    TokenStore tokens;
+    init_token_store(&tokens);
+    if (!lex_source(source.data, source.length, &tokens, NULL) || tokens.count == 0) {
+        fprintf(stderr, "nothing to parse\n");
+        return EXIT_FAILURE;
+    }
+    Parser* parser = create_parser(&tokens);
+    parse_program(parser);
+
+    // The image's header has the node count
+    TreeImage image;
+    if (!write_parse_tree_image(BENCH_FILE, parser->parse_tree) || !open_tree_image(BENCH_FILE, &image)) {
+        fprintf(stderr, "cannot write %s\n", BENCH_FILE);
+        return EXIT_FAILURE;
+    }
+    size_t nodes = image.header.node_count;
+    close_tree_image(&image);
+    printf("%d tokens, %zu parse tree nodes\n", parser->token_count, nodes);
+
+    int status = EXIT_SUCCESS;
+    for (int f = 0; f < FORMAT_COUNT; f++) {
+        double best_write = 1e9, best_read = 1e9;
+        size_t read = 0;
+        long size = 0;
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            double start = now_seconds();
+            if (!write_format(f, parser->parse_tree)) {
+                fprintf(stderr, "cannot write %s\n", BENCH_FILE);
+                return EXIT_FAILURE;
+            }
+            double elapsed = now_seconds() - start;
+            if (elapsed < best_write) best_write = elapsed;
+            size = file_size(BENCH_FILE);
+
+            start = now_seconds();
+            read = read_format(f);
+            elapsed = now_seconds() - start;
+            if (elapsed < best_read) best_read = elapsed;
+        }
+
+        bool same = same_as_written(f, parser->parse_tree);
+        printf("%s: %.1f bytes/node (%ld KB)\n", format_names[f], (double)size / nodes, size / 1024);
+        printf("  write: %.1f ns/node (%.0f MB/s, best of %d)\n",
+               best_write * 1e9 / nodes, size / best_write / 1e6, BENCH_RUNS);
+        printf("  read:  %.1f ns/node (%s %zu %s)\n", best_read * 1e9 / nodes,
+               f == FORMAT_JSON ? "loaded and walked," : f == FORMAT_BINARY ? "mapped and walked," : "mapped, counted",
+               read, f < FORMAT_JSON ? "lines" : "nodes");
+        if (f == FORMAT_JSON || f == FORMAT_BINARY) printf("  same tree: %s\n", same ? "yes" : "NO");
+        if (!same) status = EXIT_FAILURE;
+    }
+    remove(BENCH_FILE);
+    free_parser(parser);
+    if (generated) free(generated);
+    else closeSource(&source);
+    return status;
+}
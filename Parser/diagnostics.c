@@ -0,0 +1,123 @@
+#include "diagnostics.h"
+
+typedef struct {
+    const char* name;
+    DiagnosticArgs args;
+    TokenKind expected;
+    int nonterminal;
+    const char* text;
+} DiagnosticInfo;
+
+static const DiagnosticInfo diagnostic_info[DIAG_COUNT] = {
+#define DIAGNOSTIC_INFO(id, args, kind, nonterminal, text) { #id, args, kind, nonterminal, text },
+    PARSER_DIAGNOSTICS(DIAGNOSTIC_INFO)
+#undef DIAGNOSTIC_INFO
+};
+
+const char* diagnostic_code_name(DiagnosticCode code) {
+    return (unsigned)code < DIAG_COUNT ? diagnostic_info[code].name : "DIAG_UNKNOWN";
+}
+
+// The next diagnostic of the list, NULL when out of memory
+static Diagnostic* new_diagnostic(Parser* p) {
+    if (p->error_count == p->diagnostic_capacity) {
+        int capacity = p->diagnostic_capacity ? 2 * p->diagnostic_capacity : 16;
+        Diagnostic* grown = (Diagnostic*)realloc(p->diagnostics, capacity * sizeof(Diagnostic));
+        if (!grown) return NULL;
+        p->diagnostics = grown;
+        p->diagnostic_capacity = capacity;
+    }
+    return &p->diagnostics[p->error_count++];
+}
+
+bool add_diagnostic(Parser* p, const Diagnostic* diagnostic) {
+    Diagnostic* d = new_diagnostic(p);
+    if (!d) return false;
+    *d = *diagnostic;
+    return true;
+}
+
+static void record(Parser* p, DiagnosticCode code, TokenKind expected, int nonterminal, int line) {
+    Diagnostic* d = new_diagnostic(p);
+    if (!d) return;
+    d->code = (uint16_t)code;
+    d->nonterminal = (int16_t)nonterminal;
+    d->expected = expected;
+    d->token = p->current_token ? p->pos : -1;
+    d->line = line;
+#if PARSER_TRACE
+    if (parser_verbosity > 0) {
+        printf("ERROR: ");
+        write_diagnostic(stdout, p, d);
+        printf("\n");
+    }
+#endif
+}
+
+void parser_error(Parser* p, DiagnosticCode code) {
+    record(p, code, diagnostic_info[code].expected, diagnostic_info[code].nonterminal, 0);
+}
+
+void parser_error_line(Parser* p, DiagnosticCode code, int line) {
+    record(p, code, diagnostic_info[code].expected, diagnostic_info[code].nonterminal, line);
+}
+
+void parser_error_expected(Parser* p, TokenKind expected) {
+    record(p, DIAG_EXPECTED_TOKEN, expected, -1, 0);
+}
+
+void parser_error_expected_nonterminal(Parser* p, GrammarNonterminal nonterminal) {
+    record(p, DIAG_EXPECTED_NONTERMINAL, T_NONE, nonterminal, 0);
+}
+
+// The message alone, into buffer like snprintf
+static int format_message(const Diagnostic* d, const ParserToken* token, char* buffer, size_t size) {
+    const DiagnosticInfo* info = &diagnostic_info[d->code];
+    switch (info->args) {
+        case DIAG_ARGS_EXPECTED:
+            return snprintf(buffer, size, info->text, token_kind_name(d->expected),
+                            token ? token_kind_name(token->kind) : "EOF");
+        case DIAG_ARGS_NONTERMINAL:
+            return snprintf(buffer, size, info->text, token ? "token" : "end of file",
+                            grammar_nonterminal_name((GrammarNonterminal)d->nonterminal));
+        case DIAG_ARGS_LEXEME:
+            return snprintf(buffer, size, info->text, token ? token->lexeme : "");
+        case DIAG_ARGS_LINE:
+            return snprintf(buffer, size, info->text, d->line);
+        default:
+            return snprintf(buffer, size, "%s", info->text);
+    }
+}
+
+int format_diagnostic(const Parser* p, const Diagnostic* d, char* buffer, size_t size) {
+    ParserToken current;
+    const ParserToken* token = d->token >= 0 ? read_token(&p->tokens, d->token, &current) : NULL;
+    int length = token ? snprintf(buffer, size, "Line %d: ", token->line)
+                       : snprintf(buffer, size, "End of file: ");
+    length += format_message(d, token, (size_t)length < size ? buffer + length : NULL,
+                             (size_t)length < size ? size - length : 0);
+    if (token) {
+        length += snprintf((size_t)length < size ? buffer + length : NULL,
+                           (size_t)length < size ? size - length : 0,
+                           " (Found: %s '%s')", token_kind_name(token->kind), token->lexeme);
+    }
+    return length;
+}
+
+void write_diagnostic(FILE* fp, const Parser* p, const Diagnostic* d) {
+    char text[512];
+    int length = format_diagnostic(p, d, text, sizeof(text));
+    if ((size_t)length < sizeof(text)) {
+        fputs(text, fp);
+        return;
+    }
+    // A long lexeme: the message as large as it is
+    char* long_text = (char*)malloc((size_t)length + 1);
+    if (!long_text) {
+        fputs(text, fp);
+        return;
+    }
+    format_diagnostic(p, d, long_text, (size_t)length + 1);
+    fputs(long_text, fp);
+    free(long_text);
+}
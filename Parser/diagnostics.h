@@ -0,0 +1,106 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include "grammar.h"
+
+// Syntax errors. The engines record each one as a small Diagnostic (what went
+// wrong, at which token, what was expected) in the parser's growable list;
+// the text is only made when a report asks for it, so an error costs 16 bytes
+// and no formatting while parsing, and there is no limit on how many are kept.
+
+// Diagnostics: id, what the message takes, the token kind and the nonterminal
+// whose FIRST set were expected there (T_NONE / -1 for none) and the message.
+// DIAG_ARGS_LINE messages name the diagnostic's related line.
+#define PARSER_DIAGNOSTICS(X) \
+    X(DIAG_EXPECTED_TOKEN,         DIAG_ARGS_EXPECTED,    T_NONE,         -1,                  "Expected %s but found %s") \
+    X(DIAG_EXPECTED_NONTERMINAL,   DIAG_ARGS_NONTERMINAL, T_NONE,         -1,                  "Unexpected %s - expected %s") \
+    X(DIAG_EXPECTED_PROGRAM,       DIAG_ARGS_NONE,        T_NONE,         G_PROGRAM,           "Expected main function or class definition") \
+    X(DIAG_EXPECTED_BODY,          DIAG_ARGS_NONE,        T_D_LBRACE,     -1,                  "Expected '{' to start function body") \
+    X(DIAG_EXPECTED_RETURN_TYPE,   DIAG_ARGS_NONE,        T_NONE,         G_RETURN_TYPE,       "Expected return type (R_BILANG, R_VOID, or R_WALA)") \
+    X(DIAG_UNEXPECTED_IN_BLOCK,    DIAG_ARGS_LEXEME,      T_D_RBRACE,     G_STATEMENT,         "Unexpected token '%s' - expected statement or '}'") \
+    X(DIAG_END_IN_STATEMENT,       DIAG_ARGS_NONE,        T_NONE,         G_STATEMENT,         "Unexpected end of file in statement") \
+    X(DIAG_INVALID_STATEMENT,      DIAG_ARGS_NONE,        T_NONE,         G_STATEMENT,         "Invalid statement - expected declaration, assignment, or control structure") \
+    X(DIAG_DECLARATION_SEMICOLON,  DIAG_ARGS_LINE,        T_D_SEMICOLON,  -1,                  "Missing semicolon at end of declaration (expected after line %d)") \
+    X(DIAG_EXPECTED_DATA_TYPE,     DIAG_ARGS_NONE,        T_NONE,         G_DATA_TYPE,         "Expected data type (R_BILANG, R_LUTANG, R_BULYAN, or R_KWERDAS)") \
+    X(DIAG_IDENTIFIER_AFTER_COMMA, DIAG_ARGS_NONE,        T_L_IDENTIFIER, -1,                  "Expected identifier after comma") \
+    X(DIAG_MISSING_COMMA,          DIAG_ARGS_NONE,        T_D_COMMA,      -1,                  "Missing comma between identifiers in declaration") \
+    X(DIAG_ASSIGNMENT_SEMICOLON,   DIAG_ARGS_LINE,        T_D_SEMICOLON,  -1,                  "Missing semicolon at end of assignment (line %d)") \
+    X(DIAG_CONSECUTIVE_OPERATORS,  DIAG_ARGS_NONE,        T_NONE,         G_FACTOR,            "Unexpected operator - expression cannot contain consecutive operators") \
+    X(DIAG_UNCLOSED_PARENTHESIS,   DIAG_ARGS_LINE,        T_D_RPAREN,     -1,                  "Missing closing parenthesis ')' for '(' on line %d") \
+    X(DIAG_DOUBLE_OPERATOR,        DIAG_ARGS_NONE,        T_NONE,         G_FACTOR,            "Unexpected operator in expression (possible double operator)") \
+    X(DIAG_EXPECTED_OPERAND,       DIAG_ARGS_NONE,        T_NONE,         G_FACTOR,            "Expected identifier, literal, constant, or '(' in expression") \
+    X(DIAG_CONDITION_RPAREN,       DIAG_ARGS_NONE,        T_D_RPAREN,     -1,                  "Missing ')' after condition") \
+    X(DIAG_CONDITION_LBRACE,       DIAG_ARGS_NONE,        T_D_LBRACE,     -1,                  "Missing '{' after condition") \
+    X(DIAG_IF_RBRACE,              DIAG_ARGS_NONE,        T_D_RBRACE,     -1,                  "Missing '}' at end of if block") \
+    X(DIAG_EXPECTED_RELOP,         DIAG_ARGS_NONE,        T_NONE,         G_RELOP,             "Expected relational operator") \
+    X(DIAG_FOR_LPAREN,             DIAG_ARGS_NONE,        T_D_LPAREN,     -1,                  "Missing '(' after 'para'") \
+    X(DIAG_FOR_INIT,               DIAG_ARGS_NONE,        T_NONE,         G_FOR_INIT,          "Expected initialization in for loop") \
+    X(DIAG_FOR_RELOP,              DIAG_ARGS_NONE,        T_NONE,         G_RELOP,             "Expected relational operator in condition") \
+    X(DIAG_FOR_CONDITION,          DIAG_ARGS_NONE,        T_NONE,         G_FOR_CONDITION,     "Expected condition in for loop") \
+    X(DIAG_FOR_SEMICOLON,          DIAG_ARGS_NONE,        T_D_SEMICOLON,  -1,                  "Missing ';' after for loop condition") \
+    X(DIAG_FOR_ASSIGN,             DIAG_ARGS_NONE,        T_O_ASSIGN,     -1,                  "Expected '=' in for loop increment") \
+    X(DIAG_FOR_INCREMENT,          DIAG_ARGS_NONE,        T_NONE,         G_FOR_INCREMENT,     "Expected increment expression in for loop") \
+    X(DIAG_FOR_RPAREN,             DIAG_ARGS_NONE,        T_D_RPAREN,     -1,                  "Missing ')' in for loop header") \
+    X(DIAG_FOR_LBRACE,             DIAG_ARGS_NONE,        T_D_LBRACE,     -1,                  "Missing '{' for for loop body") \
+    X(DIAG_FOR_RBRACE,             DIAG_ARGS_NONE,        T_D_RBRACE,     -1,                  "Missing '}' at end of for loop") \
+    X(DIAG_WHILE_RPAREN,           DIAG_ARGS_NONE,        T_D_RPAREN,     -1,                  "Missing ')' after while condition") \
+    X(DIAG_WHILE_LBRACE,           DIAG_ARGS_NONE,        T_D_LBRACE,     -1,                  "Missing '{' for while loop body") \
+    X(DIAG_WHILE_RBRACE,           DIAG_ARGS_NONE,        T_D_RBRACE,     -1,                  "Missing '}' at end of while loop") \
+    X(DIAG_DO_LBRACE,              DIAG_ARGS_NONE,        T_D_LBRACE,     -1,                  "Missing '{' after 'gawin'") \
+    X(DIAG_DO_RBRACE,              DIAG_ARGS_NONE,        T_D_RBRACE,     -1,                  "Missing '}' in do-while loop") \
+    X(DIAG_DO_HABANG,              DIAG_ARGS_NONE,        T_K_HABANG,     -1,                  "Expected 'habang' after do-while body") \
+    X(DIAG_DO_RPAREN,              DIAG_ARGS_NONE,        T_D_RPAREN,     -1,                  "Missing ')' in do-while condition") \
+    X(DIAG_DO_SEMICOLON,           DIAG_ARGS_LINE,        T_D_SEMICOLON,  -1,                  "Missing ';' at end of do-while statement (expected after line %d)") \
+    X(DIAG_PRINT_LPAREN,           DIAG_ARGS_NONE,        T_D_LPAREN,     -1,                  "Missing '(' after 'ani'") \
+    X(DIAG_PRINT_RPAREN,           DIAG_ARGS_NONE,        T_D_RPAREN,     -1,                  "Missing ')' in print statement") \
+    X(DIAG_PRINT_SEMICOLON,        DIAG_ARGS_NONE,        T_D_SEMICOLON,  -1,                  "Missing ';' at end of print statement") \
+    X(DIAG_SCAN_LPAREN,            DIAG_ARGS_NONE,        T_D_LPAREN,     -1,                  "Missing '(' after 'tanim'") \
+    X(DIAG_SCAN_RPAREN,            DIAG_ARGS_NONE,        T_D_RPAREN,     -1,                  "Missing ')' in scan statement") \
+    X(DIAG_SCAN_SEMICOLON,         DIAG_ARGS_NONE,        T_D_SEMICOLON,  -1,                  "Missing ';' at end of scan statement") \
+    X(DIAG_TRAILING_TOKEN,         DIAG_ARGS_LEXEME,      T_NONE,         -1,                  "Unexpected token '%s' after the end of the program") \
+    X(DIAG_OUT_OF_MEMORY,          DIAG_ARGS_NONE,        T_NONE,         -1,                  "Out of memory for the parse stack")
+
+// What a diagnostic's message is filled in with
+typedef enum {
+    DIAG_ARGS_NONE,
+    DIAG_ARGS_EXPECTED,     // the expected kind's name, the found kind's name or "EOF"
+    DIAG_ARGS_NONTERMINAL,  // "token" or "end of file", the expected nonterminal's name
+    DIAG_ARGS_LEXEME,       // the token's lexeme
+    DIAG_ARGS_LINE          // the related line
+} DiagnosticArgs;
+
+typedef enum {
+#define DIAGNOSTIC_ENUM(id, args, kind, nonterminal, text) id,
+    PARSER_DIAGNOSTICS(DIAGNOSTIC_ENUM)
+#undef DIAGNOSTIC_ENUM
+    DIAG_COUNT
+} DiagnosticCode;
+
+typedef struct Diagnostic {
+    uint16_t code;          // DiagnosticCode
+    int16_t nonterminal;    // GrammarNonterminal whose FIRST set was expected, -1 for none
+    int32_t expected;       // TokenKind expected, T_NONE for none
+    int32_t token;          // index of the token it was found at, -1 at the end of input
+    int32_t line;           // related line (DIAG_ARGS_LINE), 0 for none
+} Diagnostic;
+
+// Records an error at the current token with the code's expected kind and
+// nonterminal, echoing it to the console when verbose
+void parser_error(Parser* p, DiagnosticCode code);
+// The same, naming the related line
+void parser_error_line(Parser* p, DiagnosticCode code, int line);
+// DIAG_EXPECTED_TOKEN for the kind, DIAG_EXPECTED_NONTERMINAL for the nonterminal
+void parser_error_expected(Parser* p, TokenKind expected);
+void parser_error_expected_nonterminal(Parser* p, GrammarNonterminal nonterminal);
+// Appends a diagnostic as it is, without the console echo (an incremental
+// reparse carrying one over, incremental.c); false when out of memory
+bool add_diagnostic(Parser* p, const Diagnostic* diagnostic);
+
+// The message as the parser has always reported it: "Line N: message (Found:
+// KIND 'lexeme')", or "End of file: message". Formats into buffer like
+// snprintf and returns the full length.
+int format_diagnostic(const Parser* p, const Diagnostic* diagnostic, char* buffer, size_t size);
+void write_diagnostic(FILE* fp, const Parser* p, const Diagnostic* diagnostic);
+const char* diagnostic_code_name(DiagnosticCode code);    // "DIAG_EXPECTED_TOKEN"
+
+#endif
@@ -0,0 +1,45 @@
+#include "frontend.h"
+#include "../Lexer/lexer.h"
+#include "../Lexer/source.h"
+
+// Convert lexer tokens (spans into the source) into the parser's token store
+bool lex_source(const char* source, size_t length, TokenStore* tokens, FILE* symbol_dump) {
+    TokenList list;
+    lexTokens(source, length, &list);
+    if (symbol_dump) {
+        writeSymbolTable(symbol_dump, source, &list);
+    }
+
+    // Lexemes never add up to more than the source plus a NUL each
+    bool ok = list.count <= (size_t)(INT32_MAX - tokens->count) &&
+              reserve_token_store(tokens, tokens->count + (int)list.count,
+                                  tokens->text_length + length + list.count);
+    for (size_t i = 0; ok && i < list.count; i++) {
+        const Token* t = &list.tokens[i];
+        ok = add_token(tokens, TOKEN_KIND(t->category, t->tokenValue),
+                       source + t->offset, t->length, t->lineNumber);
+    }
+    freeTokenList(&list);
+    return ok;
+}
+
+Parser* create_parser_for_file(const char* filename, FILE* symbol_dump) {
+    SourceBuffer source;
+    if (!openSource(&source, filename)) {
+        parser_log("\nERROR: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+
+    TokenStore tokens;
+    init_token_store(&tokens);
+    bool ok = lex_source(source.data, source.length, &tokens, symbol_dump);
+    closeSource(&source);
+    if (!ok) {
+        parser_log("\nERROR: Out of memory while lexing '%s'\n", filename);
+        free_token_store(&tokens);
+        return NULL;
+    }
+
+    parser_log("\nLexed %d tokens from '%s'.\n\n", tokens.count, filename);
+    return create_parser(&tokens);
+}
@@ -0,0 +1,23 @@
+#ifndef FRONTEND_H
+#define FRONTEND_H
+
+#include "parser.h"
+
+// Lexer -> parser handoff in one process: a .usb buffer is lexed and its tokens
+// go straight into create_parser, no "Symbol Table.txt" in between.
+//
+// Build (one binary): gcc -O2 -pthread main_parser.c parser.c grammar.c table_parser.c ast.c transitions.c output.c treefile.c diagnostics.c incremental.c frontend.c arena.c
+//     ../Lexer/lexer.c ../Lexer/source.c ../Lexer/WordHash.c ../Lexer/tokenfile.c ../Lexer/skip.c ../Lexer/cli.c -o usbong
+// Add -DPARSER_TRACE=0 for a production build without transition reports or
+// console progress lines.
+
+// Lex a source buffer, appending its tokens to the store. If symbol_dump is not
+// NULL the text symbol table is written there as well. Returns false on
+// allocation failure.
+bool lex_source(const char* source, size_t length, TokenStore* tokens, FILE* symbol_dump);
+
+// Lex a .usb file and create a parser over its tokens (parse_program not yet run).
+// symbol_dump is as for lex_source, NULL for none.
+Parser* create_parser_for_file(const char* filename, FILE* symbol_dump);
+
+#endif
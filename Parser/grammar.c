@@ -0,0 +1,212 @@
+#include "grammar.h"
+
+// Right-hand sides, one array per production
+#define GRAMMAR_RHS(id, lhs, node, ...) static const int rhs_##id[] = { __VA_ARGS__, GRAMMAR_END };
+GRAMMAR_PRODUCTIONS(GRAMMAR_RHS)
+#undef GRAMMAR_RHS
+
+static const ProductionInfo productions[P_COUNT] = {
+#define GRAMMAR_PRODUCTION_INFO(id, lhs, node, ...) { lhs, node, rhs_##id },
+    GRAMMAR_PRODUCTIONS(GRAMMAR_PRODUCTION_INFO)
+#undef GRAMMAR_PRODUCTION_INFO
+};
+
+static const char* nonterminal_names[G_NONTERMINAL_COUNT] = {
+#define GRAMMAR_NONTERMINAL_NAME(id, name, traced) name,
+    GRAMMAR_NONTERMINALS(GRAMMAR_NONTERMINAL_NAME)
+#undef GRAMMAR_NONTERMINAL_NAME
+};
+
+static const bool nonterminal_traced[G_NONTERMINAL_COUNT] = {
+#define GRAMMAR_NONTERMINAL_TRACED(id, name, traced) traced,
+    GRAMMAR_NONTERMINALS(GRAMMAR_NONTERMINAL_TRACED)
+#undef GRAMMAR_NONTERMINAL_TRACED
+};
+
+static bool built = false;
+static bool nullable[G_NONTERMINAL_COUNT];
+static TokenSet first[G_NONTERMINAL_COUNT];
+static TokenSet follow[G_NONTERMINAL_COUNT];
+static TokenSet recovery[G_NONTERMINAL_COUNT];
+static int16_t empty_production[G_NONTERMINAL_COUNT];
+
+// Production per nonterminal and lookahead. A guarded production applies only
+// when the symbol after the lookahead is its second terminal; choice then
+// holds the production to use otherwise.
+static int16_t choice[G_NONTERMINAL_COUNT][TOKEN_SET_SYMBOLS];
+static int16_t guarded[G_NONTERMINAL_COUNT][TOKEN_SET_SYMBOLS];
+
+// set |= other; returns true if set grew
+static bool token_set_merge(TokenSet* set, const TokenSet* other) {
+    bool grew = false;
+    for (int i = 0; i < TOKEN_SET_WORDS; i++) {
+        uint64_t merged = set->bits[i] | other->bits[i];
+        grew |= merged != set->bits[i];
+        set->bits[i] = merged;
+    }
+    return grew;
+}
+
+// Adds FIRST of a symbol sequence to out; returns true if all of it can derive ε
+static bool sequence_first(const int* rhs, TokenSet* out) {
+    for (const int* s = rhs; *s != GRAMMAR_END; s++) {
+        if (GRAMMAR_IS_STARTS_WITH(*s)) {
+            token_set_add(out, *s - GRAMMAR_STARTS_WITH(0));
+            return false;
+        }
+        if (GRAMMAR_IS_ACTION(*s)) continue;
+        if (!GRAMMAR_IS_NT(*s)) {
+            token_set_add(out, GRAMMAR_TERMINAL(*s));
+            return false;
+        }
+        int nonterminal = *s - GRAMMAR_NT(0);
+        token_set_merge(out, &first[nonterminal]);
+        if (!nullable[nonterminal]) return false;
+    }
+    return true;
+}
+
+static void build_sets(void) {
+    memset(empty_production, 0xFF, sizeof(empty_production));
+
+    // Nullable and FIRST, to a fixed point
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < P_COUNT; p++) {
+            const ProductionInfo* info = &productions[p];
+            TokenSet set = first[info->lhs];
+            bool empty = sequence_first(info->rhs, &set);
+            changed |= token_set_merge(&first[info->lhs], &set);
+            if (empty && !nullable[info->lhs]) {
+                nullable[info->lhs] = true;
+                empty_production[info->lhs] = (int16_t)p;
+                changed = true;
+            }
+        }
+    }
+
+    // FOLLOW: what can come after each nonterminal occurrence
+    token_set_add(&follow[G_PROGRAM], TOKEN_SET_EOF);
+    changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < P_COUNT; p++) {
+            const ProductionInfo* info = &productions[p];
+            for (const int* s = info->rhs; *s != GRAMMAR_END; s++) {
+                if (!GRAMMAR_IS_NT(*s)) continue;
+                int nonterminal = *s - GRAMMAR_NT(0);
+                TokenSet rest = {{0}};
+                if (sequence_first(s + 1, &rest)) {
+                    token_set_merge(&rest, &follow[info->lhs]);
+                }
+                changed |= token_set_merge(&follow[nonterminal], &rest);
+            }
+        }
+    }
+
+    // Recovery: a statement boundary (what can follow a statement, a ';' that
+    // ends one, a '{' that opens a block, the end of input) and what can follow
+    // the nonterminal. An identifier starts an assignment, but it is also most
+    // expressions' operands, so it never ends a skip.
+    TokenSet boundary = follow[G_STATEMENT];
+    token_set_add(&boundary, T_D_SEMICOLON);
+    token_set_add(&boundary, T_D_LBRACE);
+    token_set_add(&boundary, TOKEN_SET_EOF);
+    for (int n = 0; n < G_NONTERMINAL_COUNT; n++) {
+        recovery[n] = boundary;
+        token_set_merge(&recovery[n], &follow[n]);
+        token_set_remove(&recovery[n], T_L_IDENTIFIER);
+    }
+}
+
+static bool spells_out(GrammarProduction production, int symbol) {
+    const int* rhs = productions[production].rhs;
+    return GRAMMAR_TERMINAL(rhs[0]) == symbol && rhs[0] < GRAMMAR_NT(0) &&
+           rhs[1] != GRAMMAR_END && rhs[1] < GRAMMAR_NT(0);
+}
+
+static void add_choice(GrammarNonterminal nonterminal, int symbol, GrammarProduction production) {
+    int16_t* cell = &choice[nonterminal][symbol];
+    if (*cell == P_NONE) {
+        *cell = production;
+        return;
+    }
+    // Two productions on one lookahead: the one spelling out "symbol next ..."
+    // is tried first, the other is the fallback
+    if (spells_out(production, symbol)) {
+        guarded[nonterminal][symbol] = production;
+    } else if (spells_out((GrammarProduction)*cell, symbol)) {
+        guarded[nonterminal][symbol] = *cell;
+        *cell = production;
+    }
+    // Otherwise the grammar is not LL(1) here and the first production wins
+}
+
+static void build_table(void) {
+    memset(choice, 0xFF, sizeof(choice));
+    memset(guarded, 0xFF, sizeof(guarded));
+    for (int p = 0; p < P_COUNT; p++) {
+        const ProductionInfo* info = &productions[p];
+        TokenSet predict = {{0}};
+        if (sequence_first(info->rhs, &predict)) {
+            token_set_merge(&predict, &follow[info->lhs]);
+        }
+        for (int symbol = 0; symbol < TOKEN_SET_SYMBOLS; symbol++) {
+            if (token_set_has(&predict, symbol)) add_choice(info->lhs, symbol, (GrammarProduction)p);
+        }
+    }
+}
+
+static void build_grammar(void) {
+    if (built) return;
+    build_sets();
+    build_table();
+    built = true;
+}
+
+const ProductionInfo* grammar_production(GrammarProduction production) {
+    return &productions[production];
+}
+
+const char* grammar_nonterminal_name(GrammarNonterminal nonterminal) {
+    return nonterminal_names[nonterminal];
+}
+
+bool grammar_nonterminal_traced(GrammarNonterminal nonterminal) {
+    return nonterminal_traced[nonterminal];
+}
+
+const TokenSet* grammar_first(GrammarNonterminal nonterminal) {
+    build_grammar();
+    return &first[nonterminal];
+}
+
+const TokenSet* grammar_follow(GrammarNonterminal nonterminal) {
+    build_grammar();
+    return &follow[nonterminal];
+}
+
+const TokenSet* grammar_recovery(GrammarNonterminal nonterminal) {
+    build_grammar();
+    return &recovery[nonterminal];
+}
+
+bool grammar_nullable(GrammarNonterminal nonterminal) {
+    build_grammar();
+    return nullable[nonterminal];
+}
+
+GrammarProduction grammar_empty_production(GrammarNonterminal nonterminal) {
+    build_grammar();
+    return (GrammarProduction)empty_production[nonterminal];
+}
+
+GrammarProduction grammar_choice(GrammarNonterminal nonterminal, int lookahead, int next) {
+    build_grammar();
+    int16_t production = guarded[nonterminal][lookahead];
+    if (production != P_NONE && GRAMMAR_TERMINAL(productions[production].rhs[1]) == next) {
+        return (GrammarProduction)production;
+    }
+    return (GrammarProduction)choice[nonterminal][lookahead];
+}
@@ -0,0 +1,269 @@
+#ifndef GRAMMAR_H
+#define GRAMMAR_H
+
+#include "parser.h"
+
+// The grammar the parser implements, as data. It follows the railroad
+// diagrams (diagrams/diagram (1)/index.md) and fills in what they leave out
+// (MainFunction, StatementList, Statement, Declaration), shaped like the parse
+// tree the parser builds. FIRST and FOLLOW sets and the production to choose
+// for each lookahead are computed from it once, on first use.
+
+// Nonterminals: id, name and whether the parser logs ENTER/EXIT transitions
+// for it. The untraced ones are helpers the parser inlines, and Program.
+#define GRAMMAR_NONTERMINALS(X) \
+    X(G_PROGRAM,                 "Program",               false) \
+    X(G_CLASS_DEFINITIONS,       "ClassDefinitions",      false) \
+    X(G_MAIN_FUNCTION,           "MainFunction",          true) \
+    X(G_RETURN_TYPE,             "ReturnType",            true) \
+    X(G_PARAMETER_LIST,          "ParameterList",         true) \
+    X(G_FUNCTION_BODY,           "FunctionBody",          true) \
+    X(G_STATEMENT_LIST,          "StatementList",         true) \
+    X(G_STATEMENT,               "Statement",             true) \
+    X(G_DECLARATION,             "Declaration",           true) \
+    X(G_DATA_TYPE,               "DataType",              true) \
+    X(G_IDENTIFIER_LIST,         "IdentifierList",        true) \
+    X(G_IDENTIFIER_TAIL,         "IdentifierTail",        true) \
+    X(G_IDENTIFIER_INIT,         "IdentifierInit",        false) \
+    X(G_ASSIGNMENT,              "Assignment",            true) \
+    X(G_ASSIGNMENT_EXPRESSION,   "AssignmentExpression",  true) \
+    X(G_EXPRESSION,              "Expression",            true) \
+    X(G_EXPRESSION_TAIL,         "ExpressionTail",        true) \
+    X(G_TERM,                    "Term",                  true) \
+    X(G_TERM_TAIL,               "TermTail",              true) \
+    X(G_FACTOR,                  "Factor",                true) \
+    X(G_CONDITIONAL,             "Conditional",           true) \
+    X(G_CONDITIONAL_TAIL,        "ConditionalTail",       true) \
+    X(G_BOOLEAN_EXPRESSION,      "BooleanExpression",     true) \
+    X(G_RELOP,                   "RelOp",                 true) \
+    X(G_ITERATIVE,               "Iterative",             true) \
+    X(G_FOR_LOOP,                "ForLoop",               true) \
+    X(G_FOR_INIT,                "ForInit",               false) \
+    X(G_FOR_CONDITION,           "ForCondition",          false) \
+    X(G_FOR_INCREMENT,           "ForIncrement",          false) \
+    X(G_WHILE_LOOP,              "WhileLoop",             true) \
+    X(G_DO_WHILE_LOOP,           "DoWhileLoop",           true) \
+    X(G_PRINT,                   "Print",                 true) \
+    X(G_PRINT_ARGS,              "PrintArgs",             true) \
+    X(G_PRINT_ARGS_TAIL,         "PrintArgsTail",         false) \
+    X(G_SCAN,                    "Scan",                  true) \
+    X(G_SCAN_ARGS,               "ScanArgs",              true) \
+    X(G_SCAN_ARGS_TAIL,          "ScanArgsTail",          false) \
+    X(G_CLASS_DEFINITION,        "ClassDefinition",       true)
+
+typedef enum {
+#define GRAMMAR_NONTERMINAL_ENUM(id, name, traced) id,
+    GRAMMAR_NONTERMINALS(GRAMMAR_NONTERMINAL_ENUM)
+#undef GRAMMAR_NONTERMINAL_ENUM
+    G_NONTERMINAL_COUNT
+} GrammarNonterminal;
+
+// Right-hand side symbols: a terminal is its TokenKind, or GRAMMAR_QUIET(kind)
+// where the parser takes the token without a MATCH transition (one-of choices
+// such as DataType and RelOp). A nonterminal is GRAMMAR_NT(G_...). The actions
+// match no input: GRAMMAR_EPSILON spells out an
+// empty right-hand side, the next two add the tree's placeholder leaves, and
+// GRAMMAR_STARTS_WITH(kind) narrows a production's FIRST set to one token, as
+// the parser only takes an assignment statement or a for loop condition when
+// it starts with an identifier.
+#define GRAMMAR_QUIET(kind) (0x800 + (kind))
+#define GRAMMAR_IS_QUIET(symbol) ((symbol) >= 0x800 && (symbol) < 0x1000)
+#define GRAMMAR_TERMINAL(symbol) ((symbol) & 0x7FF)   // the TokenKind of either form
+#define GRAMMAR_NT(nonterminal) (0x1000 + (nonterminal))
+#define GRAMMAR_IS_NT(symbol) ((symbol) >= 0x1000 && (symbol) < 0x2000)
+#define GRAMMAR_EPSILON 0x2000
+#define GRAMMAR_EMPTY 0x2001             // an ε leaf, value "empty"
+#define GRAMMAR_EMPTY_INCREMENT 0x2002   // the EmptyIncrement leaf of a for loop
+#define GRAMMAR_STARTS_WITH(kind) (0x3000 + (kind))
+#define GRAMMAR_IS_STARTS_WITH(symbol) ((symbol) >= 0x3000)
+#define GRAMMAR_IS_ACTION(symbol) ((symbol) >= 0x2000)
+#define GRAMMAR_END (-1)                 // ends every right-hand side
+
+// Productions: id, left-hand side, the node it builds (NODE_NONE: its children
+// go to the parent's node) and its right-hand side.
+#define NODE_NONE (-1)
+#define NT GRAMMAR_NT
+#define GRAMMAR_PRODUCTIONS(X) \
+    X(P_PROGRAM_MAIN,             G_PROGRAM,               NODE_PROGRAM,               NT(G_MAIN_FUNCTION)) \
+    X(P_PROGRAM_CLASSES,          G_PROGRAM,               NODE_PROGRAM,               NT(G_CLASS_DEFINITION), NT(G_CLASS_DEFINITIONS)) \
+    X(P_CLASSES_MORE,             G_CLASS_DEFINITIONS,     NODE_NONE,                  NT(G_CLASS_DEFINITION), NT(G_CLASS_DEFINITIONS)) \
+    X(P_CLASSES_END,              G_CLASS_DEFINITIONS,     NODE_NONE,                  GRAMMAR_EPSILON) \
+    X(P_MAIN_FUNCTION,            G_MAIN_FUNCTION,         NODE_MAIN_FUNCTION,         NT(G_RETURN_TYPE), T_R_UGAT, T_D_LPAREN, NT(G_PARAMETER_LIST), T_D_RPAREN, NT(G_FUNCTION_BODY)) \
+    X(P_RETURN_BILANG,            G_RETURN_TYPE,           NODE_RETURN_TYPE,           GRAMMAR_QUIET(T_R_BILANG)) \
+    X(P_RETURN_VOID,              G_RETURN_TYPE,           NODE_RETURN_TYPE,           GRAMMAR_QUIET(T_R_VOID)) \
+    X(P_RETURN_WALA,              G_RETURN_TYPE,           NODE_RETURN_TYPE,           GRAMMAR_QUIET(T_R_WALA)) \
+    X(P_PARAMETERS,               G_PARAMETER_LIST,        NODE_PARAMETER_LIST,        T_R_KWERDAS, T_D_LBRACKET, T_D_RBRACKET, T_L_IDENTIFIER) \
+    X(P_PARAMETERS_EMPTY,         G_PARAMETER_LIST,        NODE_PARAMETER_LIST,        GRAMMAR_EMPTY) \
+    X(P_FUNCTION_BODY,            G_FUNCTION_BODY,         NODE_FUNCTION_BODY,         T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE) \
+    X(P_STATEMENTS_MORE,          G_STATEMENT_LIST,        NODE_STATEMENT_LIST,        NT(G_STATEMENT), NT(G_STATEMENT_LIST)) \
+    X(P_STATEMENTS_END,           G_STATEMENT_LIST,        NODE_STATEMENT_LIST,        GRAMMAR_EMPTY) \
+    X(P_STATEMENT_DECLARATION,    G_STATEMENT,             NODE_STATEMENT,             NT(G_DECLARATION)) \
+    X(P_STATEMENT_ASSIGNMENT,     G_STATEMENT,             NODE_STATEMENT,             GRAMMAR_STARTS_WITH(T_L_IDENTIFIER), NT(G_ASSIGNMENT)) \
+    X(P_STATEMENT_CONDITIONAL,    G_STATEMENT,             NODE_STATEMENT,             NT(G_CONDITIONAL)) \
+    X(P_STATEMENT_ITERATIVE,      G_STATEMENT,             NODE_STATEMENT,             NT(G_ITERATIVE)) \
+    X(P_STATEMENT_PRINT,          G_STATEMENT,             NODE_STATEMENT,             NT(G_PRINT)) \
+    X(P_STATEMENT_SCAN,           G_STATEMENT,             NODE_STATEMENT,             NT(G_SCAN)) \
+    X(P_DECLARATION,              G_DECLARATION,           NODE_DECLARATION,           NT(G_DATA_TYPE), NT(G_IDENTIFIER_LIST), T_D_SEMICOLON) \
+    X(P_TYPE_BILANG,              G_DATA_TYPE,             NODE_DATA_TYPE,             GRAMMAR_QUIET(T_R_BILANG)) \
+    X(P_TYPE_LUTANG,              G_DATA_TYPE,             NODE_DATA_TYPE,             GRAMMAR_QUIET(T_R_LUTANG)) \
+    X(P_TYPE_BULYAN,              G_DATA_TYPE,             NODE_DATA_TYPE,             GRAMMAR_QUIET(T_R_BULYAN)) \
+    X(P_TYPE_KWERDAS,             G_DATA_TYPE,             NODE_DATA_TYPE,             GRAMMAR_QUIET(T_R_KWERDAS)) \
+    X(P_IDENTIFIER_LIST,          G_IDENTIFIER_LIST,       NODE_IDENTIFIER_LIST,       T_L_IDENTIFIER, NT(G_IDENTIFIER_TAIL)) \
+    X(P_IDENTIFIER_TAIL_MORE,     G_IDENTIFIER_TAIL,       NODE_IDENTIFIER_TAIL,       T_D_COMMA, T_L_IDENTIFIER, NT(G_IDENTIFIER_INIT), NT(G_IDENTIFIER_TAIL)) \
+    X(P_IDENTIFIER_TAIL_END,      G_IDENTIFIER_TAIL,       NODE_IDENTIFIER_TAIL,       GRAMMAR_EMPTY) \
+    X(P_IDENTIFIER_INIT,          G_IDENTIFIER_INIT,       NODE_NONE,                  T_O_ASSIGN, NT(G_EXPRESSION)) \
+    X(P_IDENTIFIER_INIT_NONE,     G_IDENTIFIER_INIT,       NODE_NONE,                  GRAMMAR_EPSILON) \
+    X(P_ASSIGNMENT,               G_ASSIGNMENT,            NODE_ASSIGNMENT,            NT(G_ASSIGNMENT_EXPRESSION), T_D_SEMICOLON) \
+    X(P_ASSIGNMENT_CHAIN,         G_ASSIGNMENT_EXPRESSION, NODE_ASSIGNMENT_EXPRESSION, T_L_IDENTIFIER, T_O_ASSIGN, NT(G_ASSIGNMENT_EXPRESSION)) \
+    X(P_ASSIGNMENT_VALUE,         G_ASSIGNMENT_EXPRESSION, NODE_NONE,                  NT(G_EXPRESSION)) \
+    X(P_EXPRESSION,               G_EXPRESSION,            NODE_EXPRESSION,            NT(G_TERM), NT(G_EXPRESSION_TAIL)) \
+    X(P_EXPRESSION_PLUS,          G_EXPRESSION_TAIL,       NODE_EXPRESSION_TAIL,       GRAMMAR_QUIET(T_O_PLUS), NT(G_TERM), NT(G_EXPRESSION_TAIL)) \
+    X(P_EXPRESSION_MINUS,         G_EXPRESSION_TAIL,       NODE_EXPRESSION_TAIL,       GRAMMAR_QUIET(T_O_MINUS), NT(G_TERM), NT(G_EXPRESSION_TAIL)) \
+    X(P_EXPRESSION_END,           G_EXPRESSION_TAIL,       NODE_EXPRESSION_TAIL,       GRAMMAR_EMPTY) \
+    X(P_TERM,                     G_TERM,                  NODE_TERM,                  NT(G_FACTOR), NT(G_TERM_TAIL)) \
+    X(P_TERM_MULTIPLY,            G_TERM_TAIL,             NODE_TERM_TAIL,             GRAMMAR_QUIET(T_O_MULTIPLY), NT(G_FACTOR), NT(G_TERM_TAIL)) \
+    X(P_TERM_DIVIDE,              G_TERM_TAIL,             NODE_TERM_TAIL,             GRAMMAR_QUIET(T_O_DIVIDE), NT(G_FACTOR), NT(G_TERM_TAIL)) \
+    X(P_TERM_END,                 G_TERM_TAIL,             NODE_TERM_TAIL,             GRAMMAR_EMPTY) \
+    X(P_FACTOR_IDENTIFIER,        G_FACTOR,                NODE_FACTOR,                T_L_IDENTIFIER) \
+    X(P_FACTOR_BILANG,            G_FACTOR,                NODE_FACTOR,                T_L_BILANG_LITERAL) \
+    X(P_FACTOR_LUTANG,            G_FACTOR,                NODE_FACTOR,                T_L_LUTANG_LITERAL) \
+    X(P_FACTOR_KWERDAS,           G_FACTOR,                NODE_FACTOR,                T_L_KWERDAS_LITERAL) \
+    X(P_FACTOR_TAMA,              G_FACTOR,                NODE_FACTOR,                GRAMMAR_QUIET(T_R_TAMA)) \
+    X(P_FACTOR_MALI,              G_FACTOR,                NODE_FACTOR,                GRAMMAR_QUIET(T_R_MALI)) \
+    X(P_FACTOR_PI,                G_FACTOR,                NODE_FACTOR,                GRAMMAR_QUIET(T_R_PI)) \
+    X(P_FACTOR_E_NUM,             G_FACTOR,                NODE_FACTOR,                GRAMMAR_QUIET(T_R_E_NUM)) \
+    X(P_FACTOR_KISS,              G_FACTOR,                NODE_FACTOR,                GRAMMAR_QUIET(T_R_Kiss)) \
+    X(P_FACTOR_SAMPLE,            G_FACTOR,                NODE_FACTOR,                GRAMMAR_QUIET(T_R_SAMPLE_CONST_STRING)) \
+    X(P_FACTOR_PARENTHESES,       G_FACTOR,                NODE_FACTOR,                T_D_LPAREN, NT(G_EXPRESSION), T_D_RPAREN) \
+    X(P_CONDITIONAL,              G_CONDITIONAL,           NODE_CONDITIONAL,           T_K_KUNG, T_D_LPAREN, NT(G_BOOLEAN_EXPRESSION), T_D_RPAREN, T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE, NT(G_CONDITIONAL_TAIL)) \
+    X(P_CONDITIONAL_ELSE,         G_CONDITIONAL_TAIL,      NODE_CONDITIONAL_TAIL,      T_K_KUNDI, T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE) \
+    X(P_CONDITIONAL_ELSE_IF,      G_CONDITIONAL_TAIL,      NODE_CONDITIONAL_TAIL,      T_K_KUNDIMAN, T_D_LPAREN, NT(G_BOOLEAN_EXPRESSION), T_D_RPAREN, T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE, NT(G_CONDITIONAL_TAIL)) \
+    X(P_CONDITIONAL_END,          G_CONDITIONAL_TAIL,      NODE_CONDITIONAL_TAIL,      GRAMMAR_EMPTY) \
+    X(P_BOOLEAN_EXPRESSION,       G_BOOLEAN_EXPRESSION,    NODE_BOOLEAN_EXPRESSION,    NT(G_EXPRESSION), NT(G_RELOP), NT(G_EXPRESSION)) \
+    X(P_RELOP_EQUAL,              G_RELOP,                 NODE_RELOP,                 GRAMMAR_QUIET(T_O_EQUAL)) \
+    X(P_RELOP_NOT_EQUAL,          G_RELOP,                 NODE_RELOP,                 GRAMMAR_QUIET(T_O_NOT_EQUAL)) \
+    X(P_RELOP_GREATER,            G_RELOP,                 NODE_RELOP,                 GRAMMAR_QUIET(T_O_GREATER)) \
+    X(P_RELOP_LESS,               G_RELOP,                 NODE_RELOP,                 GRAMMAR_QUIET(T_O_LESS)) \
+    X(P_RELOP_GREATER_EQ,         G_RELOP,                 NODE_RELOP,                 GRAMMAR_QUIET(T_O_GREATER_EQ)) \
+    X(P_RELOP_LESS_EQ,            G_RELOP,                 NODE_RELOP,                 GRAMMAR_QUIET(T_O_LESS_EQ)) \
+    X(P_ITERATIVE_FOR,            G_ITERATIVE,             NODE_ITERATIVE,             NT(G_FOR_LOOP)) \
+    X(P_ITERATIVE_WHILE,          G_ITERATIVE,             NODE_ITERATIVE,             NT(G_WHILE_LOOP)) \
+    X(P_ITERATIVE_DO_WHILE,       G_ITERATIVE,             NODE_ITERATIVE,             NT(G_DO_WHILE_LOOP)) \
+    X(P_FOR_LOOP,                 G_FOR_LOOP,              NODE_FOR_LOOP,              T_K_PARA, T_D_LPAREN, NT(G_FOR_INIT), NT(G_FOR_CONDITION), T_D_SEMICOLON, NT(G_FOR_INCREMENT), T_D_RPAREN, T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE) \
+    X(P_FOR_INIT_DECLARATION,     G_FOR_INIT,              NODE_NONE,                  NT(G_DECLARATION)) \
+    X(P_FOR_INIT_ASSIGNMENT,      G_FOR_INIT,              NODE_ASSIGNMENT,            T_L_IDENTIFIER, T_O_ASSIGN, NT(G_EXPRESSION), T_D_SEMICOLON) \
+    X(P_FOR_CONDITION,            G_FOR_CONDITION,         NODE_BOOLEAN_EXPRESSION,    GRAMMAR_STARTS_WITH(T_L_IDENTIFIER), NT(G_EXPRESSION), NT(G_RELOP), NT(G_EXPRESSION)) \
+    X(P_FOR_INCREMENT,            G_FOR_INCREMENT,         NODE_ASSIGNMENT,            T_L_IDENTIFIER, T_O_ASSIGN, NT(G_EXPRESSION)) \
+    X(P_FOR_INCREMENT_EMPTY,      G_FOR_INCREMENT,         NODE_NONE,                  GRAMMAR_EMPTY_INCREMENT) \
+    X(P_WHILE_LOOP,               G_WHILE_LOOP,            NODE_WHILE_LOOP,            T_K_HABANG, T_D_LPAREN, NT(G_BOOLEAN_EXPRESSION), T_D_RPAREN, T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE) \
+    X(P_DO_WHILE_LOOP,            G_DO_WHILE_LOOP,         NODE_DO_WHILE_LOOP,         T_K_GAWIN, T_D_LBRACE, NT(G_STATEMENT_LIST), T_D_RBRACE, T_K_HABANG, T_D_LPAREN, NT(G_BOOLEAN_EXPRESSION), T_D_RPAREN, T_D_SEMICOLON) \
+    X(P_PRINT,                    G_PRINT,                 NODE_PRINT,                 T_K_ANI, T_D_LPAREN, NT(G_PRINT_ARGS), T_D_RPAREN, T_D_SEMICOLON) \
+    X(P_PRINT_ARGS,               G_PRINT_ARGS,            NODE_PRINT_ARGS,            NT(G_EXPRESSION), NT(G_PRINT_ARGS_TAIL)) \
+    X(P_PRINT_ARGS_MORE,          G_PRINT_ARGS_TAIL,       NODE_NONE,                  T_D_COMMA, NT(G_PRINT_ARGS)) \
+    X(P_PRINT_ARGS_END,           G_PRINT_ARGS_TAIL,       NODE_NONE,                  GRAMMAR_EPSILON) \
+    X(P_SCAN,                     G_SCAN,                  NODE_SCAN,                  T_K_TANIM, T_D_LPAREN, NT(G_SCAN_ARGS), T_D_RPAREN, T_D_SEMICOLON) \
+    X(P_SCAN_ARGS,                G_SCAN_ARGS,             NODE_SCAN_ARGS,             T_L_IDENTIFIER, NT(G_SCAN_ARGS_TAIL)) \
+    X(P_SCAN_ARGS_MORE,           G_SCAN_ARGS_TAIL,        NODE_NONE,                  T_D_COMMA, NT(G_SCAN_ARGS)) \
+    X(P_SCAN_ARGS_END,            G_SCAN_ARGS_TAIL,        NODE_NONE,                  GRAMMAR_EPSILON) \
+    X(P_CLASS_DEFINITION,         G_CLASS_DEFINITION,      NODE_CLASS_DEFINITION,      T_K_PANGKAT, T_L_IDENTIFIER, T_D_LBRACE, T_D_RBRACE)
+
+typedef enum {
+#define GRAMMAR_PRODUCTION_ENUM(id, lhs, node, ...) id,
+    GRAMMAR_PRODUCTIONS(GRAMMAR_PRODUCTION_ENUM)
+#undef GRAMMAR_PRODUCTION_ENUM
+    P_COUNT,
+    P_NONE = -1
+} GrammarProduction;
+
+typedef struct {
+    GrammarNonterminal lhs;
+    int node;              // NodeKind, or NODE_NONE
+    const int* rhs;        // ends with GRAMMAR_END
+} ProductionInfo;
+
+// Token sets are bitsets over the lookahead symbols: every token kind up to
+// T_R_VOID, end of input, and one symbol for any other kind (names interned
+// from hand-edited tables), which no set contains.
+#define TOKEN_SET_EOF (T_R_VOID + 1)
+#define TOKEN_SET_OTHER (T_R_VOID + 2)
+#define TOKEN_SET_SYMBOLS (T_R_VOID + 3)
+#define TOKEN_SET_WORDS ((TOKEN_SET_SYMBOLS + 63) / 64)
+
+typedef struct {
+    uint64_t bits[TOKEN_SET_WORDS];
+} TokenSet;
+
+static inline bool token_set_has(const TokenSet* set, int symbol) {
+    return (set->bits[symbol >> 6] >> (symbol & 63)) & 1;
+}
+
+static inline void token_set_add(TokenSet* set, int symbol) {
+    set->bits[symbol >> 6] |= (uint64_t)1 << (symbol & 63);
+}
+
+static inline void token_set_remove(TokenSet* set, int symbol) {
+    set->bits[symbol >> 6] &= ~((uint64_t)1 << (symbol & 63));
+}
+
+// The lookahead symbol of a token, TOKEN_SET_EOF for none
+static inline int lookahead_symbol(const ParserToken* token) {
+    if (!token) return TOKEN_SET_EOF;
+    return (token->kind >= 0 && token->kind <= T_R_VOID) ? token->kind : TOKEN_SET_OTHER;
+}
+
+// Operator precedence for the expressions parsed by precedence climbing
+// (compact trees and the AST), which go beyond the grammar's + - * / levels.
+// A higher power binds tighter.
+#define POWER_ADDITIVE 5
+#define POWER_MULTIPLICATIVE 6
+#define POWER_UNARY 7    // prefix ! and -
+#define POWER_POW 8      // ^, the only right-associative operator
+
+// Binding power of a binary operator, 0 if kind is not one
+static inline int binary_power(TokenKind kind) {
+    switch (kind) {
+    case T_O_OR:
+        return 1;
+    case T_O_AND:
+        return 2;
+    case T_O_EQUAL:
+    case T_O_NOT_EQUAL:
+        return 3;
+    case T_O_LESS:
+    case T_O_GREATER:
+    case T_O_LESS_EQ:
+    case T_O_GREATER_EQ:
+        return 4;
+    case T_O_PLUS:
+    case T_O_MINUS:
+        return POWER_ADDITIVE;
+    case T_O_MULTIPLY:
+    case T_O_DIVIDE:
+    case T_O_MODULO:
+        return POWER_MULTIPLICATIVE;
+    case T_O_POW:
+        return POWER_POW;
+    default:
+        return 0;
+    }
+}
+
+const ProductionInfo* grammar_production(GrammarProduction production);
+const char* grammar_nonterminal_name(GrammarNonterminal nonterminal);
+bool grammar_nonterminal_traced(GrammarNonterminal nonterminal);
+const TokenSet* grammar_first(GrammarNonterminal nonterminal);
+const TokenSet* grammar_follow(GrammarNonterminal nonterminal);
+// Where panic-mode recovery inside nonterminal stops skipping: a token that
+// can follow it, or one at a statement boundary (';', '{', '}', a statement
+// keyword, end of input). Never an identifier.
+const TokenSet* grammar_recovery(GrammarNonterminal nonterminal);
+bool grammar_nullable(GrammarNonterminal nonterminal);
+// The production of a nullable nonterminal that derives ε, P_NONE for others
+GrammarProduction grammar_empty_production(GrammarNonterminal nonterminal);
+
+// The production to expand nonterminal with on lookahead (a lookahead_symbol),
+// P_NONE if there is none. Where two productions share a lookahead (only
+// AssignmentExpression on an identifier) next, the symbol after it, decides.
+GrammarProduction grammar_choice(GrammarNonterminal nonterminal, int lookahead, int next);
+
+#endif
@@ -0,0 +1,881 @@
+#include "incremental.h"
+#include "transitions.h"
+#include "../Lexer/lexer.h"
+
+// Relexing compares against this many old tokens at a time
+#define RESYNC_WINDOW 64
+// Text past a relexing window that is put in one piece for the lexer; it
+// doubles while a token runs into the gap
+#define RELEX_MARGIN 256
+// How far the descent parser reads ahead of its position: the current token
+// and peek_ahead(p, 1)
+#define PARSER_LOOKAHEAD 2
+
+static size_t arena_bytes(const Arena* arena) {
+    size_t bytes = 0;
+    for (const ArenaBlock* block = arena->blocks; block; block = block->next) bytes += block->used;
+    return bytes;
+}
+
+static void set_position(Parser* p, int pos) {
+    p->pos = pos;
+    p->current_token = pos < p->token_count ? read_token(&p->tokens, pos, &p->current) : NULL;
+}
+
+// ============ SOURCE ============
+
+static void move_source_gap(IncrementalParse* ip, size_t to) {
+    size_t gap_length = ip->source_capacity - ip->length;
+    if (to < ip->source_gap) {
+        memmove(ip->source + to + gap_length, ip->source + to, ip->source_gap - to);
+    } else {
+        memmove(ip->source + ip->source_gap, ip->source + ip->source_gap + gap_length, to - ip->source_gap);
+    }
+    ip->source_gap = to;
+}
+
+// Room for length more bytes and the NUL incremental_source puts after them
+static bool reserve_source_gap(IncrementalParse* ip, size_t length) {
+    if (ip->source_capacity - ip->length > length) return true;
+    size_t capacity = ip->length + length + 1 > 2 * ip->source_capacity ? ip->length + length + 1
+                                                                          : 2 * ip->source_capacity;
+    char* source = (char*)realloc(ip->source, capacity);
+    if (!source) return false;
+    size_t tail = ip->length - ip->source_gap;
+    memmove(source + capacity - tail, source + ip->source_capacity - tail, tail);
+    ip->source = source;
+    ip->source_capacity = capacity;
+    return true;
+}
+
+// ============ TOKENS ============
+
+static int token_slot(const TokenStore* tokens, int i) {
+    return i < tokens->gap ? i : i + tokens->gap_length;
+}
+
+static uint32_t token_offset(const IncrementalParse* ip, int i) {
+    const TokenStore* tokens = &ip->parser->tokens;
+    return i < tokens->gap ? ip->offsets[i] : ip->offsets[i + tokens->gap_length] + ip->tail_shift;
+}
+
+static int token_line(const TokenStore* tokens, int i) {
+    return i < tokens->gap ? tokens->lines[i] : tokens->lines[i + tokens->gap_length] + tokens->tail_lines;
+}
+
+// Moves the gap of the token columns and the offsets to before token to
+static void move_token_gap(IncrementalParse* ip, int to) {
+    TokenStore* tokens = &ip->parser->tokens;
+    int gap = tokens->gap, length = tokens->gap_length;
+    if (to < gap) {
+        memmove(tokens->kinds + to + length, tokens->kinds + to, (gap - to) * sizeof(uint16_t));
+        memmove(tokens->lexemes + to + length, tokens->lexemes + to, (gap - to) * sizeof(uint32_t));
+        for (int i = gap - 1; i >= to; i--) {
+            tokens->lines[i + length] = tokens->lines[i] - tokens->tail_lines;
+            ip->offsets[i + length] = ip->offsets[i] - ip->tail_shift;
+        }
+    } else {
+        memmove(tokens->kinds + gap, tokens->kinds + gap + length, (to - gap) * sizeof(uint16_t));
+        memmove(tokens->lexemes + gap, tokens->lexemes + gap + length, (to - gap) * sizeof(uint32_t));
+        for (int i = gap; i < to; i++) {
+            tokens->lines[i] = tokens->lines[i + length] + tokens->tail_lines;
+            ip->offsets[i] = ip->offsets[i + length] + ip->tail_shift;
+        }
+    }
+    tokens->gap = to;
+}
+
+// Room for length tokens in the gap; the tokens after it go to the end
+static bool reserve_token_gap(IncrementalParse* ip, int length) {
+    TokenStore* tokens = &ip->parser->tokens;
+    if (tokens->gap_length >= length) return true;
+    int old_capacity = tokens->capacity;
+    if (length > INT32_MAX / 2 - old_capacity) return false;
+    int capacity = tokens->count + length > 2 * old_capacity ? tokens->count + length : 2 * old_capacity;
+    if (!reserve_token_store(tokens, capacity, 0)) return false;
+    uint32_t* offsets = (uint32_t*)realloc(ip->offsets, capacity * sizeof(uint32_t));
+    if (!offsets) return false;
+    ip->offsets = offsets;
+
+    int tail = old_capacity - tokens->gap - tokens->gap_length;
+    int from = old_capacity - tail, to = capacity - tail;
+    memmove(tokens->kinds + to, tokens->kinds + from, tail * sizeof(uint16_t));
+    memmove(tokens->lines + to, tokens->lines + from, tail * sizeof(int));
+    memmove(tokens->lexemes + to, tokens->lexemes + from, tail * sizeof(uint32_t));
+    memmove(ip->offsets + to, ip->offsets + from, tail * sizeof(uint32_t));
+    tokens->gap_length += capacity - old_capacity;
+    return true;
+}
+
+// Appends a lexeme to the store's text. The text never moves while a tree
+// points into it: a full buffer is copied into a larger one and kept until
+// the next fresh parse.
+static bool append_lexeme(IncrementalParse* ip, const char* lexeme, size_t length, uint32_t* offset) {
+    TokenStore* tokens = &ip->parser->tokens;
+    if (tokens->text_length + length + 1 > tokens->text_capacity) {
+        size_t capacity = 2 * tokens->text_capacity + length + 1;
+        if (capacity > UINT32_MAX) return false;    // lexeme offsets are 32-bit
+        char** retired = (char**)realloc(ip->retired_text, (ip->retired_count + 1) * sizeof(char*));
+        if (!retired) return false;
+        ip->retired_text = retired;
+        char* text = (char*)malloc(capacity);
+        if (!text) return false;
+        memcpy(text, tokens->text, tokens->text_length);
+        ip->retired_text[ip->retired_count++] = tokens->text;
+        tokens->text = text;
+        tokens->text_capacity = capacity;
+    }
+    *offset = (uint32_t)tokens->text_length;
+    memcpy(tokens->text + tokens->text_length, lexeme, length);
+    tokens->text[tokens->text_length + length] = '\0';
+    tokens->text_length += length + 1;
+    return true;
+}
+
+// Whether a relexed token is old token i, moved by shift bytes and line_delta lines
+static bool same_token(const IncrementalParse* ip, const Token* t, int i, long shift, int line_delta) {
+    const TokenStore* tokens = &ip->parser->tokens;
+    int slot = token_slot(tokens, i);
+    if ((long)t->offset != (long)token_offset(ip, i) + shift) return false;
+    if (TOKEN_KIND(t->category, t->tokenValue) != tokens->kinds[slot]) return false;
+    if (t->lineNumber != token_line(tokens, i) + line_delta) return false;
+    const char* old = tokens->text + tokens->lexemes[slot];
+    return strncmp(old, ip->source + t->offset, t->length) == 0 && old[t->length] == '\0';
+}
+
+// First token at or after offset
+static int token_at(const IncrementalParse* ip, size_t offset) {
+    int low = 0, high = ip->parser->tokens.count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (token_offset(ip, mid) < offset) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// ============ LIST INDEX ============
+
+static int list_count(const IncrementalParse* ip) {
+    return ip->list_front + ip->list_capacity - ip->list_tail;
+}
+
+static int list_slot(const IncrementalParse* ip, int i) {
+    return i < ip->list_front ? i : i + ip->list_tail - ip->list_front;
+}
+
+static int list_index(const IncrementalParse* ip, int slot) {
+    return slot < ip->list_tail ? slot : slot - ip->list_tail + ip->list_front;
+}
+
+// A chain's head or last as a slot
+static int chain_slot(const IncrementalParse* ip, int reference) {
+    return reference >= 0 ? reference : ip->list_capacity + reference;
+}
+
+static int list_start(const IncrementalParse* ip, const StatementListEntry* list) {
+    return list->start >= 0 ? list->start : list->start + ip->parser->token_count + 1;
+}
+
+static int list_first_diagnostic(const IncrementalParse* ip, const StatementListEntry* list) {
+    return list->first_diagnostic >= 0 ? list->first_diagnostic : list->first_diagnostic + ip->diagnostic_total + 1;
+}
+
+// The empty list at the end of the block of the list in slot
+static const StatementListEntry* block_end(const IncrementalParse* ip, int slot) {
+    return &ip->lists[chain_slot(ip, ip->chains[ip->lists[slot].chain].last)];
+}
+
+// Moves the gap of the index to before list front. Entries that cross it
+// switch between counting from the start and from the end, and so do the
+// references of their chain to them.
+static void move_list_gap(IncrementalParse* ip, int front) {
+    int token_end = ip->parser->token_count + 1, diagnostic_end = ip->diagnostic_total + 1;
+    while (ip->list_front > front) {
+        int from = --ip->list_front, to = --ip->list_tail;
+        StatementListEntry* list = &ip->lists[to];
+        *list = ip->lists[from];
+        list->start -= token_end;
+        list->first_diagnostic -= diagnostic_end;
+        ListChain* chain = &ip->chains[list->chain];
+        if (chain->head == from) chain->head = to - ip->list_capacity;
+        if (chain->last == from) chain->last = to - ip->list_capacity;
+    }
+    while (ip->list_front < front) {
+        int from = ip->list_tail++, to = ip->list_front++;
+        StatementListEntry* list = &ip->lists[to];
+        *list = ip->lists[from];
+        list->start += token_end;
+        list->first_diagnostic += diagnostic_end;
+        ListChain* chain = &ip->chains[list->chain];
+        if (chain->head == from - ip->list_capacity) chain->head = to;
+        if (chain->last == from - ip->list_capacity) chain->last = to;
+    }
+}
+
+// Room to record count more lists. The entries after the gap go to the end
+// of the larger array, which leaves their distances from it as they were.
+static bool reserve_list_slots(IncrementalParse* ip, int count) {
+    while (ip->list_tail - ip->write < count) {
+        if (ip->list_capacity > INT32_MAX / 4) return false;
+        int capacity = ip->list_capacity ? 2 * ip->list_capacity : 1024;
+        StatementListEntry* lists = (StatementListEntry*)realloc(ip->lists, capacity * sizeof(StatementListEntry));
+        if (!lists) return false;
+        int grown = capacity - ip->list_capacity;
+        memmove(lists + ip->list_tail + grown, lists + ip->list_tail,
+                (ip->list_capacity - ip->list_tail) * sizeof(StatementListEntry));
+        ip->lists = lists;
+        ip->list_capacity = capacity;
+        ip->list_tail += grown;
+        ip->reuse_next += grown;
+        ip->reuse_end += grown;
+        if (ip->pending >= 0) {
+            ip->pending += grown;
+            ip->pending_last += grown;
+        }
+    }
+    return true;
+}
+
+static int new_chain(IncrementalParse* ip) {
+    if (ip->chain_count == ip->chain_capacity) {
+        int capacity = ip->chain_capacity ? 2 * ip->chain_capacity : 256;
+        ListChain* chains = (ListChain*)realloc(ip->chains, capacity * sizeof(ListChain));
+        if (!chains) return -1;
+        ip->chains = chains;
+        ip->chain_capacity = capacity;
+    }
+    return ip->chain_count++;
+}
+
+// Notes down a chain of the previous index before a reparse changes it
+static bool save_chain(IncrementalParse* ip, int chain) {
+    if (chain >= ip->chain_base) return true;
+    if (ip->changed_count == ip->changed_capacity) {
+        int capacity = ip->changed_capacity ? 2 * ip->changed_capacity : 64;
+        ChangedChain* changed = (ChangedChain*)realloc(ip->changed, capacity * sizeof(ChangedChain));
+        if (!changed) return false;
+        ip->changed = changed;
+        ip->changed_capacity = capacity;
+    }
+    ip->changed[ip->changed_count].chain = chain;
+    ip->changed[ip->changed_count++].saved = ip->chains[chain];
+    return true;
+}
+
+// Records the list taken over last, and its subtree's lists, where the
+// reparse has got to
+static bool place_pending(IncrementalParse* ip) {
+    int count = ip->pending_last - ip->pending + 1;
+    if (!reserve_list_slots(ip, count)) return false;
+    int first = ip->pending;
+    ip->pending = -1;
+    for (int i = 0; i < count; i++) {
+        int from = first + i, to = ip->write++;
+        StatementListEntry* list = &ip->lists[to];
+        *list = ip->lists[from];
+        list->start = list_start(ip, list);
+        list->first_diagnostic = list_first_diagnostic(ip, list) + ip->pending_diagnostics;
+        ListChain* chain = &ip->chains[list->chain];
+        bool head = chain_slot(ip, chain->head) == from, last = chain_slot(ip, chain->last) == from;
+        if ((head || last) && !save_chain(ip, list->chain)) return false;
+        if (head) chain->head = to;
+        if (last) chain->last = to;
+    }
+    return true;
+}
+
+// Notes down a node taken over from the previous tree and what followed it there
+static bool save_reused(IncrementalParse* ip, ParseTreeNode* node) {
+    if (ip->reused_count == ip->reused_capacity) {
+        int capacity = ip->reused_capacity ? 2 * ip->reused_capacity : 64;
+        ReusedList* grown = (ReusedList*)realloc(ip->reused, capacity * sizeof(ReusedList));
+        if (!grown) return false;
+        ip->reused = grown;
+        ip->reused_capacity = capacity;
+    }
+    ip->reused[ip->reused_count].node = node;
+    ip->reused[ip->reused_count++].next_sibling = node->next_sibling;
+    node->next_sibling = NULL;
+    return true;
+}
+
+// ============ PARSER HOOKS ============
+
+ParseTreeNode* reuse_statement_list(Parser* p) {
+    IncrementalParse* ip = p->incremental;
+    if (!ip->reusing) return NULL;
+    // Positions before the changed tokens' end map below changed_end
+    if (p->pos - ip->token_delta < ip->changed_end) return NULL;
+
+    // The parser only moves forward, so candidates it passed are done with
+    while (ip->reuse_next < ip->reuse_end && list_start(ip, &ip->lists[ip->reuse_next]) < p->pos) ip->reuse_next++;
+    if (ip->reuse_next == ip->reuse_end || list_start(ip, &ip->lists[ip->reuse_next]) != p->pos) return NULL;
+
+    if (ip->pending >= 0 && !place_pending(ip)) {
+        ip->out_of_memory = true;
+        return NULL;
+    }
+    int slot = ip->reuse_next;
+    const StatementListEntry* list = &ip->lists[slot];
+    // A list that closed a block had the '}' after it
+    if (!save_reused(ip, list->node)) {
+        ip->out_of_memory = true;
+        return NULL;
+    }
+    int last = chain_slot(ip, ip->chains[list->chain].last);
+    // It heads its block unless it turns out to go on from a list before it
+    if (!save_chain(ip, list->chain)) {
+        ip->out_of_memory = true;
+        return NULL;
+    }
+    ip->chains[list->chain].head = slot - ip->list_capacity;
+
+    // Its diagnostics come along, moved with the tokens and lines after the edit
+    int first_diagnostic = list_first_diagnostic(ip, list);
+    int end_diagnostic = list_first_diagnostic(ip, &ip->lists[last]);
+    ip->pending_diagnostics = p->error_count - first_diagnostic;
+    for (int i = first_diagnostic; i < end_diagnostic; i++) {
+        Diagnostic d = ip->old_diagnostics[i];
+        if (d.token >= 0) d.token += ip->token_delta;
+        if (d.line > 0) d.line += ip->line_delta;
+        if (!add_diagnostic(p, &d)) ip->out_of_memory = true;
+    }
+    // Its entries stay where they are until something is recorded after them
+    ip->pending = slot;
+    ip->pending_last = last;
+    ip->reuse_next = last + 1;
+    ip->ended_chain = list->chain;
+    int end = list_start(ip, &ip->lists[last]);
+    ip->stats.reused++;
+    ip->stats.reparsed -= end - p->pos;
+    set_position(p, end);
+    return list->node;
+}
+
+// Records a list parse_statement_list entered; its slot, -1 when out of memory
+static int record_statement_list(Parser* p, ParseTreeNode* node) {
+    IncrementalParse* ip = p->incremental;
+    if ((ip->pending >= 0 && !place_pending(ip)) || !reserve_list_slots(ip, 1)) {
+        ip->out_of_memory = true;
+        return -1;
+    }
+    if (ip->reusing && ip->write < ip->list_front) {
+        // A list before the edit, recorded again
+        if (ip->overwritten_count == ip->overwritten_capacity) {
+            int capacity = ip->overwritten_capacity ? 2 * ip->overwritten_capacity : 64;
+            OverwrittenList* grown = (OverwrittenList*)realloc(ip->overwritten, capacity * sizeof(OverwrittenList));
+            if (!grown) {
+                ip->out_of_memory = true;
+                return -1;
+            }
+            ip->overwritten = grown;
+            ip->overwritten_capacity = capacity;
+        }
+        ip->overwritten[ip->overwritten_count].slot = ip->write;
+        ip->overwritten[ip->overwritten_count++].saved = ip->lists[ip->write];
+    }
+    StatementListEntry* list = &ip->lists[ip->write];
+    list->node = node;
+    list->start = p->pos;
+    list->first_diagnostic = p->error_count;
+    list->chain = -1;
+    return ip->write++;
+}
+
+int begin_statement_list(Parser* p, ParseTreeNode* node) {
+    IncrementalParse* ip = p->incremental;
+    int entry = record_statement_list(p, node);
+    if (ip->open_count == ip->open_capacity) {
+        int capacity = ip->open_capacity ? 2 * ip->open_capacity : 256;
+        int* grown = (int*)realloc(ip->open_lists, capacity * sizeof(int));
+        if (!grown) {
+            ip->out_of_memory = true;
+            return -1;
+        }
+        ip->open_lists = grown;
+        ip->open_capacity = capacity;
+    }
+    ip->open_lists[ip->open_count++] = entry;
+    return entry;
+}
+
+static void end_statement_list(Parser* p, int entry) {
+    IncrementalParse* ip = p->incremental;
+    StatementListEntry* list = &ip->lists[entry];
+    int chain;
+    if (list->node->last_child && list->node->last_child->kind == NODE_STATEMENT_LIST) {
+        // It goes on with the rest of the block, which just ended
+        chain = ip->ended_chain;
+        if (!save_chain(ip, chain)) {
+            ip->out_of_memory = true;
+            return;
+        }
+    } else {
+        // The empty list at the block's end starts its chain
+        chain = new_chain(ip);
+        if (chain < 0) {
+            ip->out_of_memory = true;
+            return;
+        }
+        ip->chains[chain].last = entry;
+    }
+    ip->chains[chain].head = entry;
+    list->chain = chain;
+    ip->ended_chain = chain;
+}
+
+void end_statement_lists(Parser* p, int count) {
+    IncrementalParse* ip = p->incremental;
+    // Short only when a list could not be noted down, out of memory
+    for (int i = 0; i < count && ip->open_count > 0; i++) {
+        int entry = ip->open_lists[--ip->open_count];
+        if (entry >= 0) end_statement_list(p, entry);
+    }
+}
+
+ParseTreeNode* reuse_statement(Parser* p, int entry) {
+    IncrementalParse* ip = p->incremental;
+    // The list was one of the previous tree's before the edit: the last one
+    // written over
+    if (!ip->reusing || ip->overwritten_count == 0 || ip->overwritten[ip->overwritten_count - 1].slot != entry) {
+        return NULL;
+    }
+    const StatementListEntry* list = &ip->overwritten[ip->overwritten_count - 1].saved;
+    ParseTreeNode* statement = list->node->first_child;
+    if (list->start != p->pos || list->first_diagnostic != p->error_count || !statement ||
+        statement->kind == NODE_STATEMENT_LIST ||
+        !statement->next_sibling || statement->next_sibling->kind != NODE_STATEMENT_LIST) {
+        return NULL;
+    }
+
+    // The rest of the block starts after the lists nested in the statement,
+    // which stay where they are; the statement is the same if the parser did
+    // not read as far as the edit in it
+    int rest = entry + 1;
+    while (rest < ip->list_front && ip->lists[rest].chain != list->chain) {
+        rest = chain_slot(ip, ip->chains[ip->lists[rest].chain].last) + 1;
+    }
+    if (rest >= ip->list_front || ip->lists[rest].start + PARSER_LOOKAHEAD > ip->changed_start) return NULL;
+    const StatementListEntry* next = &ip->lists[rest];
+    for (int i = list->first_diagnostic; i < next->first_diagnostic; i++) {
+        if (!add_diagnostic(p, &ip->old_diagnostics[i])) ip->out_of_memory = true;
+    }
+    if (!save_reused(ip, statement)) {
+        ip->out_of_memory = true;
+        return NULL;
+    }
+    ip->write = rest;
+    ip->stats.reparsed -= next->start - p->pos;
+    set_position(p, next->start);
+    return statement;
+}
+
+// ============ PARSING ============
+
+static void begin_reparse(IncrementalParse* ip) {
+    ip->reusing = true;
+    ip->pending = -1;
+    ip->chain_base = ip->chain_count;
+    ip->reused_count = 0;
+    ip->changed_count = 0;
+    ip->overwritten_count = 0;
+    ip->open_count = 0;
+    ip->stats.reused = 0;
+}
+
+// Puts the previous tree and index back as they were
+static void abandon_reparse(IncrementalParse* ip) {
+    while (ip->reused_count > 0) {
+        ReusedList* reused = &ip->reused[--ip->reused_count];
+        reused->node->next_sibling = reused->next_sibling;
+    }
+    while (ip->changed_count > 0) {
+        ChangedChain* changed = &ip->changed[--ip->changed_count];
+        ip->chains[changed->chain] = changed->saved;
+    }
+    while (ip->overwritten_count > 0) {
+        OverwrittenList* overwritten = &ip->overwritten[--ip->overwritten_count];
+        ip->lists[overwritten->slot] = overwritten->saved;
+    }
+    ip->chain_count = ip->chain_base;
+    ip->pending = -1;
+    ip->reusing = false;
+}
+
+// The index is the lists recorded before its gap and the rest of the previous
+// one after it. The list taken over last may stay where it was if the rest
+// starts with it and its diagnostics moved as far as the ones after it.
+static void finish_reparse(IncrementalParse* ip) {
+    Parser* p = ip->parser;
+    if (ip->pending >= 0 && (ip->pending_last + 1 != ip->reuse_end ||
+                             ip->pending_diagnostics != p->error_count - ip->old_diagnostic_count)) {
+        if (!place_pending(ip)) ip->out_of_memory = true;
+    }
+    ip->list_front = ip->write;
+    ip->list_tail = ip->pending >= 0 ? ip->pending : ip->reuse_end;
+    ip->diagnostic_total = p->error_count;
+    ip->pending = -1;
+    ip->reusing = false;
+}
+
+// Lexes and parses the whole source into a new parser
+static bool parse_fresh(IncrementalParse* ip) {
+    TokenList list;
+    lexTokens(incremental_source(ip), ip->length, &list);
+    TokenStore tokens;
+    init_token_store(&tokens);
+    // Room for edits to add tokens and lexemes before anything has to move
+    size_t capacity = list.count + list.count / 4 + 1024;
+    bool ok = capacity < (size_t)INT32_MAX / 2 &&
+              reserve_token_store(&tokens, (int)capacity, 2 * (ip->length + list.count) + 4096);
+    uint32_t* offsets = ok ? (uint32_t*)malloc(capacity * sizeof(uint32_t)) : NULL;
+    for (size_t i = 0; offsets && i < list.count; i++) {
+        const Token* t = &list.tokens[i];
+        ok = ok && add_token(&tokens, TOKEN_KIND(t->category, t->tokenValue), ip->source + t->offset,
+                             t->length, t->lineNumber);
+        offsets[i] = (uint32_t)t->offset;
+    }
+    freeTokenList(&list);
+    if (!ok || !offsets) {
+        free(offsets);
+        free_token_store(&tokens);
+        return false;
+    }
+    tokens.gap = tokens.count;
+    tokens.gap_length = tokens.capacity - tokens.count;
+
+    if (ip->parser) free_parser(ip->parser);
+    for (int i = 0; i < ip->retired_count; i++) free(ip->retired_text[i]);
+    ip->retired_count = 0;
+    free(ip->offsets);
+    ip->offsets = offsets;
+    ip->tail_shift = 0;
+    ip->parser = create_parser(&tokens);
+    ip->parser->expression_tree = ip->expression_tree;
+    ip->parser->incremental = ip;
+
+    ip->reusing = false;
+    ip->pending = -1;
+    ip->write = 0;
+    ip->list_front = 0;
+    ip->list_tail = ip->list_capacity;
+    ip->chain_count = 0;
+    ip->chain_base = 0;
+    ip->open_count = 0;
+    parse_program(ip->parser);
+    ip->parse_rest = ip->parser->token_count - ip->parser->pos - PARSER_LOOKAHEAD;
+    ip->list_front = ip->write;
+    ip->diagnostic_total = ip->parser->error_count;
+
+    ip->dead_text = 0;
+    ip->fresh_arena_bytes = arena_bytes(&ip->parser->nodes);
+    ip->stats.fresh = true;
+    ip->stats.reparsed = ip->parser->token_count;
+    return !ip->out_of_memory;
+}
+
+// Reparses list index, one before the index's gap and the edit. False if it
+// now ends somewhere else than it did: the rest of the old tree does not fit it.
+static bool reparse_list(IncrementalParse* ip, int index) {
+    Parser* p = ip->parser;
+    StatementListEntry list = ip->lists[index];
+    ListChain chain = ip->chains[list.chain];
+    int last = chain_slot(ip, chain.last);
+    int end = list_start(ip, &ip->lists[last]);
+    int end_diagnostic = list_first_diagnostic(ip, &ip->lists[last]);
+
+    begin_reparse(ip);
+    ip->write = index;
+    // Lists after the block are candidates too: taking them over makes a
+    // reparse that runs past its end cheap to give up on
+    int last_from_end = last - ip->list_capacity;
+    ip->reuse_next = ip->list_tail;
+    ip->reuse_end = ip->list_capacity;
+    p->error_count = list.first_diagnostic;
+    set_position(p, list.start);
+    ip->stats.reparsed = 0;
+    ParseTreeNode* node = parse_statement_list(p);
+    // The block must go on in its own chain: a list of another block of the
+    // previous tree that ends here too would leave it two, and the old chain
+    // taken over for a block nested in it would leave two blocks one
+    int new_chain = ip->lists[index].chain;
+    bool conflict = new_chain != list.chain &&
+                    (new_chain < ip->chain_base || (ip->pending >= 0 && ip->lists[ip->pending].chain == list.chain));
+    for (int slot = index + 1; !conflict && new_chain != list.chain && slot < ip->write; slot++) {
+        conflict = ip->lists[slot].chain == list.chain;
+    }
+    if (!node || ip->out_of_memory || p->pos != end || conflict) {
+        abandon_reparse(ip);
+        return false;
+    }
+    ip->stats.reparsed += p->pos - list.start;
+
+    // The new list takes the old one's place; what followed it in its block
+    // (its '}') still does
+    ParseTreeNode* old = list.node;
+    ParseTreeNode* next = old->next_sibling;
+    *old = *node;
+    old->next_sibling = next;
+    ip->lists[index].node = old;
+
+    // Diagnostics after the list, moved with the tokens and lines after the
+    // edit: a message's related line is in the statement that reports it
+    for (int i = end_diagnostic; i < ip->old_diagnostic_count; i++) {
+        Diagnostic d = ip->old_diagnostics[i];
+        if (d.token >= 0) d.token += ip->token_delta;
+        if (d.line > 0) d.line += ip->line_delta;
+        if (!add_diagnostic(p, &d)) ip->out_of_memory = true;
+    }
+
+    // The lists of the block before this one are in the old chain, so a new
+    // chain the block ended in joins it
+    if (new_chain != list.chain) {
+        for (int slot = index; slot < ip->write; slot++) {
+            if (ip->lists[slot].chain == new_chain) ip->lists[slot].chain = list.chain;
+        }
+        ip->chains[list.chain].last = ip->chains[new_chain].last;
+    }
+    ip->chains[list.chain].head = chain.head;
+    // It ended where the block did, so it took nothing over after it
+    ip->reuse_end = ip->list_capacity + last_from_end + 1;
+    finish_reparse(ip);
+    return true;
+}
+
+// Reparses the program, taking over the lists after the edit
+static void reparse_program(IncrementalParse* ip) {
+    Parser* p = ip->parser;
+    begin_reparse(ip);
+    ip->write = 0;
+    ip->reuse_next = ip->list_tail;
+    ip->reuse_end = ip->list_capacity;
+    ip->stats.whole_program = true;
+    ip->stats.reparsed = p->token_count;
+    p->error_count = 0;
+    set_position(p, 0);
+    parse_program(p);
+    ip->parse_rest = p->token_count - p->pos - PARSER_LOOKAHEAD;
+    finish_reparse(ip);
+}
+
+// The innermost statement list around old tokens [from, to) that the parser
+// entered before reading any of them; -1 for none
+static int list_around(const IncrementalParse* ip, int from, int to) {
+    int low = 0, high = list_count(ip);
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (list_start(ip, &ip->lists[list_slot(ip, mid)]) + PARSER_LOOKAHEAD <= from) low = mid + 1;
+        else high = mid;
+    }
+    for (int i = low - 1; i >= 0;) {
+        int slot = list_slot(ip, i);
+        if (list_start(ip, block_end(ip, slot)) >= to) return i;
+        // The lists before it in its block end where it does, and the ones
+        // nested in those before that
+        i = list_index(ip, chain_slot(ip, ip->chains[ip->lists[slot].chain].head)) - 1;
+    }
+    return -1;
+}
+
+// The innermost list around list index that ends elsewhere (the lists before
+// it in its block end where it does); -1 for none
+static int list_outside(const IncrementalParse* ip, int index) {
+    int slot = list_slot(ip, index);
+    int end = list_start(ip, block_end(ip, slot));
+    for (int i = list_index(ip, chain_slot(ip, ip->chains[ip->lists[slot].chain].head)) - 1; i >= 0;) {
+        const ListChain* chain = &ip->chains[ip->lists[list_slot(ip, i)].chain];
+        int last = chain_slot(ip, chain->last);
+        if (list_index(ip, last) >= index && list_start(ip, &ip->lists[last]) != end) return i;
+        i = list_index(ip, chain_slot(ip, chain->head)) - 1;
+    }
+    return -1;
+}
+
+// ============ INTERFACE ============
+
+bool incremental_open(IncrementalParse* ip, const char* source, size_t length, ExpressionTree expression_tree) {
+    memset(ip, 0, sizeof(IncrementalParse));
+    if (length > UINT32_MAX) return false;
+    ip->source = (char*)malloc(length + 1);
+    if (!ip->source) return false;
+    memcpy(ip->source, source, length);
+    ip->length = length;
+    ip->source_capacity = length + 1;
+    ip->source_gap = length;
+    ip->expression_tree = expression_tree;
+
+    bool tracing = transition_tracing;
+    transition_tracing = false;
+    bool ok = parse_fresh(ip);
+    transition_tracing = tracing;
+    return ok;
+}
+
+const char* incremental_source(IncrementalParse* ip) {
+    move_source_gap(ip, ip->length);
+    ip->source[ip->length] = '\0';
+    return ip->source;
+}
+
+// Brings tokens, tree and diagnostics up to date with the edited source
+static bool update(IncrementalParse* ip, const SourceEdit* edit) {
+    Parser* p = ip->parser;
+    TokenStore* tokens = &p->tokens;
+    int old_count = tokens->count;
+    size_t length = ip->length - edit->removed + edit->length;
+    size_t after = edit->offset + edit->removed;
+    long shift = (long)edit->length - (long)edit->removed;
+
+    // Relexing starts at the last token before the edit, which may run into it
+    int from = token_at(ip, edit->offset) - 1;
+    int next = token_at(ip, after);
+    size_t cursor = from >= 0 ? token_offset(ip, from) : 0;
+    int line = from >= 0 ? token_line(tokens, from) : 1;
+    if (from < 0) from = 0;
+
+    // The removed bytes join the source's gap, the text fills it
+    move_source_gap(ip, edit->offset);
+    memcpy(ip->source + edit->offset, edit->text, edit->length);
+    ip->source_gap += edit->length;
+    ip->length = length;
+
+    // Relex until a token starts where an old one after the edit does. The
+    // lexer needs the text in one piece, so the gap moves on ahead of it.
+    TokenList relexed = { NULL, 0, 0 };
+    Token window[RESYNC_WINDOW];
+    TokenList speculative = { window, 0, RESYNC_WINDOW };
+    int resync = old_count;
+    size_t margin = RELEX_MARGIN;
+    for (;;) {
+        int n = old_count - next < RESYNC_WINDOW ? old_count - next : RESYNC_WINDOW;
+        for (int i = 0; i < n; i++) window[i].offset = (size_t)((long)token_offset(ip, next + i) + shift);
+        speculative.count = n;
+        size_t limit = n > 0 ? window[n - 1].offset + 1 : length;
+        size_t reach = limit + margin < length ? limit + margin : length;
+        if (ip->source_gap < reach) move_source_gap(ip, reach);
+
+        size_t count = relexed.count, found = SIZE_MAX;
+        int window_line = line;
+        const char* stop = lexTokenRange(ip->source, ip->source + cursor, ip->source + limit, ip->source_gap,
+                                         &line, &relexed, n > 0 ? &speculative : NULL, &found);
+        const Token* last = relexed.count > count ? &relexed.tokens[relexed.count - 1] : NULL;
+        if (ip->source_gap < length && ((size_t)(stop - ip->source) >= ip->source_gap ||
+                                        (last && last->offset + last->length >= ip->source_gap))) {
+            // A token ran into the gap: again, with more text
+            relexed.count = count;
+            line = window_line;
+            margin *= 4;
+            continue;
+        }
+        cursor = (size_t)(stop - ip->source);
+        if (found != SIZE_MAX) {
+            resync = next + (int)found;
+            break;
+        }
+        if (n == 0) break;
+        next += n;
+        margin = RELEX_MARGIN;
+    }
+    int line_delta = resync < old_count ? line - token_line(tokens, resync) : 0;
+
+    // Relexed tokens that came out as they were are left in place
+    int first = 0, last = (int)relexed.count;
+    while (first < last && from < resync && same_token(ip, &relexed.tokens[first], from, 0, 0)) {
+        first++;
+        from++;
+    }
+    while (first < last && from < resync && same_token(ip, &relexed.tokens[last - 1], resync - 1, shift, line_delta)) {
+        last--;
+        resync--;
+    }
+    int inserted = last - first;
+    ip->stats.relexed = inserted;
+    for (int i = from; i < resync; i++) ip->dead_text += strlen(tokens->text + tokens->lexemes[token_slot(tokens, i)]) + 1;
+
+    if (ip->dead_text > tokens->text_length / 2 ||
+        arena_bytes(&p->nodes) > 2 * ip->fresh_arena_bytes + (1 << 20) ||
+        ip->chain_count > 2 * list_count(ip) + 4096) {
+        // More garbage than tree: start over
+        freeTokenList(&relexed);
+        return parse_fresh(ip);
+    }
+
+    // The list to reparse, found and put last before the index's gap while
+    // the entries still count the old tokens. An edit after what the parse
+    // read (the program ended early) leaves the tree as it is; the entries
+    // keep their places before the gap.
+    bool unread = from >= old_count - ip->parse_rest;
+    int index = unread ? -1 : list_around(ip, from, resync);
+    move_list_gap(ip, unread ? list_count(ip) : index + 1);
+
+    // Old tokens [from, resync) make way for the relexed [first, last)
+    move_token_gap(ip, from);
+    tokens->gap_length += resync - from;
+    tokens->count -= resync - from;
+    bool ok = reserve_token_gap(ip, inserted);
+    for (int i = 0; ok && i < inserted; i++) {
+        const Token* t = &relexed.tokens[first + i];
+        tokens->kinds[from + i] = (uint16_t)TOKEN_KIND(t->category, t->tokenValue);
+        tokens->lines[from + i] = t->lineNumber;
+        ip->offsets[from + i] = (uint32_t)t->offset;
+        ok = append_lexeme(ip, ip->source + t->offset, t->length, &tokens->lexemes[from + i]);
+    }
+    freeTokenList(&relexed);
+    if (!ok) return false;
+    tokens->gap += inserted;
+    tokens->gap_length -= inserted;
+    tokens->count += inserted;
+    tokens->tail_lines += line_delta;
+    ip->tail_shift += (uint32_t)shift;
+    p->token_count = tokens->count;
+    ip->changed_start = from;
+    ip->changed_end = resync;
+    ip->token_delta = inserted - (resync - from);
+    ip->line_delta = line_delta;
+    if (unread) {
+        ip->parse_rest += ip->token_delta;
+        return true;
+    }
+
+    // The reparse writes over the diagnostics from the list on
+    if (p->error_count > ip->old_diagnostic_capacity) {
+        Diagnostic* grown = (Diagnostic*)realloc(ip->old_diagnostics, p->error_count * sizeof(Diagnostic));
+        if (!grown) return false;
+        ip->old_diagnostics = grown;
+        ip->old_diagnostic_capacity = p->error_count;
+    }
+    if (p->error_count > 0) memcpy(ip->old_diagnostics, p->diagnostics, p->error_count * sizeof(Diagnostic));
+    ip->old_diagnostic_count = p->error_count;
+
+    while (index >= 0 && !ip->out_of_memory && !reparse_list(ip, index)) index = list_outside(ip, index);
+    if (index < 0 && !ip->out_of_memory) reparse_program(ip);
+    return !ip->out_of_memory;
+}
+
+bool incremental_edit(IncrementalParse* ip, const SourceEdit* edit) {
+    if (edit->offset > ip->length || edit->removed > ip->length - edit->offset) return false;
+    if (ip->length - edit->removed + edit->length > UINT32_MAX || !reserve_source_gap(ip, edit->length)) return false;
+    memset(&ip->stats, 0, sizeof(ip->stats));
+    bool tracing = transition_tracing;
+    transition_tracing = false;
+    bool ok = update(ip, edit);
+    transition_tracing = tracing;
+    return ok;
+}
+
+void incremental_close(IncrementalParse* ip) {
+    if (ip->parser) free_parser(ip->parser);
+    for (int i = 0; i < ip->retired_count; i++) free(ip->retired_text[i]);
+    free(ip->retired_text);
+    free(ip->offsets);
+    free(ip->lists);
+    free(ip->chains);
+    free(ip->reused);
+    free(ip->changed);
+    free(ip->overwritten);
+    free(ip->open_lists);
+    free(ip->old_diagnostics);
+    free(ip->source);
+    memset(ip, 0, sizeof(IncrementalParse));
+}
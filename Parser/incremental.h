@@ -0,0 +1,183 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "parser.h"
+#include "diagnostics.h"
+
+// Incremental reparsing, for an editor that wants the tree after every
+// keystroke. An IncrementalParse owns a copy of the source and a parser over it
+// (the descent engine) and brings tokens, tree and diagnostics up to date
+// after each edit. The result is what a fresh parse of the edited source
+// would build.
+//
+// Relexing starts at the token before the edit. It stops where the lexer
+// starts a token at the same place as an old one, since the rest would lex
+// the same.
+//
+// Reparsing relies on a StatementList being the rest of a block from one
+// statement on. Its subtree and its diagnostics depend only on the tokens from
+// its first one on, as the parser never looks back. So the reparse starts at
+// the innermost list around the changed tokens, and any list it reaches at an
+// unchanged token is taken over from the previous tree whole. If the reparsed
+// list ends anywhere but where the old one did (the edit moved a '}'), the
+// list of the block around it is reparsed instead, and so on out to the whole
+// program, still taking lists over; the statements such a reparse meets
+// before the edit are taken over one by one.
+//
+// An edit costs what it relexes and reparses, not the size of the file: the
+// source, the token columns and the index of statement lists are gap buffers
+// with the gap where the last edit was, and positions past a gap are kept
+// relative to the end, so nothing after an edit is moved or renumbered. The
+// gaps move with the edits, at the cost of the distance between them. The
+// diagnostics are the exception: they are copied once per edit.
+//
+// The transition log (transitions.h) is not kept up: tracing is off while an
+// IncrementalParse parses. Reused nodes stay in the parser's arena with the
+// garbage of earlier edits. Once the garbage outweighs the live tree, the next
+// edit reparses from scratch, which keeps memory bounded.
+
+// length bytes of text replace removed bytes at offset in the current source
+typedef struct {
+    size_t offset;
+    size_t removed;
+    const char* text;
+    size_t length;
+} SourceEdit;
+
+// One StatementList node of the tree. The index keeps them in preorder, which
+// is the order of their first tokens. Entries after the index's gap hold start
+// and first_diagnostic as negative distances from the end: -1 for the last
+// token or diagnostic, -2 for the one before, and so on.
+typedef struct {
+    ParseTreeNode* node;
+    int start;                  // p->pos when the list was entered
+    int first_diagnostic;       // p->error_count when it was entered
+    int chain;                  // its block's ListChain
+} StatementListEntry;
+
+// The lists of one block: each is the rest of the one before, and the last is
+// the empty list at the block's end, so all of them end where it starts and
+// with the diagnostics it starts with. head and last are slots of the index,
+// after its gap as negative distances from the end of the array.
+typedef struct {
+    int head;
+    int last;
+} ListChain;
+
+// A list taken over from the previous tree and the node that followed it
+// there, put back if the reparse that took it is abandoned
+typedef struct {
+    ParseTreeNode* node;
+    ParseTreeNode* next_sibling;
+} ReusedList;
+
+// A chain as it was before a reparse changed it, put back the same way
+typedef struct {
+    int chain;
+    ListChain saved;
+} ChangedChain;
+
+// An entry before the index's gap as it was before a reparse wrote over it
+typedef struct {
+    int slot;
+    StatementListEntry saved;
+} OverwrittenList;
+
+// What the last edit took
+typedef struct {
+    int relexed;                // tokens lexed in place of old ones
+    int reparsed;               // tokens parsed again
+    int reused;                 // statement lists taken over
+    bool whole_program;         // the program was reparsed, not one list
+    bool fresh;                 // relexed and reparsed from scratch
+} IncrementalStats;
+
+typedef struct IncrementalParse {
+    // The text, source[0, source_gap) then the rest after a gap of
+    // source_capacity - length bytes; incremental_source closes the gap
+    char* source;
+    size_t length;
+    size_t source_capacity;
+    size_t source_gap;
+    Parser* parser;             // its tokens, parse_tree and diagnostics
+    ExpressionTree expression_tree;
+    IncrementalStats stats;
+
+    // Where each of the parser's tokens starts in the source, in slots laid
+    // out like the token columns; the ones after the gap are tail_shift short
+    uint32_t* offsets;
+    uint32_t tail_shift;
+    int parse_rest;             // tokens after the ones parse_program read
+
+    // The index of the tree's statement lists: lists[0, list_front), a gap,
+    // then lists[list_tail, list_capacity)
+    StatementListEntry* lists;
+    int list_front;
+    int list_tail;
+    int list_capacity;
+    ListChain* chains;
+    int chain_count;
+    int chain_capacity;
+    int diagnostic_total;       // what entries after the gap count back from
+
+    // While reparsing: the next slot to record a list in, what of the previous
+    // index may be taken over, and what to put back if the reparse fails
+    bool reusing;
+    int write;
+    int reuse_next;             // slots [reuse_next, reuse_end) are candidates
+    int reuse_end;
+    int pending;                // a list taken over but left where it was, -1 for none ...
+    int pending_last;           // ... the last slot of its subtree ...
+    int pending_diagnostics;    // ... and where its diagnostics went
+    int ended_chain;            // chain of the list that just ended or was taken over
+    int chain_base;             // chains from here on are new in this reparse
+    int changed_start;          // tokens before it are as they were
+    int changed_end;            // old tokens from here on are unchanged ...
+    int token_delta;            // ... and moved this many places
+    int line_delta;             // and lines
+    ReusedList* reused;
+    int reused_count;
+    int reused_capacity;
+    ChangedChain* changed;
+    int changed_count;
+    int changed_capacity;
+    OverwrittenList* overwritten;
+    int overwritten_count;
+    int overwritten_capacity;
+    int* open_lists;            // slots of the lists entered and not ended yet, innermost last
+    int open_count;
+    int open_capacity;
+    Diagnostic* old_diagnostics;
+    int old_diagnostic_count;
+    int old_diagnostic_capacity;
+    bool out_of_memory;
+
+    // Garbage: lexeme text of removed tokens, text buffers outgrown while the
+    // tree still pointed into them, and the arena's size after a fresh parse
+    size_t dead_text;
+    char** retired_text;
+    int retired_count;
+    size_t fresh_arena_bytes;
+} IncrementalParse;
+
+// Lexes and parses source (copied). False when out of memory.
+bool incremental_open(IncrementalParse* ip, const char* source, size_t length, ExpressionTree expression_tree);
+// Applies the edit and updates ip->parser. False for an edit outside the
+// source (nothing changes) or when out of memory (only incremental_close is
+// left to do).
+bool incremental_edit(IncrementalParse* ip, const SourceEdit* edit);
+// The current text, NUL-terminated; moves the gap to the end, so an edit
+// away from the end after it pays for moving it back
+const char* incremental_source(IncrementalParse* ip);
+void incremental_close(IncrementalParse* ip);
+
+// parse_statement_list's hooks while an IncrementalParse owns the parser:
+// the list to take over at the current token (NULL: parse it), the slot of
+// one being parsed (-1 when out of memory), the first statement of that one
+// to take over (NULL: parse it), and the end of the count lists begun last
+ParseTreeNode* reuse_statement_list(Parser* p);
+int begin_statement_list(Parser* p, ParseTreeNode* node);
+ParseTreeNode* reuse_statement(Parser* p, int entry);
+void end_statement_lists(Parser* p, int count);
+
+#endif
@@ -1,95 +1,516 @@
 #include "parser.h"
+#include "frontend.h"
+#include "table_parser.h"
+#include "ast.h"
+#include "transitions.h"
+#include "treefile.h"
+#include "diagnostics.h"
+#include "../Lexer/source.h"
+#include "../Lexer/cli.h"
+#include <limits.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
-int main() {
-    printf("Syntax Analyzer for Usbong\n");
-    
-    // Read symbol table from lexer output
-    int token_count = 0;
-    Token* tokens = read_symbol_table("Symbol Table.txt", &token_count);
-    
-    if (tokens == NULL || token_count == 0) {
-        printf("\nFailed to read symbol table!\n");
-        printf("Please make sure:\n");
-        printf("1. Run your lexer first to generate 'Symbol Table.txt'\n");
-        printf("2. The file is in the same folder as parser.exe\n");
-        printf("3. The format is: lexeme | token | line\n\n");
-        return 1;
+// Usage: parser [options] [input ...]   (parser -h for the options)
+//   file.usb        lex the file in-process and parse its tokens
+//   file.usbt       load the lexer's binary token file
+//   file.txt        read a text symbol table written by the lexer
+//   -               lex and parse source read from stdin
+// With no input, reads the lexer's 'Symbol Table.txt' and reports on the
+// console as before.
+
+// Reports, in the order they are written
+enum { REPORT_VISUAL, REPORT_PARENTHESIZED, REPORT_TRANSITIONS, REPORT_DIAGRAM,
+       REPORT_SUMMARY, REPORT_JSON, REPORT_BINARY, REPORT_AST, REPORT_SYMBOLS, REPORT_COUNT };
+
+static const struct {
+    const char* option;       // name for -f
+    const char* legacy_name;  // file name for a single input without -o
+    const char* name;         // <input stem>.name otherwise
+} reports[REPORT_COUNT] = {
+    { "visual",        "parse_tree_visual.txt",        "parse_tree_visual.txt" },
+    { "parenthesized", "parse_tree_parenthesized.txt", "parse_tree_parenthesized.txt" },
+    { "transitions",   "transitions.txt",              "transitions.txt" },
+    { "diagram",       "transitions_diagram.txt",      "transitions_diagram.txt" },
+    { "summary",       "transitions_summary.txt",      "transitions_summary.txt" },
+    { "json",          "parse_tree.json",              "parse_tree.json" },
+    { "binary",        "parse_tree.usbp",              "parse_tree.usbp" },
+    { "ast",           "ast.txt",                      "ast.txt" },
+    { "symbols",       "Symbol Table.txt",             "symbols.txt" },
+};
+
+#define REPORTS_TRANSITIONS (7u << REPORT_TRANSITIONS)
+#define REPORTS_AST (1u << REPORT_AST)
+#if PARSER_TRACE
+#define REPORTS_DEFAULT 0x1F  // the parse tree and transition reports
+#else
+#define REPORTS_DEFAULT 0x03  // the parse tree reports, there is no transition log
+#endif
+
+// Parsing engines, chosen with -e
+enum { ENGINE_DESCENT, ENGINE_TABLE, ENGINE_AST };
+
+typedef struct {
+    const char* output_dir;
+    unsigned reports;    // bit per REPORT_*
+    bool status;         // one "<status>\t<path>" line per input on stdout
+    bool verbose;        // the interactive console output
+    bool prefix_stem;    // several inputs (or -o): name outputs after each input
+    int engine;          // ENGINE_*
+    ExpressionTree expressions;  // -x, descent engine only
+    int threads;         // -j, report writers at once (0: one per CPU)
+} Options;
+
+static void usage(FILE* out) {
+    fprintf(out,
+        "Usage: parser [options] [file.usb|file.usbt|file.txt|pattern|- ...]\n"
+        "  -o DIR     write the reports into DIR (created if missing)\n"
+        "  -f LIST    comma-separated reports: visual, parenthesized, transitions,\n"
+        "             diagram, summary, json, binary, ast, symbols, all or none\n"
+        "             (default all: the parse trees and transitions; json and binary\n"
+        "             are the parse tree for other programs, see treefile.h; -e ast\n"
+        "             writes ast in place of the others)\n"
+        "  -l FILE    read more inputs from FILE, one per line (- for stdin)\n"
+        "  -s         print \"<status>\\t<path>\" for every input\n"
+        "  -v         print the parser's progress, tokens and errors on the console\n"
+        "  -e ENGINE  descent (default): the recursive descent parser\n"
+        "             table: the table-driven LL(1) engine, same tree and transitions\n"
+        "             on valid input, simpler error recovery\n"
+        "             ast: an abstract syntax tree instead of the parse tree, written\n"
+        "             to the ast report, the only one it has (no transitions)\n"
+        "  -x TREE    expression subtrees of the descent engine: textbook (default),\n"
+        "             the grammar's Expression/Term/Factor chain, or compact, one\n"
+        "             node per operator and operand, with %% ^ && || ! in expressions\n"
+        "             and any expression as a condition\n"
+        "  -j N       write up to N reports at once (default and 0: one per CPU,\n"
+        "             1 writes them one after another)\n"
+        "  --symbol-table  same as adding symbols to -f\n"
+        "One input without -o writes the reports here under their usual names;\n"
+        "otherwise each input gets <name>.<report>.txt in DIR (default .),\n"
+        "and an input with the same <name> as an earlier one fails.\n"
+        "With no input, parses 'Symbol Table.txt' with the console output of -v.\n"
+        "Exit status: 0 no syntax errors, 1 syntax errors in some input,\n"
+        "2 some input could not be read or a report could not be written.\n");
+}
+
+static bool parse_report_list(const char* list, unsigned* selected) {
+    *selected = 0;
+    const char* p = list;
+    while (*p) {
+        size_t length = strcspn(p, ",");
+        bool known = false;
+        if (length == 3 && strncmp(p, "all", 3) == 0) {
+            *selected |= REPORTS_DEFAULT;
+            known = true;
+        } else if (length == 4 && strncmp(p, "none", 4) == 0) {
+            known = true;
+        }
+        for (int r = 0; !known && r < REPORT_COUNT; r++) {
+            if (strlen(reports[r].option) == length && strncmp(p, reports[r].option, length) == 0) {
+                *selected |= 1u << r;
+                known = true;
+            }
+        }
+        if (!known) return false;
+        p += length;
+        if (*p == ',') p++;
+    }
+    return true;
+}
+
+static char* report_path(const Options* opt, const char* input, int report) {
+    return opt->prefix_stem ? outputPath(opt->output_dir, input, reports[report].name, 1)
+                            : outputPath(opt->output_dir, input, reports[report].legacy_name, 0);
+}
+
+// Closes a symbols dump; false if it could not be opened or written
+static bool close_dump(FILE* fp) {
+    if (!fp) return false;
+    bool ok = !ferror(fp);
+    return fclose(fp) == 0 && ok;
+}
+
+// Load an input's tokens and create its parser; NULL if it cannot be read.
+// *dumped is false when the symbols report is selected and was not written.
+static Parser* load_input(const char* input, const Options* opt, bool* dumped) {
+    const char* ext = strrchr(input, '.');
+    bool dump = opt->reports & (1u << REPORT_SYMBOLS);
+    char* dump_path = dump ? report_path(opt, input, REPORT_SYMBOLS) : NULL;
+    Parser* parser = NULL;
+    TokenStore tokens;
+    bool loaded = false;
+    init_token_store(&tokens);
+    *dumped = !dump;
+
+    if (strcmp(input, "-") == 0) {
+        SourceBuffer source;
+        if (readSourceStream(&source, stdin)) {
+            FILE* fp = dump_path ? fopen(dump_path, "w") : NULL;
+            loaded = lex_source(source.data, source.length, &tokens, fp);
+            if (dump) *dumped = close_dump(fp);
+            closeSource(&source);
+        }
+    } else if (ext && strcmp(ext, ".usbt") == 0) {
+        loaded = read_token_file(input, &tokens);
+        if (loaded && dump_path) {
+            // Text form of the file, byte for byte what the lexer writes
+            TokenFile tf;
+            FILE* fp = fopen(dump_path, "w");
+            if (fp && open_token_file(input, &tf)) {
+                write_token_file_text(&tf, fp);
+                close_token_file(&tf);
+                *dumped = close_dump(fp);
+            } else if (fp) {
+                fclose(fp);
+            }
+        }
+    } else if (ext && strcmp(ext, ".txt") == 0) {
+        // Already a symbol table, there is nothing to dump
+        loaded = read_symbol_table(input, &tokens) && tokens.count > 0;
+        if (loaded && dump) {
+            fprintf(stderr, "parser: %s: is a symbol table already, there are no symbols to write\n", input);
+            dump = false;
+        }
+    } else {
+        // Lex the source directly, the symbol table is only an optional dump
+        FILE* fp = dump_path ? fopen(dump_path, "w") : NULL;
+        parser = create_parser_for_file(input, fp);
+        if (dump) *dumped = close_dump(fp);
+        if (!parser && fp) remove(dump_path);
+    }
+
+    if (loaded) parser = create_parser(&tokens);
+    if (parser && dump && !*dumped) {
+        fprintf(stderr, "parser: %s: cannot write %s\n", input, dump_path ? dump_path : reports[REPORT_SYMBOLS].name);
     }
-    
+    free_token_store(&tokens);
+    free(dump_path);
+    return parser;
+}
+
+static void print_tokens(const Parser* parser) {
+    const TokenStore* tokens = &parser->tokens;
+    int token_count = parser->token_count;
+
     // Display tokens being parsed
     printf("Tokens to parse:\n");
     printf("----------------\n");
     for (int i = 0; i < token_count && i < 20; i++) {
-        printf("%2d. %-20s %-25s Line %d\n", 
-               i+1, tokens[i].lexeme, tokens[i].type, tokens[i].line);
+        printf("%2d. %-20s %-25s Line %d\n",
+               i+1, tokens->text + tokens->lexemes[i], token_kind_name(tokens->kinds[i]), tokens->lines[i]);
     }
     if (token_count > 20) {
         printf("... and %d more tokens\n", token_count - 20);
     }
     printf("\n");
-    
-    // Create parser
-    Parser* parser = create_parser(tokens, token_count);
-    
+}
+
+static bool write_report(int report, const char* path, Parser* parser) {
+    switch (report) {
+        case REPORT_VISUAL:        return write_parse_tree_to_file(path, parser->parse_tree, true);
+        case REPORT_PARENTHESIZED: return write_parse_tree_to_file(path, parser->parse_tree, false);
+        case REPORT_TRANSITIONS:   return write_transition_table(path, parser);
+        case REPORT_DIAGRAM:       return write_transition_diagram(path, parser);
+        case REPORT_SUMMARY:       return write_transition_summary(path, parser);
+        case REPORT_JSON:          return write_parse_tree_json(path, parser->parse_tree);
+        case REPORT_BINARY:        return write_parse_tree_image(path, parser->parse_tree);
+        case REPORT_AST:           return write_ast_to_file(path, parser);
+        default:                   return false;
+    }
+}
+
+// The writers only read the tree, the tokens and the transition log, so the
+// reports are written side by side: each worker takes the next one from the
+// queue until none is left. The queue starts with the biggest, so the last
+// report to start is a short one.
+static const int report_write_order[] = {
+    REPORT_DIAGRAM, REPORT_VISUAL, REPORT_PARENTHESIZED, REPORT_SUMMARY,
+    REPORT_TRANSITIONS, REPORT_JSON, REPORT_BINARY, REPORT_AST,
+};
+#define WRITTEN_REPORT_COUNT (int)(sizeof(report_write_order) / sizeof(report_write_order[0]))
+
+typedef struct {
+    Parser* parser;
+    int queue[WRITTEN_REPORT_COUNT];  // the selected reports, biggest first
+    int count;
+    int next;                         // next one to hand out
+    char* paths[REPORT_COUNT];        // NULL if the path could not be made
+    bool written[REPORT_COUNT];
+#ifndef _WIN32
+    pthread_mutex_t lock;
+#endif
+} ReportJob;
+
+static void* report_worker(void* arg) {
+    ReportJob* job = (ReportJob*)arg;
+    while (1) {
+#ifndef _WIN32
+        pthread_mutex_lock(&job->lock);
+#endif
+        int i = job->next++;
+#ifndef _WIN32
+        pthread_mutex_unlock(&job->lock);
+#endif
+        if (i >= job->count) break;
+        int r = job->queue[i];
+        job->written[r] = job->paths[r] && write_report(r, job->paths[r], job->parser);
+    }
+    return NULL;
+}
+
+// Write the selected reports; returns false if any could not be written
+static bool write_reports(const Options* opt, const char* input, Parser* parser) {
+    int threads = 1;
+#ifndef _WIN32
+    threads = opt->threads;
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+#endif
+    // One writer keeps the usual order, and with it the -v progress lines
+    ReportJob job;
+    job.parser = parser;
+    job.count = 0;
+    job.next = 0;
+    for (int i = 0; i < WRITTEN_REPORT_COUNT; i++) {
+        int r = threads > 1 ? report_write_order[i] : REPORT_VISUAL + i;
+        if (opt->reports & (1u << r)) {
+            job.queue[job.count++] = r;
+            job.paths[r] = report_path(opt, input, r);
+            job.written[r] = false;
+        }
+    }
+
+#ifndef _WIN32
+    pthread_t workers[WRITTEN_REPORT_COUNT];
+    int started = 0;
+    pthread_mutex_init(&job.lock, NULL);
+    while (started < threads - 1 && started < job.count - 1 &&
+           pthread_create(&workers[started], NULL, report_worker, &job) == 0) {
+        started++;
+    }
+#endif
+    report_worker(&job);  // the calling thread writes too, all of them if no worker started
+#ifndef _WIN32
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    pthread_mutex_destroy(&job.lock);
+#endif
+
+    // Failures in the usual report order, whichever finished first
+    bool ok = true;
+    for (int r = 0; r < REPORT_SYMBOLS; r++) {
+        if (!(opt->reports & (1u << r))) continue;
+        if (!job.written[r]) {
+            fprintf(stderr, "parser: %s: cannot write %s\n", input, job.paths[r] ? job.paths[r] : reports[r].name);
+            ok = false;
+        }
+        free(job.paths[r]);
+    }
+    return ok;
+}
+
+static int parse_input(const char* input, const Options* opt) {
+    bool dumped;
+    Parser* parser = load_input(input, opt, &dumped);
+    if (parser == NULL) {
+        fprintf(stderr, "parser: %s: cannot be read\n", input);
+        return STATUS_FAILED;
+    }
+    if (opt->verbose) print_tokens(parser);
+
     // Initialize transition tracking BEFORE parsing
     init_transition_tracking();
 
-    bool success = parse_program(parser);
-    
-    if (success) {
-        printf("PARSING SUCCESSFUL! No syntax errors found.\n");
-        
-        // Generate parse trees
-        printf("Generating parse trees...\n\n");
-        
-        // Visual tree
-        write_parse_tree_to_file("parse_tree_visual.txt", parser->parse_tree, true);
-        
-        // Parenthesized notation
-        write_parse_tree_to_file("parse_tree_parenthesized.txt", parser->parse_tree, false);
-
-    if (transition_count == 0) {
-    printf("WARNING: No transitions recorded! Did you add tracking to your parse functions?\n");
-    }
-
-        
-        // Generate transition table and diagram
-        write_transition_table("transitions.txt");
-        write_transition_diagram("transitions_diagram.txt");
-        write_transition_summary("transitions_summary.txt");
-        
-        printf("\nOutput files created:\n");
-        printf("  1. parse_tree_visual.txt         - Tree diagram format\n");
-        printf("  2. parse_tree_parenthesized.txt  - Parenthesized notation\n");
-        printf("  3. transitions.txt               - Transition table\n");
-        printf("  4. transitions_diagram.txt       - Transition diagram\n\n");
-        
+    parser->expression_tree = opt->expressions;
+    bool success;
+    switch (opt->engine) {
+        case ENGINE_TABLE: success = parse_program_table(parser); break;
+        case ENGINE_AST:   success = parse_program_ast(parser); break;
+        default:           success = parse_program(parser); break;
+    }
+
+    if (opt->verbose) {
+        if (success) {
+            printf("PARSING SUCCESSFUL! No syntax errors found.\n");
+            printf("Generating parse trees...\n\n");
+            if (transition_tracing && transition_count == 0 && opt->engine != ENGINE_AST) {
+                printf("WARNING: No transitions recorded! Did you add tracking to your parse functions?\n");
+            }
+        } else {
+            printf("PARSING DONE (Errors Found)\n");
+            printf("\nTotal syntax errors: %d\n\n", parser->error_count);
+            printf("Error details:\n");
+            printf("--------------\n");
+            for (int i = 0; i < parser->error_count; i++) {
+                printf("%2d. ", i+1);
+                write_diagnostic(stdout, parser, &parser->diagnostics[i]);
+                printf("\n");
+            }
+            printf("\nParse tree generated despite errors (for debugging)\n");
+            printf("  Check parse_tree_visual.txt to see where parsing failed\n");
+        }
     } else {
-        printf("PARSING DONE (Errors Found)\n");
-        printf("\nTotal syntax errors: %d\n\n", parser->error_count);
-        printf("Error details:\n");
-        printf("--------------\n");
         for (int i = 0; i < parser->error_count; i++) {
-            printf("%2d. %s\n", i+1, parser->errors[i]);
+            fprintf(stderr, "%s: ", input);
+            write_diagnostic(stderr, parser, &parser->diagnostics[i]);
+            fputc('\n', stderr);
+        }
+    }
+
+    // The reports are written either way, the tree shows where parsing failed
+    bool written = write_reports(opt, input, parser) && dumped;
+    if (opt->verbose && success && written) {
+        printf("\nOutput files created:\n");
+        for (int r = 0, n = 0; r < REPORT_SYMBOLS; r++) {
+            if (!(opt->reports & (1u << r))) continue;
+            char* path = report_path(opt, input, r);
+            if (path) printf("  %d. %s\n", ++n, path);
+            free(path);
         }
+        printf("\n");
+    }
+    if (opt->verbose) printf("PDA Operation Complete\n");
 
-        printf("\nParse tree generated despite errors (for debugging)\n");
-        printf("  Check parse_tree_visual.txt to see where parsing failed\n");
-        
-        // Still generate parse trees for debugging
-        write_parse_tree_to_file("parse_tree_visual.txt", parser->parse_tree, true);
-        write_parse_tree_to_file("parse_tree_parenthesized.txt", parser->parse_tree, false);
-        
-        // Generate transition table and diagram
-        write_transition_table("transitions.txt");
-        write_transition_diagram("transitions_diagram.txt");
-        write_transition_summary("transitions_summary.txt");
-    }
-    
-    printf("PDA Operation Complete\n");
-    
-    // Cleanup
     free_parser(parser);
-    
-    return success ? 0 : 1;
-}
\ No newline at end of file
+    if (!written) return STATUS_FAILED;
+    return success ? STATUS_OK : STATUS_INPUT_ERRORS;
+}
+
+int main(int argc, char* argv[]) {
+    Options opt = { ".", REPORTS_DEFAULT, false, false, false, ENGINE_DESCENT,
+                    EXPRESSION_TREE_TEXTBOOK, 0 };
+    InputList inputs = {0};
+    bool named_dir = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--symbol-table") == 0) {
+            opt.reports |= 1u << REPORT_SYMBOLS;
+            continue;
+        }
+        if (arg[0] != '-' || arg[1] == '\0') {
+            if (!addInput(&inputs, arg)) {
+                fprintf(stderr, "parser: %s: cannot expand\n", arg);
+                return STATUS_FAILED;
+            }
+            continue;
+        }
+        char option = arg[1];
+        const char* value = NULL;
+        if (strchr("oflexj", option)) { // options with a value: -oDIR or -o DIR
+            value = arg[2] ? arg + 2 : (i + 1 < argc ? argv[++i] : NULL);
+            if (!value) {
+                usage(stderr);
+                return STATUS_FAILED;
+            }
+        } else if (arg[2] != '\0') {
+            option = '?';
+        }
+        switch (option) {
+            case 'o': opt.output_dir = value; named_dir = true; break;
+            case 'f':
+                if (!parse_report_list(value, &opt.reports)) {
+                    usage(stderr);
+                    return STATUS_FAILED;
+                }
+                break;
+            case 'l':
+                if (!addInputsFromFile(&inputs, value)) {
+                    fprintf(stderr, "parser: %s: cannot read the input list\n", value);
+                    return STATUS_FAILED;
+                }
+                break;
+            case 'e':
+                if (strcmp(value, "descent") == 0) opt.engine = ENGINE_DESCENT;
+                else if (strcmp(value, "table") == 0) opt.engine = ENGINE_TABLE;
+                else if (strcmp(value, "ast") == 0) opt.engine = ENGINE_AST;
+                else {
+                    usage(stderr);
+                    return STATUS_FAILED;
+                }
+                break;
+            case 'x':
+                if (strcmp(value, "textbook") == 0) opt.expressions = EXPRESSION_TREE_TEXTBOOK;
+                else if (strcmp(value, "compact") == 0) opt.expressions = EXPRESSION_TREE_COMPACT;
+                else {
+                    usage(stderr);
+                    return STATUS_FAILED;
+                }
+                break;
+            case 'j':
+                if (!parseCount(value, 0, INT_MAX, &opt.threads)) {
+                    usage(stderr);
+                    return STATUS_FAILED;
+                }
+                break;
+            case 's': opt.status = true; break;
+            case 'v': opt.verbose = true; break;
+            case 'h': usage(stdout); return STATUS_OK;
+            default: usage(stderr); return STATUS_FAILED;
+        }
+    }
+
+    // The AST engine has no parse tree or transitions to report, only the AST
+    if (opt.engine == ENGINE_AST) {
+        unsigned symbols = opt.reports & (1u << REPORT_SYMBOLS);
+        if (opt.reports != symbols) opt.reports = REPORTS_AST | symbols;
+    } else {
+        opt.reports &= ~REPORTS_AST;
+    }
+#if !PARSER_TRACE
+    if (opt.reports & REPORTS_TRANSITIONS) {
+        fprintf(stderr, "parser: built with PARSER_TRACE=0, there are no transition reports\n");
+        return STATUS_FAILED;
+    }
+#endif
+    // The transition log costs a record per step, keep it for its reports
+    transition_tracing = (opt.reports & REPORTS_TRANSITIONS) != 0;
+
+    bool legacy = inputs.count == 0;
+    if (legacy) {
+        // Read symbol table from lexer output, reporting on the console
+        printf("Syntax Analyzer for Usbong\n");
+        opt.verbose = true;
+        if (!addInput(&inputs, "Symbol Table.txt")) return STATUS_FAILED;
+    }
+    parser_verbosity = opt.verbose ? 1 : 0;
+    opt.prefix_stem = named_dir || inputs.count > 1;
+    if (named_dir && !makeDirectories(opt.output_dir)) {
+        fprintf(stderr, "parser: %s: cannot create the output directory\n", opt.output_dir);
+        return STATUS_FAILED;
+    }
+
+    unsigned char* collides = findStemCollisions(&inputs);
+    if (!collides) {
+        fprintf(stderr, "parser: out of memory\n");
+        return STATUS_FAILED;
+    }
+
+    int worst = STATUS_OK;
+    for (size_t i = 0; i < inputs.count; i++) {
+        int status;
+        if (opt.prefix_stem && collides[i]) {
+            fprintf(stderr, "parser: %s: an earlier input has the same name, its reports would be overwritten\n",
+                    inputs.paths[i]);
+            status = STATUS_FAILED;
+        } else {
+            status = parse_input(inputs.paths[i], &opt);
+        }
+        if (opt.status) printf("%d\t%s\n", status, inputs.paths[i]);
+        if (status > worst) worst = status;
+    }
+    if (legacy && worst == STATUS_FAILED) {
+        printf("\nFailed to read symbol table!\n");
+        printf("Please make sure:\n");
+        printf("1. Run your lexer first to generate 'Symbol Table.txt'\n");
+        printf("2. The file is in the same folder as parser.exe\n");
+        printf("3. The format is: lexeme | token | line\n\n");
+        printf("Or pass a .usb file to lex and parse it in one step.\n\n");
+    }
+    free(collides);
+    freeInputList(&inputs);
+    return worst;
+}
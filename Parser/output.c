@@ -0,0 +1,68 @@
+#include <stdlib.h>
+#include <stdarg.h>
+#include "output.h"
+
+bool output_open(Output* out, const char* filename) {
+    out->data = (char*)malloc(OUTPUT_BUFFER);
+    out->fp = out->data ? fopen(filename, "w") : NULL;
+    if (!out->fp) {
+        free(out->data);
+        return false;
+    }
+    out->used = 0;
+    out->failed = false;
+    return true;
+}
+
+void output_flush(Output* out) {
+    if (out->used > 0 && fwrite(out->data, 1, out->used, out->fp) != out->used) {
+        out->failed = true;
+    }
+    out->used = 0;
+}
+
+bool output_close(Output* out) {
+    output_flush(out);
+    bool ok = fclose(out->fp) == 0 && !out->failed;
+    free(out->data);
+    return ok;
+}
+
+void output_spaces(Output* out, size_t count) {
+    static const char spaces[] = "                                                                ";
+    while (count > 0) {
+        size_t n = count < sizeof(spaces) - 1 ? count : sizeof(spaces) - 1;
+        output_write(out, spaces, n);
+        count -= n;
+    }
+}
+
+void output_format(Output* out, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t room = OUTPUT_BUFFER - out->used;
+    int n = vsnprintf(out->data + out->used, room, format, args);
+    va_end(args);
+    if (n < 0) {
+        out->failed = true;
+    } else if ((size_t)n < room) {
+        out->used += n;
+    } else {
+        // Did not fit: make room and format it again, or allocate for a huge one
+        output_flush(out);
+        va_start(args, format);
+        if ((size_t)n < OUTPUT_BUFFER) {
+            out->used = vsnprintf(out->data, OUTPUT_BUFFER, format, args);
+        } else {
+            char* text = (char*)malloc((size_t)n + 1);
+            if (text) {
+                vsnprintf(text, (size_t)n + 1, format, args);
+                output_write(out, text, n);
+                free(text);
+            } else {
+                out->failed = true;
+            }
+        }
+        va_end(args);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Report file written through one large buffer: the writers append small
+// pieces (a prefix, a name, a newline) with a memcpy each and the file sees
+// one fwrite per OUTPUT_BUFFER bytes. Errors are sticky, output_close tells
+// whether everything reached the file.
+#define OUTPUT_BUFFER (1 << 20)
+
+typedef struct {
+    FILE* fp;
+    char* data;
+    size_t used;
+    bool failed;
+} Output;
+
+// Creates filename for writing; false (nothing to close) if it cannot
+bool output_open(Output* out, const char* filename);
+void output_flush(Output* out);
+// Flushes and closes; false if any write failed
+bool output_close(Output* out);
+
+static inline void output_write(Output* out, const char* text, size_t length) {
+    if (OUTPUT_BUFFER - out->used < length) {
+        output_flush(out);
+        if (length > OUTPUT_BUFFER) {
+            if (fwrite(text, 1, length, out->fp) != length) out->failed = true;
+            return;
+        }
+    }
+    memcpy(out->data + out->used, text, length);
+    out->used += length;
+}
+
+static inline void output_string(Output* out, const char* text) {
+    output_write(out, text, strlen(text));
+}
+
+static inline void output_char(Output* out, char c) {
+    if (out->used == OUTPUT_BUFFER) output_flush(out);
+    out->data[out->used++] = c;
+}
+
+// count spaces
+void output_spaces(Output* out, size_t count);
+// printf into the buffer
+void output_format(Output* out, const char* format, ...);
+
+#endif
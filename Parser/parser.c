@@ -1,444 +1,357 @@
 #include "parser.h"
-#define MAX_TRANSITIONS 5000
-#define MAX_STACK_DEPTH 100
-
-Token* peek(Parser* p);
+#include "grammar.h"
+#include "diagnostics.h"
+#include "incremental.h"
+#include "transitions.h"
+#include "output.h"
+#include "../Lexer/lexer.h"
+
+ParserToken* peek(Parser* p);
 void advance(Parser* p);
-bool check_token(Parser* p, const char* type);
+bool check_token(Parser* p, TokenKind type);
 
 
-typedef struct {
-    int step;
-    char stack[256];
-    char input_symbol[64];
-    char action[128];
-    char production[256];
-} Transition;
+int parser_verbosity = 1;
+
+// ============ TOKEN KINDS ============
+
+// Names of the packed kinds come from the lexer (token_value_name), so the
+// reports spell them exactly as the symbol table does. Names it never writes
+// are kept in extra_kind_names, kind TOKEN_KIND_COUNT + i.
+static const char* kind_names[TOKEN_KIND_COUNT];
+static char** extra_kind_names;
+static int extra_kind_count = 0;
+static int extra_kind_capacity = 0;
 
-// Global tracking variables
-Transition transitions[MAX_TRANSITIONS];
-int transition_count = 0;
-int current_depth = 0;
-char stack_trace[MAX_STACK_DEPTH][64];
+// Name -> kind, open addressing; -1 marks an empty slot
+static int* kind_slots;
+static int kind_slot_count = 0;
 
-// Initialize transition tracking
-void init_transition_tracking() {
-    transition_count = 0;
-    current_depth = 0;
-    memset(stack_trace, 0, sizeof(stack_trace));
-    strcpy(stack_trace[0], "$");
-    current_depth = 1;
+static unsigned int hash_kind_name(const char* name) {
+    unsigned int h = 2166136261u; // FNV-1a
+    while (*name) h = (h ^ (unsigned char)*name++) * 16777619u;
+    return h;
 }
 
-// Add a transition record
-void record_transition(const char* input_sym, const char* action, const char* production) {
-    if (transition_count >= MAX_TRANSITIONS) return;
-    
-    Transition* t = &transitions[transition_count++];
-    t->step = transition_count;
-    
-    // Build stack string from bottom to top
-    strcpy(t->stack, "$");
-    for (int i = 1; i < current_depth; i++) {
-        strcat(t->stack, " ");
-        strcat(t->stack, stack_trace[i]);
+// Slot of name: where it is, or the empty slot where it would go
+static int find_kind_slot(const char* name) {
+    int slot = hash_kind_name(name) & (kind_slot_count - 1);
+    while (kind_slots[slot] >= 0 && strcmp(token_kind_name(kind_slots[slot]), name) != 0) {
+        slot = (slot + 1) & (kind_slot_count - 1);
     }
-    
-    strncpy(t->input_symbol, input_sym, 63);
-    strncpy(t->action, action, 127);
-    strncpy(t->production, production ? production : "", 255);
+    return slot;
 }
 
-// Push non-terminal onto stack trace
-void push_stack(const char* symbol) {
-    if (current_depth < MAX_STACK_DEPTH) {
-        strncpy(stack_trace[current_depth++], symbol, 63);
+static bool grow_kind_slots(void) {
+    int count = kind_slot_count ? kind_slot_count * 2 : 1024;
+    int* slots = (int*)malloc(count * sizeof(int));
+    if (!slots) return false;
+    free(kind_slots);
+    kind_slots = slots;
+    kind_slot_count = count;
+    memset(kind_slots, 0xFF, count * sizeof(int));
+
+    // First kind with a name wins: the lexer's *_UNKNOWN names repeat
+    for (int kind = 0; kind < TOKEN_KIND_COUNT + extra_kind_count; kind++) {
+        int slot = find_kind_slot(token_kind_name(kind));
+        if (kind_slots[slot] < 0) kind_slots[slot] = kind;
     }
+    return true;
 }
 
-// Pop from stack trace
-void pop_stack() {
-    if (current_depth > 1) {
-        current_depth--;
+static bool add_extra_kind(const char* name) {
+    if (extra_kind_count == extra_kind_capacity) {
+        int capacity = extra_kind_capacity ? extra_kind_capacity * 2 : 16;
+        char** grown = (char**)realloc(extra_kind_names, capacity * sizeof(char*));
+        if (!grown) return false;
+        extra_kind_names = grown;
+        extra_kind_capacity = capacity;
     }
+    char* copy = (char*)malloc(strlen(name) + 1);
+    if (!copy) return false;
+    strcpy(copy, name);
+    extra_kind_names[extra_kind_count++] = copy;
+    return true;
 }
 
-void enter_nonterminal(const char* nonterminal, const char* lookahead) {
-    char action[128];
-    sprintf(action, "ENTER %s", nonterminal);
-    push_stack(nonterminal);
-    record_transition(lookahead, action, NULL);
+static bool init_kind_names(void) {
+    if (kind_slot_count > 0) return true;
+    for (int kind = 0; kind < TOKEN_KIND_COUNT; kind++) {
+        Token t;
+        t.category = (TokenCategory)(kind >> TOKEN_KIND_VALUE_BITS);
+        t.tokenValue = kind & ((1 << TOKEN_KIND_VALUE_BITS) - 1);
+        kind_names[kind] = token_value_name(&t);
+    }
+    return (extra_kind_count > 0 || add_extra_kind("R_VOID")) && grow_kind_slots();
 }
 
-void exit_nonterminal(const char* nonterminal, const char* lookahead) {
-    char action[128];
-    sprintf(action, "EXIT %s", nonterminal);
-    
-    // Safety check: if lookahead is NULL or we're past EOF, use "EOF"
-    const char* safe_lookahead = (lookahead && strlen(lookahead) > 0) ? lookahead : "EOF";
-    
-    record_transition(safe_lookahead, action, NULL);
-    pop_stack();
+const char* token_kind_name(TokenKind kind) {
+    if (kind >= 0 && kind < TOKEN_KIND_COUNT) {
+        init_kind_names();
+        return kind_names[kind];
+    }
+    if (kind >= TOKEN_KIND_COUNT && kind < TOKEN_KIND_COUNT + extra_kind_count) {
+        return extra_kind_names[kind - TOKEN_KIND_COUNT];
+    }
+    return "UNKNOWN";
 }
 
-void match_terminal(const char* terminal, const char* value) {
-    char action[128];
-    sprintf(action, "MATCH '%s'", terminal);
-    char input[64];
-    sprintf(input, "%s", value);
-    record_transition(input, action, NULL);
+TokenKind token_kind_from_name(const char* name) {
+    if (!init_kind_names()) return T_NONE;
+    int slot = find_kind_slot(name);
+    if (kind_slots[slot] >= 0) return kind_slots[slot];
+
+    // A name the lexer never writes: give it the next extra kind
+    if (!add_extra_kind(name)) return T_NONE;
+    if ((TOKEN_KIND_COUNT + extra_kind_count) * 2 > kind_slot_count) {
+        if (!grow_kind_slots()) return T_NONE;
+        slot = find_kind_slot(name);
+    }
+    kind_slots[slot] = TOKEN_KIND_COUNT + extra_kind_count - 1;
+    return kind_slots[slot];
 }
 
-void apply_production(const char* production_rule) {
-    record_transition("", "REDUCE", production_rule);
+// ============ TOKEN STORE ============
+
+void init_token_store(TokenStore* tokens) {
+    memset(tokens, 0, sizeof(TokenStore));
 }
 
-// Write transition table to file
-void write_transition_table(const char* filename) {
-   
-    FILE* fp = fopen(filename, "w");
-    if (!fp) {
-        printf("ERROR: Cannot create transition table file '%s'\n", filename);
-        return;
-    }
-    
-    fprintf(fp, "PARSING TRANSITION TABLE\n");
-    fprintf(fp, "Generated by Recursive Descent Parser (Pushdown Automaton)\n");
-    fprintf(fp, "======================================================================\n\n");
-    
-    // Table header
-    fprintf(fp, "%-6s %-30s %-20s %-25s %-30s\n", 
-            "STEP", "STACK", "INPUT", "ACTION", "PRODUCTION/DETAILS");
-    fprintf(fp, "%-6s %-30s %-20s %-25s %-30s\n",
-            "------", "------------------------------", 
-            "--------------------", "-------------------------",
-            "------------------------------");
-    
-    // Table rows
-    for (int i = 0; i < transition_count; i++) {
-        Transition* t = &transitions[i];
-        fprintf(fp, "%-6d %-30s %-20s %-25s %-30s\n",
-                t->step,
-                t->stack,
-                t->input_symbol,
-                t->action,
-                t->production);
-    }
-    
-    fprintf(fp, "\n======================================================================\n");
-    fprintf(fp, "Total transitions: %d\n", transition_count);
-    fprintf(fp, "End of Transition Table\n");
-    
-    fclose(fp);
-    printf("Transition table written to '%s'\n", filename);
+void free_token_store(TokenStore* tokens) {
+    free(tokens->kinds);
+    free(tokens->lines);
+    free(tokens->lexemes);
+    free(tokens->text);
+    init_token_store(tokens);
 }
 
-// Alternative: ASCII Diagram format
-void write_transition_diagram(const char* filename) {
-    FILE* fp = fopen(filename, "w");
-    if (!fp) {
-        printf("ERROR: Cannot create transition diagram file '%s'\n", filename);
-        return;
+bool reserve_token_store(TokenStore* tokens, int count, size_t text_length) {
+    if (count > tokens->capacity) {
+        uint16_t* kinds = (uint16_t*)realloc(tokens->kinds, count * sizeof(uint16_t));
+        if (kinds) tokens->kinds = kinds;
+        int* lines = (int*)realloc(tokens->lines, count * sizeof(int));
+        if (lines) tokens->lines = lines;
+        uint32_t* lexemes = (uint32_t*)realloc(tokens->lexemes, count * sizeof(uint32_t));
+        if (lexemes) tokens->lexemes = lexemes;
+        if (!kinds || !lines || !lexemes) return false;
+        tokens->capacity = count;
     }
-    
-    fprintf(fp, "PARSING TRANSITION DIAGRAM\n");
-    fprintf(fp, "======================================================================\n\n");
-    
-    char last_nonterminal[128] = "";
-    int depth = 0;
-    
-    for (int i = 0; i < transition_count; i++) {
-        Transition* t = &transitions[i];
-        
-        // Add section break when entering new major non-terminals
-        if (strncmp(t->action, "ENTER", 5) == 0) {
-            depth++;
-            if (depth <= 2) {  // Only show headers for top 2 levels
-                fprintf(fp, "\n========== %s ==========\n\n", t->action);
-            }
-        } else if (strncmp(t->action, "EXIT", 4) == 0) {
-            depth--;
-        }
-        
-        // Indent based on depth
-        for (int j = 0; j < depth; j++) fprintf(fp, "  ");
-        
-        fprintf(fp, "[Step %d] %s\n", t->step, t->action);
-        
-        // Show details on same line for terminals
-        if (strncmp(t->action, "MATCH", 5) == 0) {
-            for (int j = 0; j < depth; j++) fprintf(fp, "  ");
-            fprintf(fp, "    Input: %s\n", t->input_symbol);
-        }
+    if (text_length > tokens->text_capacity) {
+        if (text_length > UINT32_MAX) return false; // lexeme offsets are 32-bit
+        char* text = (char*)realloc(tokens->text, text_length);
+        if (!text) return false;
+        tokens->text = text;
+        tokens->text_capacity = text_length;
     }
-    
-    fprintf(fp, "\n[ACCEPT]\n");
-    fprintf(fp, "\n======================================================================\n");
-    fprintf(fp, "End of Transition Diagram\n");
-    
-    fclose(fp);
-    printf("Transition diagram written to '%s'\n", filename);
+    return true;
 }
 
-void write_transition_summary(const char* filename) {
-    FILE* fp = fopen(filename, "w");
-    if (!fp) {
-        printf("ERROR: Cannot create transition summary file '%s'\n", filename);
-        return;
+bool add_token(TokenStore* tokens, TokenKind kind, const char* lexeme, size_t length, int line) {
+    if (kind < 0 || kind > UINT16_MAX || tokens->count == INT32_MAX) return false;
+
+    int count = tokens->capacity;
+    if (tokens->count == count) count = count ? count * 2 : 1024;
+    size_t text_length = tokens->text_capacity;
+    while (tokens->text_length + length + 1 > text_length) {
+        text_length = text_length ? text_length * 2 : 8192;
     }
-    
-    fprintf(fp, "PARSING TRANSITION SUMMARY\n");
-    fprintf(fp, "======================================================================\n\n");
-    
-    int depth = 0;
-    char last_action[128] = "";
-    
-    for (int i = 0; i < transition_count; i++) {
-        Transition* t = &transitions[i];
-        
-        // Only show ENTER and EXIT (skip individual MATCH actions)
-        if (strncmp(t->action, "ENTER", 5) == 0) {
-            depth++;
-            for (int j = 0; j < depth - 1; j++) fprintf(fp, "  ");
-            fprintf(fp, "↓ %s [Input: %s]\n", t->action, t->input_symbol);
-        } else if (strncmp(t->action, "EXIT", 4) == 0) {
-            for (int j = 0; j < depth - 1; j++) fprintf(fp, "  ");
-            fprintf(fp, "↑ %s\n", t->action);
-            depth--;
-        }
+    if (!reserve_token_store(tokens, count, text_length)) return false;
+
+    int i = tokens->count++;
+    tokens->kinds[i] = (uint16_t)kind;
+    tokens->lines[i] = line;
+    tokens->lexemes[i] = (uint32_t)tokens->text_length;
+    memcpy(tokens->text + tokens->text_length, lexeme, length);
+    tokens->text[tokens->text_length + length] = '\0';
+    tokens->text_length += length + 1;
+    return true;
+}
+
+// Fill in the parser's view of token i
+ParserToken* read_token(const TokenStore* tokens, int i, ParserToken* token) {
+    int slot = i, line = 0;
+    if (i >= tokens->gap) {
+        slot += tokens->gap_length;
+        line = tokens->tail_lines;
     }
-    
-    fprintf(fp, "\n======================================================================\n");
-    fprintf(fp, "Total parsing steps: %d\n", transition_count);
-    fprintf(fp, "End of Summary\n");
-    
-    fclose(fp);
-    printf("Transition summary written to '%s'\n", filename);
+    token->lexeme = tokens->text + tokens->lexemes[slot];
+    token->kind = tokens->kinds[slot];
+    token->line = tokens->lines[slot] + line;
+    return token;
 }
 
 // ============ UTILITY FUNCTIONS ============
 
-// Trim whitespace from string
-void trim(char* str) {
-    char* start = str;
-    char* end;
-    
-    // Trim leading space
-    while(isspace((unsigned char)*start)) start++;
-    
-    if(*start == 0) {
-        str[0] = '\0';
-        return;
+// Trim whitespace from the length bytes at *text in place: *text moves past
+// the leading space, the trimmed length is returned
+static size_t trim(char** text, size_t length) {
+    while (length > 0 && isspace((unsigned char)**text)) {
+        (*text)++;
+        length--;
     }
-    
-    // Trim trailing space
-    end = start + strlen(start) - 1;
-    while(end > start && isspace((unsigned char)*end)) end--;
-    
-    // Write new null terminator
-    size_t len = (end - start) + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
+    while (length > 0 && isspace((unsigned char)(*text)[length - 1])) length--;
+    return length;
+}
+
+static const char* node_kind_names[] = {
+#define NODE_KIND_NAME(kind, name) name,
+    PARSE_NODE_KINDS(NODE_KIND_NAME)
+#undef NODE_KIND_NAME
+};
+
+const char* node_name(const ParseTreeNode* node) {
+    return node->kind < NODE_TOKEN ? node_kind_names[node->kind]
+                                   : token_kind_name(node->kind - NODE_TOKEN);
 }
 
 // Create a new parse tree node
-ParseTreeNode* create_node(const char* name, const char* value) {
-    ParseTreeNode* node = (ParseTreeNode*)malloc(sizeof(ParseTreeNode));
-    strcpy(node->name, name);
-    if (value) {
-        strcpy(node->value, value);
-    } else {
-        node->value[0] = '\0';
-    }
-    node->child_count = 0;
+ParseTreeNode* create_node(Parser* p, NodeKind kind, const char* value) {
+    ParseTreeNode* node = (ParseTreeNode*)arena_alloc(&p->nodes, sizeof(ParseTreeNode));
+    if (!node) return NULL;
+    node->kind = kind;
+    node->value = value;
+    node->first_child = NULL;
+    node->last_child = NULL;
+    node->next_sibling = NULL;
     return node;
 }
 
-// Add child to parse tree node
-void add_child(ParseTreeNode* parent, ParseTreeNode* child) {
-    if (child != NULL && parent->child_count < MAX_CHILDREN) {
-        parent->children[parent->child_count++] = child;
-    }
+ParseTreeNode* create_token_node(Parser* p) {
+    return create_node(p, (NodeKind)(NODE_TOKEN + p->current_token->kind), p->current_token->lexeme);
 }
 
-// Free parse tree memory
-void free_tree(ParseTreeNode* node) {
-    if (node == NULL) return;
-    for (int i = 0; i < node->child_count; i++) {
-        free_tree(node->children[i]);
+// Add child to parse tree node
+void add_child(ParseTreeNode* parent, ParseTreeNode* child) {
+    if (parent == NULL || child == NULL) return;
+    if (parent->last_child) {
+        parent->last_child->next_sibling = child;
+    } else {
+        parent->first_child = child;
     }
-    free(node);
+    parent->last_child = child;
 }
 
 // ============ PARSER CORE FUNCTIONS ============
 
 // Create parser
-Parser* create_parser(Token* tokens, int count) {
+Parser* create_parser(TokenStore* tokens) {
+    // The names are built here, not on first use by a report: the report
+    // writers run on several threads and only read them
+    init_kind_names();
     Parser* p = (Parser*)malloc(sizeof(Parser));
-    p->tokens = tokens;
-    p->token_count = count;
+    p->tokens = *tokens;
+    init_token_store(tokens);
+    p->token_count = p->tokens.count;
     p->pos = 0;
-    p->current_token = (count > 0) ? &tokens[0] : NULL;
+    p->current_token = (p->token_count > 0) ? read_token(&p->tokens, 0, &p->current) : NULL;
+    p->diagnostics = NULL;
     p->error_count = 0;
+    p->diagnostic_capacity = 0;
     p->parse_tree = NULL;
+    p->expression_tree = EXPRESSION_TREE_TEXTBOOK;
+    p->ast = NULL;
+    p->incremental = NULL;
+    arena_init(&p->nodes);
     return p;
 }
 
 // Free parser memory
 void free_parser(Parser* p) {
-    if (p->parse_tree) {
-        free_tree(p->parse_tree);
-    }
-    if (p->tokens) {
-        free(p->tokens);
-    }
+    arena_free(&p->nodes);
+    free(p->diagnostics);
+    free_token_store(&p->tokens);
     free(p);
 }
 
-// Record error
-void parser_error(Parser* p, const char* message) {
-    if (p->error_count < MAX_ERRORS) {
-        if (p->current_token) {
-            sprintf(p->errors[p->error_count], 
-                    "Line %d: %s (Found: %s '%s')",
-                    p->current_token->line, message,
-                    p->current_token->type, p->current_token->lexeme);
-        } else {
-            sprintf(p->errors[p->error_count], "End of file: %s", message);
-        }
-        printf("ERROR: %s\n", p->errors[p->error_count]);
-        p->error_count++;
-    }
-}
-
-// ERROR RECOVERY: Skip tokens until we find a synchronizing token
-void synchronize(Parser* p, const char* sync_tokens[], int sync_count) {
-    printf("    [ERROR RECOVERY] Synchronizing...\n");
-    
-    int tokens_skipped = 0;
-    while (peek(p) && tokens_skipped < 50) {  // Prevent infinite loops
-        // Check if current token is a sync token
-        for (int i = 0; i < sync_count; i++) {
-            if (check_token(p, sync_tokens[i])) {
-                printf("    [ERROR RECOVERY] Synchronized at %s\n", sync_tokens[i]);
-                return;
-            }
-        }
-        // Also stop at statement terminators and block delimiters
-        if (check_token(p, "D_SEMICOLON")) {
-            printf("    [ERROR RECOVERY] Synchronized at semicolon\n");
-            return;
-        }
-        if (check_token(p, "D_RBRACE")) {
-            printf("    [ERROR RECOVERY] Synchronized at closing brace\n");
-            return;
-        }
-        if (check_token(p, "D_LBRACE")) {
-            printf("    [ERROR RECOVERY] Synchronized at opening brace\n");
-            return;
-        }
-        // Stop at statement starters
-        if (check_token(p, "R_BILANG") || check_token(p, "R_LUTANG") ||
-            check_token(p, "R_BULYAN") || check_token(p, "R_KWERDAS") ||
-            check_token(p, "K_KUNG") || check_token(p, "K_PARA") ||
-            check_token(p, "K_HABANG") || check_token(p, "K_GAWIN") ||
-            check_token(p, "K_ANI") || check_token(p, "K_TANIM")) {
-            printf("    [ERROR RECOVERY] Synchronized at statement keyword\n");
-            return;
-        }
-        
+// ERROR RECOVERY: Skip tokens until one where parsing within the nonterminal
+// can go on: expected (T_NONE for none) or one in the nonterminal's recovery
+// set (grammar.h), one bit test per skipped token. Stops at the end of input
+// at the latest.
+void synchronize(Parser* p, GrammarNonterminal within, TokenKind expected) {
+    parser_log("    [ERROR RECOVERY] Synchronizing...\n");
+    TokenSet stop = *grammar_recovery(within);
+    if (expected >= 0 && expected < TOKEN_SET_OTHER) token_set_add(&stop, expected);
+    while (p->current_token && !token_set_has(&stop, lookahead_symbol(p->current_token))) {
         advance(p);
-        tokens_skipped++;
     }
-    printf("    [ERROR RECOVERY] Reached synchronization limit\n");
+    if (p->current_token) {
+        parser_log("    [ERROR RECOVERY] Synchronized at %s\n", token_kind_name(p->current_token->kind));
+    } else {
+        parser_log("    [ERROR RECOVERY] Reached end of input\n");
+    }
 }
 
-// ERROR RECOVERY: Skip to end of statement (semicolon or closing brace)
+// ERROR RECOVERY: Skip to end of statement: through its semicolon, or up to
+// the closing brace or the next statement
 void skip_to_statement_end(Parser* p) {
-    printf("    [ERROR RECOVERY] Skipping to statement end...\n");
-    int tokens_skipped = 0;
-    while (peek(p) && tokens_skipped < 50) {
-        if (check_token(p, "D_SEMICOLON")) {
-            advance(p); // consume the semicolon
-            printf("    [ERROR RECOVERY] Found semicolon\n");
-            return;
-        }
-        if (check_token(p, "D_RBRACE")) {
-            printf("    [ERROR RECOVERY] Found closing brace (stopping before it)\n");
-            return;
-        }
-        // Also stop at next statement starter
-        if (check_token(p, "R_BILANG") || check_token(p, "R_LUTANG") ||
-            check_token(p, "R_BULYAN") || check_token(p, "R_KWERDAS") ||
-            check_token(p, "K_KUNG") || check_token(p, "K_PARA") ||
-            check_token(p, "K_HABANG") || check_token(p, "K_GAWIN") ||
-            check_token(p, "K_ANI") || check_token(p, "K_TANIM") ||
-            check_token(p, "D_LBRACE")) {
-            printf("    [ERROR RECOVERY] Found next statement\n");
-            return;
-        }
+    parser_log("    [ERROR RECOVERY] Skipping to statement end...\n");
+    const TokenSet* stop = grammar_recovery(G_STATEMENT);
+    while (p->current_token && !token_set_has(stop, lookahead_symbol(p->current_token))) {
         advance(p);
-        tokens_skipped++;
+    }
+    if (check_token(p, T_D_SEMICOLON)) {
+        advance(p); // consume the semicolon
+        parser_log("    [ERROR RECOVERY] Found semicolon\n");
+    } else if (check_token(p, T_D_RBRACE)) {
+        parser_log("    [ERROR RECOVERY] Found closing brace (stopping before it)\n");
+    } else if (p->current_token) {
+        parser_log("    [ERROR RECOVERY] Found next statement\n");
     }
 }
 
 // ERROR RECOVERY: Skip to matching closing brace
 void skip_to_closing_brace(Parser* p) {
-    printf("    [ERROR RECOVERY] Skipping to closing brace...\n");
+    parser_log("    [ERROR RECOVERY] Skipping to closing brace...\n");
     int brace_count = 1;
-    int tokens_skipped = 0;
-    while (peek(p) && brace_count > 0 && tokens_skipped < 100) {
-        if (check_token(p, "D_LBRACE")) {
+    while (peek(p) && brace_count > 0) {
+        if (check_token(p, T_D_LBRACE)) {
             brace_count++;
-        } else if (check_token(p, "D_RBRACE")) {
+        } else if (check_token(p, T_D_RBRACE)) {
             brace_count--;
             if (brace_count == 0) {
-                printf("    [ERROR RECOVERY] Found matching closing brace\n");
+                parser_log("    [ERROR RECOVERY] Found matching closing brace\n");
                 return;
             }
         }
         advance(p);
-        tokens_skipped++;
     }
-    printf("    [ERROR RECOVERY] Brace matching ended\n");
+    parser_log("    [ERROR RECOVERY] Brace matching ended\n");
 }
 
 // Advance to next token (PDA: POP operation)
 void advance(Parser* p) {
     p->pos++;
     if (p->pos < p->token_count) {
-        p->current_token = &p->tokens[p->pos];
+        p->current_token = read_token(&p->tokens, p->pos, &p->current);
     } else {
         p->current_token = NULL;
     }
 }
 
 // Match token type with ERROR RECOVERY
-ParseTreeNode* match(Parser* p, const char* expected_type) {
+ParseTreeNode* match(Parser* p, TokenKind expected_type) {
     if (check_token(p, expected_type)) {
         // Track the terminal BEFORE advancing
-        match_terminal(expected_type, p->current_token->lexeme);
+        match_terminal(expected_type, p->pos);
         
-        ParseTreeNode* node = create_node(p->current_token->type, p->current_token->lexeme);
+        ParseTreeNode* node = create_token_node(p);
         advance(p);
         return node;
     }
     
     // Handle error...
-    char error_msg[256];
-    sprintf(error_msg, "Expected %s but found %s", expected_type, p->current_token->type);
-    parser_error(p, error_msg);
-    return create_node("ERROR", "");
+    parser_error_expected(p, expected_type);
+    return create_node(p, NODE_ERROR, "");
 }
 
 // Peek at current token
-Token* peek(Parser* p) {
+ParserToken* peek(Parser* p) {
     return p->current_token;
 }
 
 // Check if current token matches type
-bool check_token(Parser* p, const char* type) {
-    return (p->current_token && strcmp(p->current_token->type, type) == 0);
+bool check_token(Parser* p, TokenKind type) {
+    return (p->current_token && p->current_token->kind == type);
 }
 
 // Forward declarations of all parsing functions (PDA states)
@@ -446,7 +359,6 @@ ParseTreeNode* parse_main_function(Parser* p);
 ParseTreeNode* parse_return_type(Parser* p);
 ParseTreeNode* parse_parameter_list(Parser* p);
 ParseTreeNode* parse_function_body(Parser* p);
-ParseTreeNode* parse_statement_list(Parser* p);
 ParseTreeNode* parse_statement(Parser* p);
 ParseTreeNode* parse_declaration(Parser* p);
 ParseTreeNode* parse_data_type(Parser* p);
@@ -455,9 +367,6 @@ ParseTreeNode* parse_identifier_tail(Parser* p);
 ParseTreeNode* parse_assignment_expression(Parser* p);
 ParseTreeNode* parse_assignment(Parser* p);
 ParseTreeNode* parse_expression(Parser* p);
-ParseTreeNode* parse_expression_tail(Parser* p);
-ParseTreeNode* parse_term(Parser* p);
-ParseTreeNode* parse_term_tail(Parser* p);
 ParseTreeNode* parse_factor(Parser* p);
 ParseTreeNode* parse_conditional(Parser* p);
 ParseTreeNode* parse_conditional_tail(Parser* p);
@@ -475,255 +384,281 @@ ParseTreeNode* parse_class_definition(Parser* p);
 
 // ============ HELPERS ============
 // Helper to match with better error recovery
-ParseTreeNode* match_with_recovery(Parser* p, const char* expected, const char* error_msg) {
+ParseTreeNode* match_with_recovery(Parser* p, GrammarNonterminal within, TokenKind expected, DiagnosticCode code) {
     if (peek(p) && check_token(p, expected)) {
         return match(p, expected);
     }
     
-    parser_error(p, error_msg);
-    const char* sync[] = {expected};
-    synchronize(p, sync, 1);
+    parser_error(p, code);
+    synchronize(p, within, expected);
     
     if (peek(p) && check_token(p, expected)) {
         return match(p, expected);
     }
     
     char error_name[64];
-    sprintf(error_name, "missing_%s", expected);
-    return create_node("ERROR", error_name);
+    sprintf(error_name, "missing_%s", token_kind_name(expected));
+    return create_node(p, NODE_ERROR, arena_strdup(&p->nodes, error_name));
 }
 
 // Helper for delimiters (parentheses, braces)
-ParseTreeNode* match_delimiter(Parser* p, const char* delim, const char* error_msg, const char* sync_alt) {
+ParseTreeNode* match_delimiter(Parser* p, GrammarNonterminal within, TokenKind delim, DiagnosticCode code) {
     if (peek(p) && check_token(p, delim)) {
         return match(p, delim);
     }
     
-    parser_error(p, error_msg);
-    const char* sync[] = {delim, sync_alt};
-    synchronize(p, sync, sync_alt ? 2 : 1);
+    parser_error(p, code);
+    synchronize(p, within, delim);
     
     if (peek(p) && check_token(p, delim)) {
         return match(p, delim);
     }
     
-    return create_node("ERROR", "missing_delimiter");
+    return create_node(p, NODE_ERROR, "missing_delimiter");
 }
 
 // Helper for checking multiple token types
-bool check_any(Parser* p, const char* types[], int count) {
+bool check_any(Parser* p, const TokenKind types[], int count) {
     for (int i = 0; i < count; i++) {
         if (check_token(p, types[i])) return true;
     }
     return false;
 }
 
+// Whether the current token can start nonterminal, from its FIRST set
+static bool check_first(Parser* p, GrammarNonterminal nonterminal) {
+    return token_set_has(grammar_first(nonterminal), lookahead_symbol(p->current_token));
+}
+
+// The production the grammar's predict table picks for nonterminal here
+static GrammarProduction predict(Parser* p, GrammarNonterminal nonterminal) {
+    return grammar_choice(nonterminal, lookahead_symbol(p->current_token),
+                          lookahead_symbol(peek_ahead(p, 1)));
+}
+
 
 // ============ PROGRAM STRUCTURE ============
 
 bool parse_program(Parser* p) {
-    printf("\n=== Starting Syntax Analysis (PDA) ===\n");
-    printf("Parsing Program...\n");
-    ParseTreeNode* node = create_node("Program", NULL);
+    parser_log("\n=== Starting Syntax Analysis (PDA) ===\n");
+    parser_log("Parsing Program...\n");
+    ParseTreeNode* node = create_node(p, NODE_PROGRAM, NULL);
     
-    if (peek(p) && (check_token(p, "R_BILANG") || check_token(p, "R_VOID") || 
-                     check_token(p, "R_WALA"))) {
+    if (check_first(p, G_MAIN_FUNCTION)) {
         add_child(node, parse_main_function(p));
-    } else if (peek(p) && check_token(p, "K_PANGKAT")) {
-        while (peek(p) && check_token(p, "K_PANGKAT")) {
+    } else if (peek(p) && check_token(p, T_K_PANGKAT)) {
+        while (peek(p) && check_token(p, T_K_PANGKAT)) {
             add_child(node, parse_class_definition(p));
         }
     } else {
-        parser_error(p, "Expected main function or class definition");
-        // ERROR RECOVERY: Try to find start of a valid construct
-        const char* sync[] = {"R_BILANG", "R_VOID", "R_WALA", "K_PANGKAT"};
-        synchronize(p, sync, 4);
+        parser_error(p, DIAG_EXPECTED_PROGRAM);
+        // ERROR RECOVERY: Try to find start of a valid construct, as what can
+        // follow a class definition: another one or the main function
+        synchronize(p, G_CLASS_DEFINITION, T_NONE);
         if (peek(p)) {
             // Try parsing again after recovery
-            if (check_token(p, "R_BILANG") || check_token(p, "R_VOID") || 
-                check_token(p, "R_WALA")) {
+            if (check_first(p, G_MAIN_FUNCTION)) {
                 add_child(node, parse_main_function(p));
-            } else if (check_token(p, "K_PANGKAT")) {
+            } else if (check_token(p, T_K_PANGKAT)) {
                 add_child(node, parse_class_definition(p));
             }
         }
     }
     
     p->parse_tree = node;
-    printf("Program parsing complete!\n");
-    printf("Total errors found: %d\n", p->error_count);
+    parser_log("Program parsing complete!\n");
+    parser_log("Total errors found: %d\n", p->error_count);
     return (p->error_count == 0);
 }
 
 ParseTreeNode* parse_main_function(Parser* p) {
-    enter_nonterminal("MainFunction", p->current_token->lexeme);
-    printf("  - Parsing Main Function...\n");
-    ParseTreeNode* node = create_node("MainFunction", NULL);
+    enter_nonterminal(G_MAIN_FUNCTION, p->pos);
+    parser_log("  - Parsing Main Function...\n");
+    ParseTreeNode* node = create_node(p, NODE_MAIN_FUNCTION, NULL);
     
     add_child(node, parse_return_type(p));
-    add_child(node, match(p, "R_UGAT"));
-    add_child(node, match(p, "D_LPAREN"));
+    add_child(node, match(p, T_R_UGAT));
+    add_child(node, match(p, T_D_LPAREN));
     add_child(node, parse_parameter_list(p));
-    add_child(node, match(p, "D_RPAREN"));
+    add_child(node, match(p, T_D_RPAREN));
     
     // ERROR RECOVERY: Ensure we have opening brace for function body
-    if (peek(p) && !check_token(p, "D_LBRACE")) {
-        parser_error(p, "Expected '{' to start function body");
-        const char* sync[] = {"D_LBRACE"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LBRACE)) {
+        parser_error(p, DIAG_EXPECTED_BODY);
+        synchronize(p, G_MAIN_FUNCTION, T_D_LBRACE);
     }
     
     add_child(node, parse_function_body(p));
-    printf("  * Main Function complete\n");
+    parser_log("  * Main Function complete\n");
     
-    // SAFETY CHECK: Make sure we have a valid token before accessing it
-    if (p->current_token && p->current_token->lexeme) {
-        exit_nonterminal("MainFunction", p->current_token->lexeme);
-    } else {
-        exit_nonterminal("MainFunction", "EOF");
-    }
+    exit_nonterminal(G_MAIN_FUNCTION, p->pos);
     
     return node;
 }
 
 ParseTreeNode* parse_return_type(Parser* p) {
-    enter_nonterminal("ReturnType", p->current_token->lexeme);
+    enter_nonterminal(G_RETURN_TYPE, p->pos);
 
-    ParseTreeNode* node = create_node("ReturnType", NULL);
-    if (peek(p) && (check_token(p, "R_BILANG") || check_token(p, "R_VOID") || 
-                     check_token(p, "R_WALA"))) {
-        const char* lexeme = p->current_token->lexeme;
-        add_child(node, create_node(p->current_token->type, p->current_token->lexeme));
+    ParseTreeNode* node = create_node(p, NODE_RETURN_TYPE, NULL);
+    if (check_first(p, G_RETURN_TYPE)) {
+        add_child(node, create_token_node(p));
         advance(p);
     } else {
-        parser_error(p, "Expected return type (R_BILANG, R_VOID, or R_WALA)");
+        parser_error(p, DIAG_EXPECTED_RETURN_TYPE);
     }
 
-    exit_nonterminal("ReturnType", p->current_token->lexeme);
+    exit_nonterminal(G_RETURN_TYPE, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_parameter_list(Parser* p) {
-    enter_nonterminal("ParameterList", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("ParameterList", NULL);
+    enter_nonterminal(G_PARAMETER_LIST, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_PARAMETER_LIST, NULL);
 
-    if (peek(p) && check_token(p, "R_KWERDAS")) {
-        add_child(node, match(p, "R_KWERDAS"));
-        add_child(node, match(p, "D_LBRACKET"));
-        add_child(node, match(p, "D_RBRACKET"));
-        add_child(node, match(p, "L_IDENTIFIER"));
+    if (peek(p) && check_token(p, T_R_KWERDAS)) {
+        add_child(node, match(p, T_R_KWERDAS));
+        add_child(node, match(p, T_D_LBRACKET));
+        add_child(node, match(p, T_D_RBRACKET));
+        add_child(node, match(p, T_L_IDENTIFIER));
 
     } else {
-        add_child(node, create_node("ε", "empty"));
+        add_child(node, create_node(p, NODE_EMPTY, "empty"));
     }
 
-    exit_nonterminal("ParameterList", p->current_token->lexeme);
+    exit_nonterminal(G_PARAMETER_LIST, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_function_body(Parser* p) {
-    enter_nonterminal("FunctionBody", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("FunctionBody", NULL);
+    enter_nonterminal(G_FUNCTION_BODY, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_FUNCTION_BODY, NULL);
 
-    add_child(node, match(p, "D_LBRACE"));
+    add_child(node, match(p, T_D_LBRACE));
     add_child(node, parse_statement_list(p));
-    add_child(node, match(p, "D_RBRACE"));
+    add_child(node, match(p, T_D_RBRACE));
 
-    exit_nonterminal("FunctionBody", p->current_token->lexeme);
+    exit_nonterminal(G_FUNCTION_BODY, p->pos);
     return node;
 }
 
 // ============ STATEMENTS ============
 
+// StatementList -> Statement StatementList | ε, one list per statement, each
+// nested in the one before. The lists are made in a loop, not by recursion,
+// so a long block does not take a stack frame per statement.
 ParseTreeNode* parse_statement_list(Parser* p) {
-    
-    enter_nonterminal("StatementList", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("StatementList", NULL);
-    
-    // Check if we've reached end of file or closing brace
-    if (!peek(p) || check_token(p, "D_RBRACE")) {
-        add_child(node, create_node("ε", "empty"));
-        exit_nonterminal("StatementList", p->current_token->lexeme);
-        return node;
-    }
-    
-    if (check_token(p, "R_BILANG") || check_token(p, "R_LUTANG") ||
-        check_token(p, "R_BULYAN") || check_token(p, "R_KWERDAS") ||
-        check_token(p, "L_IDENTIFIER") || check_token(p, "K_KUNG") ||
-        check_token(p, "K_PARA") || check_token(p, "K_HABANG") ||
-        check_token(p, "K_GAWIN") || check_token(p, "K_ANI") ||
-        check_token(p, "K_TANIM")) {
-        
-        // Save position to detect if we're stuck
-        int old_pos = p->pos;
-        
-        add_child(node, parse_statement(p));
-        
-        // Check if we're stuck in infinite recursion
-        if (p->pos == old_pos && peek(p)) {
-            printf("ERROR: Parser stuck at pos %d, skipping token '%s'\n", 
-                   p->pos, p->current_token->lexeme);
-            advance(p); // Force advance to prevent infinite recursion
+    ParseTreeNode* first = NULL;
+    ParseTreeNode* node = NULL;
+    int lists = 0;
+    
+    for (;;) {
+        // An incremental reparse takes a list, or its first statement, whose
+        // tokens the edit left alone over from the previous tree, and notes
+        // down the lists it parses
+        int entry = -1;
+        if (p->incremental) {
+            ParseTreeNode* reused = reuse_statement_list(p);
+            if (reused) {
+                if (node) add_child(node, reused);
+                else first = reused;
+                break;
+            }
         }
         
-        add_child(node, parse_statement_list(p));
-    } else {
+        enter_nonterminal(G_STATEMENT_LIST, p->pos);
+        ParseTreeNode* list = create_node(p, NODE_STATEMENT_LIST, NULL);
+        if (p->incremental) entry = begin_statement_list(p, list);
+        if (node) add_child(node, list);
+        else first = list;
+        node = list;
+        lists++;
         
-        char msg[256];
-        sprintf(msg, "Unexpected token '%s' - expected statement or '}'", 
-                p->current_token->lexeme);
-        parser_error(p, msg);
+        // Check if we've reached end of file or closing brace
+        if (!peek(p) || check_token(p, T_D_RBRACE)) {
+            add_child(node, create_node(p, NODE_EMPTY, "empty"));
+            break;
+        }
         
-        // Skip the bad token and continue
-        advance(p);
-        add_child(node, parse_statement_list(p));
+        if (check_first(p, G_STATEMENT)) {
+            
+            // Save position to detect if we're stuck
+            int old_pos = p->pos;
+            
+            ParseTreeNode* reused = entry >= 0 ? reuse_statement(p, entry) : NULL;
+            add_child(node, reused ? reused : parse_statement(p));
+            
+            // Check if we're stuck in infinite recursion
+            if (p->pos == old_pos && peek(p)) {
+                parser_log("ERROR: Parser stuck at pos %d, skipping token '%s'\n", 
+                       p->pos, p->current_token->lexeme);
+                advance(p); // Force advance to prevent infinite recursion
+            }
+        } else {
+            
+            parser_error(p, DIAG_UNEXPECTED_IN_BLOCK);
+            
+            // Skip the bad tokens, up to the next statement or '}', and continue:
+            // one error for the whole run
+            const TokenSet* resume = grammar_follow(G_STATEMENT);
+            do {
+                advance(p);
+            } while (p->current_token && !token_set_has(resume, lookahead_symbol(p->current_token)));
+        }
     }
     
-    exit_nonterminal("StatementList", p->current_token->lexeme);
-    return node;
+    // The lists end innermost first, all where the block does
+    for (int i = 0; i < lists; i++) exit_nonterminal(G_STATEMENT_LIST, p->pos);
+    if (p->incremental) end_statement_lists(p, lists);
+    return first;
 }
 
 ParseTreeNode* parse_statement(Parser* p) {
 
-    enter_nonterminal("Statement", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("Statement", NULL);
+    enter_nonterminal(G_STATEMENT, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_STATEMENT, NULL);
     
     // ERROR RECOVERY: Check if we have a valid statement starter
     if (!peek(p)) {
-        parser_error(p, "Unexpected end of file in statement");
+        parser_error(p, DIAG_END_IN_STATEMENT);
         return node;
     }
     
-    if (check_token(p, "R_BILANG") || check_token(p, "R_LUTANG") ||
-        check_token(p, "R_BULYAN") || check_token(p, "R_KWERDAS")) {
+    switch (predict(p, G_STATEMENT)) {
+    case P_STATEMENT_DECLARATION:
         add_child(node, parse_declaration(p));
-    } else if (check_token(p, "L_IDENTIFIER")) {
+        break;
+    case P_STATEMENT_ASSIGNMENT:
         add_child(node, parse_assignment(p));
-    } else if (check_token(p, "K_KUNG")) {
+        break;
+    case P_STATEMENT_CONDITIONAL:
         add_child(node, parse_conditional(p));
-    } else if (check_token(p, "K_PARA") || check_token(p, "K_HABANG") || 
-               check_token(p, "K_GAWIN")) {
+        break;
+    case P_STATEMENT_ITERATIVE:
         add_child(node, parse_iterative(p));
-    } else if (check_token(p, "K_ANI")) {
+        break;
+    case P_STATEMENT_PRINT:
         add_child(node, parse_print(p));
-    } else if (check_token(p, "K_TANIM")) {
+        break;
+    case P_STATEMENT_SCAN:
         add_child(node, parse_scan(p));
-    } else {
-        parser_error(p, "Invalid statement - expected declaration, assignment, or control structure");
+        break;
+    default:
+        parser_error(p, DIAG_INVALID_STATEMENT);
         // ERROR RECOVERY: Skip to end of statement
         skip_to_statement_end(p);
-        add_child(node, create_node("ERROR", "invalid_statement"));
+        add_child(node, create_node(p, NODE_ERROR, "invalid_statement"));
+        break;
     }
-    exit_nonterminal("Statement", p->current_token->lexeme);
+    exit_nonterminal(G_STATEMENT, p->pos);
     return node;
 }
 
 // ============ DECLARATION ============
 
 ParseTreeNode* parse_declaration(Parser* p) {
-    enter_nonterminal("Declaration", p->current_token->lexeme);
-    printf("    - Parsing Declaration...\n");
-    ParseTreeNode* node = create_node("Declaration", NULL);
+    enter_nonterminal(G_DECLARATION, p->pos);
+    parser_log("    - Parsing Declaration...\n");
+    ParseTreeNode* node = create_node(p, NODE_DECLARATION, NULL);
 
     int declaration_start_line = p->current_token ? p->current_token->line : 0;
 
@@ -731,129 +666,122 @@ ParseTreeNode* parse_declaration(Parser* p) {
     add_child(node, parse_identifier_list(p));
     
     // ERROR RECOVERY: Check for semicolon
-    if (peek(p) && !check_token(p, "D_SEMICOLON")) {
-        char msg[256];
-        sprintf(msg, "Missing semicolon at end of declaration (expected after line %d)", 
-                declaration_start_line);
-        parser_error(p, msg);        
+    if (peek(p) && !check_token(p, T_D_SEMICOLON)) {
+        parser_error_line(p, DIAG_DECLARATION_SEMICOLON, declaration_start_line);
         
         // Look for semicolon or next statement
-        const char* sync[] = {"D_SEMICOLON", "R_BILANG", "R_LUTANG", "R_BULYAN", 
-                               "R_KWERDAS", "L_IDENTIFIER", "K_KUNG", "K_PARA", 
-                               "K_HABANG", "K_GAWIN", "K_ANI", "K_TANIM", "D_RBRACE"};
-        synchronize(p, sync, 13);
+        synchronize(p, G_DECLARATION, T_D_SEMICOLON);
         
         // If we found a semicolon, consume it
-        if (peek(p) && check_token(p, "D_SEMICOLON")) {
-            add_child(node, match(p, "D_SEMICOLON"));
+        if (peek(p) && check_token(p, T_D_SEMICOLON)) {
+            add_child(node, match(p, T_D_SEMICOLON));
         } else {
             // No semicolon found, add error node and continue
-            add_child(node, create_node("ERROR", "missing_semicolon"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
         }
     } else {
-        add_child(node, match(p, "D_SEMICOLON"));
+        add_child(node, match(p, T_D_SEMICOLON));
     }
 
-    printf("    * Declaration complete\n");
-    exit_nonterminal("Declaration", p->current_token->lexeme);
+    parser_log("    * Declaration complete\n");
+    exit_nonterminal(G_DECLARATION, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_data_type(Parser* p) {
-    enter_nonterminal("DataType", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("DataType", NULL);
-    if (peek(p) && (check_token(p, "R_BILANG") || check_token(p, "R_LUTANG") ||
-                     check_token(p, "R_BULYAN") || check_token(p, "R_KWERDAS"))) {
-        add_child(node, create_node(p->current_token->type, p->current_token->lexeme));
+    enter_nonterminal(G_DATA_TYPE, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_DATA_TYPE, NULL);
+    if (check_first(p, G_DATA_TYPE)) {
+        add_child(node, create_token_node(p));
         advance(p);
     } else {
-        parser_error(p, "Expected data type (R_BILANG, R_LUTANG, R_BULYAN, or R_KWERDAS)");
+        parser_error(p, DIAG_EXPECTED_DATA_TYPE);
         // ERROR RECOVERY: Create error node and try to continue
-        add_child(node, create_node("ERROR", "missing_datatype"));
+        add_child(node, create_node(p, NODE_ERROR, "missing_datatype"));
     }
-    exit_nonterminal("DataType", p->current_token->lexeme);
+    exit_nonterminal(G_DATA_TYPE, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_identifier_list(Parser* p) {
-    enter_nonterminal("IdentifierList", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("IdentifierList", NULL);
-    add_child(node, match(p, "L_IDENTIFIER"));
+    enter_nonterminal(G_IDENTIFIER_LIST, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_IDENTIFIER_LIST, NULL);
+    add_child(node, match(p, T_L_IDENTIFIER));
     
     add_child(node, parse_identifier_tail(p));
-    exit_nonterminal("IdentifierList", p->current_token->lexeme);
+    exit_nonterminal(G_IDENTIFIER_LIST, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_identifier_tail(Parser* p) {
-    enter_nonterminal("IdentifierTail", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("IdentifierTail", NULL);
+    enter_nonterminal(G_IDENTIFIER_TAIL, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_IDENTIFIER_TAIL, NULL);
     
-    if (peek(p) && check_token(p, "D_COMMA")) {
-        add_child(node, match(p, "D_COMMA"));
+    if (peek(p) && check_token(p, T_D_COMMA)) {
+        add_child(node, match(p, T_D_COMMA));
         
-        if (peek(p) && check_token(p, "L_IDENTIFIER")) {
-            add_child(node, match(p, "L_IDENTIFIER"));
+        if (peek(p) && check_token(p, T_L_IDENTIFIER)) {
+            add_child(node, match(p, T_L_IDENTIFIER));
             
             // Check for optional initialization for this identifier
-            if (peek(p) && check_token(p, "O_ASSIGN")) {
-                add_child(node, match(p, "O_ASSIGN"));
+            if (peek(p) && check_token(p, T_O_ASSIGN)) {
+                add_child(node, match(p, T_O_ASSIGN));
                 add_child(node, parse_expression(p));
             }
             
             add_child(node, parse_identifier_tail(p));
         } else {
-            parser_error(p, "Expected identifier after comma");
-            add_child(node, create_node("ERROR", "missing_identifier"));
+            parser_error(p, DIAG_IDENTIFIER_AFTER_COMMA);
+            add_child(node, create_node(p, NODE_ERROR, "missing_identifier"));
         }
     } 
     // ERROR RECOVERY: Check if there's an identifier without comma (missing comma error)
-    else if (peek(p) && check_token(p, "L_IDENTIFIER")) {
-        parser_error(p, "Missing comma between identifiers in declaration");
-        add_child(node, create_node("ERROR", "missing_comma"));
+    else if (peek(p) && check_token(p, T_L_IDENTIFIER)) {
+        parser_error(p, DIAG_MISSING_COMMA);
+        add_child(node, create_node(p, NODE_ERROR, "missing_comma"));
         
-        add_child(node, match(p, "L_IDENTIFIER"));
-        add_child(node, create_node("ε", "empty"));
+        add_child(node, match(p, T_L_IDENTIFIER));
+        add_child(node, create_node(p, NODE_EMPTY, "empty"));
     }
     else {
-        add_child(node, create_node("ε", "empty"));
+        add_child(node, create_node(p, NODE_EMPTY, "empty"));
     }
     
-    exit_nonterminal("IdentifierTail", p->current_token->lexeme);
+    exit_nonterminal(G_IDENTIFIER_TAIL, p->pos);
     return node;
 }
 
 // ============ ASSIGNMENT AND EXPRESSIONS ============
 
 ParseTreeNode* parse_assignment_expression(Parser* p) {
-    enter_nonterminal("AssignmentExpression", p->current_token->lexeme);
+    enter_nonterminal(G_ASSIGNMENT_EXPRESSION, p->pos);
     
     // Check for chained assignment: IDENTIFIER = ...
-    if (check_token(p, "L_IDENTIFIER")) {
+    if (check_token(p, T_L_IDENTIFIER)) {
         // Peek ahead to see if next token is O_ASSIGN
-        Token* next = peek_ahead(p, 1);
+        ParserToken* next = peek_ahead(p, 1);
         
-        if (next && strcmp(next->type, "O_ASSIGN") == 0) {
+        if (next && next->kind == T_O_ASSIGN) {
             // This is an assignment expression
-            ParseTreeNode* node = create_node("AssignmentExpression", NULL);
-            add_child(node, match(p, "L_IDENTIFIER"));
-            add_child(node, match(p, "O_ASSIGN"));
+            ParseTreeNode* node = create_node(p, NODE_ASSIGNMENT_EXPRESSION, NULL);
+            add_child(node, match(p, T_L_IDENTIFIER));
+            add_child(node, match(p, T_O_ASSIGN));
             add_child(node, parse_assignment_expression(p)); // Recursive for chaining
             
-            exit_nonterminal("AssignmentExpression", p->current_token->lexeme);
+            exit_nonterminal(G_ASSIGNMENT_EXPRESSION, p->pos);
             return node;
         }
     }
     
     // Otherwise, parse as regular expression
     ParseTreeNode* expr = parse_expression(p);
-    exit_nonterminal("AssignmentExpression", p->current_token->lexeme);
+    exit_nonterminal(G_ASSIGNMENT_EXPRESSION, p->pos);
     return expr;
 }
 ParseTreeNode* parse_assignment(Parser* p) {
-    enter_nonterminal("Assignment", p->current_token->lexeme);
-    printf("    - Parsing Assignment...\n");
-    ParseTreeNode* node = create_node("Assignment", NULL);
+    enter_nonterminal(G_ASSIGNMENT, p->pos);
+    parser_log("    - Parsing Assignment...\n");
+    ParseTreeNode* node = create_node(p, NODE_ASSIGNMENT, NULL);
     
     int assign_start_line = p->current_token ? p->current_token->line : 0;
     
@@ -861,844 +789,1201 @@ ParseTreeNode* parse_assignment(Parser* p) {
     add_child(node, parse_assignment_expression(p));
     
     // Check for semicolon
-    if (peek(p) && !check_token(p, "D_SEMICOLON")) {
-        char msg[256];
-        sprintf(msg, "Missing semicolon at end of assignment (line %d)", assign_start_line);
-        parser_error(p, msg);
+    if (peek(p) && !check_token(p, T_D_SEMICOLON)) {
+        parser_error_line(p, DIAG_ASSIGNMENT_SEMICOLON, assign_start_line);
         
-        const char* sync[] = {"D_SEMICOLON"};
-        synchronize(p, sync, 1);
+        synchronize(p, G_ASSIGNMENT, T_D_SEMICOLON);
         
-        if (peek(p) && check_token(p, "D_SEMICOLON")) {
-            add_child(node, match(p, "D_SEMICOLON"));
+        if (peek(p) && check_token(p, T_D_SEMICOLON)) {
+            add_child(node, match(p, T_D_SEMICOLON));
         } else {
-            add_child(node, create_node("ERROR", "missing_semicolon"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
         }
     } else {
-        add_child(node, match(p, "D_SEMICOLON"));
+        add_child(node, match(p, T_D_SEMICOLON));
     }
     
-    printf("    * Assignment complete\n");
-    exit_nonterminal("Assignment", p->current_token->lexeme);
+    parser_log("    * Assignment complete\n");
+    exit_nonterminal(G_ASSIGNMENT, p->pos);
     return node;
 }
 
-ParseTreeNode* parse_expression(Parser* p) {
-    enter_nonterminal("Expression", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("Expression", NULL);
-    add_child(node, parse_term(p));
-    add_child(node, parse_expression_tail(p));
-    exit_nonterminal("Expression", p->current_token->lexeme);
+// ============ EXPRESSIONS ============
+// Precedence climbing: a binary operator binds its right operand up to the
+// next operator of lower power, so each precedence level is a loop instead of
+// a pair of mutually recursive Tail functions. Recursion depth grows with
+// parentheses and precedence levels only, never with the expression's length.
+
+static int current_power(Parser* p) {
+    return p->current_token ? binary_power(p->current_token->kind) : 0;
+}
+
+// The operators of the textbook grammar at one of its two levels
+static bool textbook_operator(Parser* p, int power) {
+    if (power == POWER_ADDITIVE) return check_token(p, T_O_PLUS) || check_token(p, T_O_MINUS);
+    return check_token(p, T_O_MULTIPLY) || check_token(p, T_O_DIVIDE);
+}
+
+// An additive operator directly followed by another operator, as in "a + * b"
+static bool double_operator(Parser* p) {
+    if (!textbook_operator(p, POWER_ADDITIVE)) return false;
+    ParserToken* next = peek_ahead(p, 1);
+    return next && (next->kind == T_O_PLUS || next->kind == T_O_MINUS ||
+                    next->kind == T_O_MULTIPLY || next->kind == T_O_DIVIDE);
+}
+
+// Textbook tree for one level of the grammar:
+//   Expression -> Term ExpressionTail, ExpressionTail -> (+|-) Term ExpressionTail | ε
+//   Term -> Factor TermTail,           TermTail -> (*|/) Factor TermTail | ε
+// Tails nest to the right as the grammar derives them but are built in a
+// loop; their EXIT transitions, all at the same lookahead, are logged last.
+static ParseTreeNode* parse_textbook_level(Parser* p, int power) {
+    bool additive = power == POWER_ADDITIVE;
+    GrammarNonterminal name = additive ? G_EXPRESSION : G_TERM;
+    GrammarNonterminal tail_name = additive ? G_EXPRESSION_TAIL : G_TERM_TAIL;
+
+    enter_nonterminal(name, p->pos);
+    ParseTreeNode* node = create_node(p, additive ? NODE_EXPRESSION : NODE_TERM, NULL);
+    add_child(node, additive ? parse_textbook_level(p, POWER_MULTIPLICATIVE) : parse_factor(p));
+
+    ParseTreeNode* parent = node;
+    int tails = 0;
+    for (;;) {
+        enter_nonterminal(tail_name, p->pos);
+        ParseTreeNode* tail = create_node(p, additive ? NODE_EXPRESSION_TAIL : NODE_TERM_TAIL, NULL);
+        add_child(parent, tail);
+        parent = tail;
+        tails++;
+
+        if (additive && double_operator(p)) {
+            parser_error(p, DIAG_CONSECUTIVE_OPERATORS);
+            add_child(tail, create_node(p, NODE_ERROR, "double_operator"));
+            advance(p); // skip the first operator, the second is left to report
+            break;
+        }
+        if (!textbook_operator(p, power)) {
+            add_child(tail, create_node(p, NODE_EMPTY, "empty"));
+            break;
+        }
+        add_child(tail, create_token_node(p));
+        advance(p);
+        add_child(tail, additive ? parse_textbook_level(p, POWER_MULTIPLICATIVE) : parse_factor(p));
+    }
+
+    while (tails-- > 0) exit_nonterminal(tail_name, p->pos);
+    exit_nonterminal(name, p->pos);
     return node;
 }
 
-ParseTreeNode* parse_expression_tail(Parser* p) {
-    enter_nonterminal("ExpressionTail", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("ExpressionTail", NULL);
-    
-    // Lookahead at next token
-    Token* lookahead = p->tokens + (p->pos + 1);
-
-    // If next token starts a TERM incorrectly → ERROR
-    if (lookahead && 
-        (strcmp(lookahead->type, "O_PLUS") == 0 ||
-         strcmp(lookahead->type, "O_MINUS") == 0 ||
-         strcmp(lookahead->type, "O_MULTIPLY") == 0 ||
-         strcmp(lookahead->type, "O_DIVIDE") == 0)) {
+static ParseTreeNode* parse_compact_expression(Parser* p, int min_power);
 
-        parser_error(p, "Unexpected operator - expression cannot contain consecutive operators");
-        add_child(node, create_node("ERROR", "double_operator"));
-        advance(p); // skip the second operator
-        exit_nonterminal("ExpressionTail", p->current_token->lexeme);
+// Compact operand: a prefix operator over its operand, a parenthesized
+// expression (no node for the parentheses) or a Factor's token
+static ParseTreeNode* parse_compact_operand(Parser* p) {
+    if (check_token(p, T_O_NOT) || check_token(p, T_O_MINUS)) {
+        ParseTreeNode* op = create_token_node(p);
+        advance(p);
+        add_child(op, parse_compact_expression(p, POWER_UNARY));
+        return op;
+    }
+
+    switch (predict(p, G_FACTOR)) {
+    case P_FACTOR_IDENTIFIER:
+    case P_FACTOR_BILANG:
+    case P_FACTOR_LUTANG:
+    case P_FACTOR_KWERDAS:
+        return match(p, p->current_token->kind);
+    case P_FACTOR_TAMA:
+    case P_FACTOR_MALI:
+    case P_FACTOR_PI:
+    case P_FACTOR_E_NUM:
+    case P_FACTOR_KISS:
+    case P_FACTOR_SAMPLE: {
+        ParseTreeNode* node = create_token_node(p);
+        advance(p);
         return node;
     }
+    case P_FACTOR_PARENTHESES: {
+        int paren_line = p->current_token->line;
+        match_terminal(T_D_LPAREN, p->pos);
+        advance(p);
+        ParseTreeNode* inner = parse_compact_expression(p, 1);
+        if (check_token(p, T_D_RPAREN)) {
+            match_terminal(T_D_RPAREN, p->pos);
+            advance(p);
+            return inner;
+        }
 
-    if (peek(p) && (check_token(p, "O_PLUS") || check_token(p, "O_MINUS"))) {
-        add_child(node, create_node(p->current_token->type, p->current_token->lexeme));
+        parser_error_line(p, DIAG_UNCLOSED_PARENTHESIS, paren_line);
+        synchronize(p, G_FACTOR, T_D_RPAREN);
+        if (check_token(p, T_D_RPAREN)) advance(p);
+
+        // The error node holds what was parsed inside the parentheses
+        ParseTreeNode* error = create_node(p, NODE_ERROR, "missing_rparen");
+        add_child(error, inner);
+        return error;
+    }
+    default:
+        break;
+    }
+
+    if (current_power(p) > 0) {
+        parser_error(p, DIAG_DOUBLE_OPERATOR);
         advance(p);
-        add_child(node, parse_term(p));
-        add_child(node, parse_expression_tail(p));
-    } 
-    // Check if we hit a semicolon while still in expression (unmatched parenthesis)
-    else if (peek(p) && check_token(p, "D_SEMICOLON")) {
-        // This is normal - expression ends
-        add_child(node, create_node("ε", "empty"));
+        if (peek(p) && !check_token(p, T_D_SEMICOLON) && !check_token(p, T_D_RPAREN)) {
+            return parse_compact_operand(p);
+        }
+        return create_node(p, NODE_ERROR, "unexpected_operator");
     }
-    else {
-        add_child(node, create_node("ε", "empty"));
+    parser_error(p, DIAG_EXPECTED_OPERAND);
+    if (peek(p) && !check_token(p, T_D_SEMICOLON) && !check_token(p, T_D_RPAREN)) {
+        advance(p);
     }
-    exit_nonterminal("ExpressionTail", p->current_token->lexeme);
-    return node;
+    return create_node(p, NODE_ERROR, "invalid_factor");
 }
 
-ParseTreeNode* parse_term(Parser* p) {
-    enter_nonterminal("Term", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("Term", NULL);
-    add_child(node, parse_factor(p));
-    add_child(node, parse_term_tail(p));
-    exit_nonterminal("Term", p->current_token->lexeme);
-    return node;
+// Compact tree of the operators binding at least min_power: left-associative
+// operators climb to power + 1 for their right operand, ^ stays at its own
+static ParseTreeNode* parse_compact_expression(Parser* p, int min_power) {
+    ParseTreeNode* left = parse_compact_operand(p);
+    int power;
+    while ((power = current_power(p)) >= min_power) {
+        ParseTreeNode* op = create_token_node(p);
+        advance(p);
+        add_child(op, left);
+        add_child(op, parse_compact_expression(p, power == POWER_POW ? power : power + 1));
+        left = op;
+    }
+    return left;
 }
 
-ParseTreeNode* parse_term_tail(Parser* p) {
-    enter_nonterminal("TermTail", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("TermTail", NULL);
-    if (peek(p) && (check_token(p, "O_MULTIPLY") || check_token(p, "O_DIVIDE"))) {
-        add_child(node, create_node(p->current_token->type, p->current_token->lexeme));
-        advance(p);
-        add_child(node, parse_factor(p));
-        add_child(node, parse_term_tail(p));
-    } else {
-        add_child(node, create_node("ε", "empty"));
+ParseTreeNode* parse_expression(Parser* p) {
+    if (p->expression_tree == EXPRESSION_TREE_TEXTBOOK) {
+        return parse_textbook_level(p, POWER_ADDITIVE);
     }
-    exit_nonterminal("TermTail", p->current_token->lexeme);
+    enter_nonterminal(G_EXPRESSION, p->pos);
+    ParseTreeNode* node = parse_compact_expression(p, 1);
+    exit_nonterminal(G_EXPRESSION, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_factor(Parser* p) {
-    enter_nonterminal("Factor", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("Factor", NULL);
-
-    if (peek(p) && check_token(p, "L_IDENTIFIER")) {
-        add_child(node, match(p, "L_IDENTIFIER"));
-    } 
-    else if (peek(p) && check_token(p, "L_BILANG_LITERAL")) {
-        add_child(node, match(p, "L_BILANG_LITERAL"));
-    } 
-    else if (peek(p) && check_token(p, "L_LUTANG_LITERAL")) {
-        add_child(node, match(p, "L_LUTANG_LITERAL"));
-    }
-    else if (peek(p) && check_token(p, "L_KWERDAS_LITERAL")) {
-        add_child(node, match(p, "L_KWERDAS_LITERAL"));
-    }
-    else if (peek(p) && (check_token(p, "R_TAMA") || check_token(p, "R_MALI"))) {
-        add_child(node, create_node(p->current_token->type, p->current_token->lexeme));
+    enter_nonterminal(G_FACTOR, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_FACTOR, NULL);
+
+    switch (predict(p, G_FACTOR)) {
+    case P_FACTOR_IDENTIFIER:
+    case P_FACTOR_BILANG:
+    case P_FACTOR_LUTANG:
+    case P_FACTOR_KWERDAS:
+        add_child(node, match(p, p->current_token->kind));
+        break;
+    case P_FACTOR_TAMA:
+    case P_FACTOR_MALI:
+    case P_FACTOR_PI:
+    case P_FACTOR_E_NUM:
+    case P_FACTOR_KISS:
+    case P_FACTOR_SAMPLE:
+        add_child(node, create_token_node(p));
         advance(p);
-    }
-    else if (peek(p) && (check_token(p, "R_PI") || check_token(p, "R_E_NUM"),
-                        check_token(p, "R_Kiss") || check_token(p, "R_SAMPLE_CONST_STRING"))) {
-        add_child(node,  create_node(p->current_token->type, p->current_token->lexeme));
-    }
-    else if (peek(p) && check_token(p, "D_LPAREN")) {
+        break;
+    case P_FACTOR_PARENTHESES: {
         int paren_line = p->current_token->line;
-        add_child(node, match(p, "D_LPAREN"));
+        add_child(node, match(p, T_D_LPAREN));
         add_child(node, parse_expression(p));
         
         // ERROR RECOVERY: Check for closing parenthesis
-        if (peek(p) && !check_token(p, "D_RPAREN")) {
-            char msg[256];
-            sprintf(msg, "Missing closing parenthesis ')' for '(' on line %d", paren_line);
-            parser_error(p, msg);
+        if (peek(p) && !check_token(p, T_D_RPAREN)) {
+            parser_error_line(p, DIAG_UNCLOSED_PARENTHESIS, paren_line);
             
             // Look for closing paren or semicolon
-            const char* sync[] = {"D_RPAREN", "D_SEMICOLON"};
-            synchronize(p, sync, 2);
+            synchronize(p, G_FACTOR, T_D_RPAREN);
             
-            if (peek(p) && check_token(p, "D_RPAREN")) {
-                add_child(node, match(p, "D_RPAREN"));
+            if (peek(p) && check_token(p, T_D_RPAREN)) {
+                add_child(node, match(p, T_D_RPAREN));
             } else {
-                add_child(node, create_node("ERROR", "missing_rparen"));
-                printf("    [ERROR RECOVERY] Could not find closing paren, continuing...\n");
+                add_child(node, create_node(p, NODE_ERROR, "missing_rparen"));
+                parser_log("    [ERROR RECOVERY] Could not find closing paren, continuing...\n");
             }
         } else {
-            add_child(node, match(p, "D_RPAREN"));
-        }
-    } 
-    else if (peek(p) && (check_token(p, "O_PLUS") || check_token(p, "O_MINUS") ||
-                          check_token(p, "O_MULTIPLY") || check_token(p, "O_DIVIDE"))) {
-        parser_error(p, "Unexpected operator in expression (possible double operator)");
-        add_child(node, create_node("ERROR", "unexpected_operator"));
-        advance(p);
-        
-        if (peek(p) && !check_token(p, "D_SEMICOLON") && !check_token(p, "D_RPAREN")) {
-            return parse_factor(p);
+            add_child(node, match(p, T_D_RPAREN));
         }
+        break;
     }
-    else {
-        parser_error(p, "Expected identifier, literal, constant, or '(' in expression");
-        add_child(node, create_node("ERROR", "invalid_factor"));
-        if (peek(p) && !check_token(p, "D_SEMICOLON") && !check_token(p, "D_RPAREN")) {
+    default:
+        if (peek(p) && (check_token(p, T_O_PLUS) || check_token(p, T_O_MINUS) ||
+                        check_token(p, T_O_MULTIPLY) || check_token(p, T_O_DIVIDE))) {
+            parser_error(p, DIAG_DOUBLE_OPERATOR);
+            add_child(node, create_node(p, NODE_ERROR, "unexpected_operator"));
             advance(p);
+            
+            if (peek(p) && !check_token(p, T_D_SEMICOLON) && !check_token(p, T_D_RPAREN)) {
+                return parse_factor(p);
+            }
+        } else {
+            parser_error(p, DIAG_EXPECTED_OPERAND);
+            add_child(node, create_node(p, NODE_ERROR, "invalid_factor"));
+            if (peek(p) && !check_token(p, T_D_SEMICOLON) && !check_token(p, T_D_RPAREN)) {
+                advance(p);
+            }
         }
+        break;
     }
-    exit_nonterminal("Factor", p->current_token->lexeme);
+    exit_nonterminal(G_FACTOR, p->pos);
     return node;
 }
 
 // ============ CONDITIONALS ============
 
 ParseTreeNode* parse_conditional(Parser* p) {
-    enter_nonterminal("Conditional", p->current_token->lexeme);
-    printf("    - Parsing Conditional...\n");
-    ParseTreeNode* node = create_node("Conditional", NULL);
-    add_child(node, match(p, "K_KUNG"));
-    add_child(node, match(p, "D_LPAREN"));
+    enter_nonterminal(G_CONDITIONAL, p->pos);
+    parser_log("    - Parsing Conditional...\n");
+    ParseTreeNode* node = create_node(p, NODE_CONDITIONAL, NULL);
+    add_child(node, match(p, T_K_KUNG));
+    add_child(node, match(p, T_D_LPAREN));
     add_child(node, parse_boolean_expression(p));
     
     // ERROR RECOVERY: Check for closing parenthesis
-    if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Missing ')' after condition");
-        const char* sync[] = {"D_RPAREN", "D_LBRACE"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_CONDITION_RPAREN);
+        synchronize(p, G_CONDITIONAL, T_D_RPAREN);
 
-        if (peek(p) && check_token(p, "D_RPAREN")) {
-            add_child(node, match(p, "D_RPAREN"));
+        if (peek(p) && check_token(p, T_D_RPAREN)) {
+            add_child(node, match(p, T_D_RPAREN));
         } else {
-            add_child(node, create_node("ERROR", "missing_rparen"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_rparen"));
         }
     } else {
-        add_child(node, match(p, "D_RPAREN"));
+        add_child(node, match(p, T_D_RPAREN));
     }
     
     // ERROR RECOVERY: Check for opening brace
-    if (peek(p) && !check_token(p, "D_LBRACE")) {
-        parser_error(p, "Missing '{' after condition");
+    if (peek(p) && !check_token(p, T_D_LBRACE)) {
+        parser_error(p, DIAG_CONDITION_LBRACE);
         
         // Skip until we find a statement or closing brace
         // Parse the orphan statement but don't expect braces
-        add_child(node, create_node("ERROR", "missing_lbrace"));
+        add_child(node, create_node(p, NODE_ERROR, "missing_lbrace"));
         
         // If the next token is a statement starter, parse ONE statement only
-        if (peek(p) && (check_token(p, "K_ANI") || check_token(p, "K_TANIM") || 
-                         check_token(p, "L_IDENTIFIER") || check_token(p, "R_BILANG"))) {
+        if (peek(p) && (check_token(p, T_K_ANI) || check_token(p, T_K_TANIM) || 
+                         check_token(p, T_L_IDENTIFIER) || check_token(p, T_R_BILANG))) {
             add_child(node, parse_statement(p));
         }
         
         // If there's a closing brace, consume it
-        if (peek(p) && check_token(p, "D_RBRACE")) {
-            add_child(node, match(p, "D_RBRACE"));
+        if (peek(p) && check_token(p, T_D_RBRACE)) {
+            add_child(node, match(p, T_D_RBRACE));
         } else {
-            add_child(node, create_node("ERROR", "missing_rbrace"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_rbrace"));
         }
         
         add_child(node, parse_conditional_tail(p));
-        printf("    * Conditional complete (with errors)\n");
+        parser_log("    * Conditional complete (with errors)\n");
         return node;
     }
     
-    add_child(node, match(p, "D_LBRACE"));
+    add_child(node, match(p, T_D_LBRACE));
     add_child(node, parse_statement_list(p));
     
     // ERROR RECOVERY: Check for closing brace
-    if (peek(p) && !check_token(p, "D_RBRACE")) {
-        parser_error(p, "Missing '}' at end of if block");
-        const char* sync[] = {"D_RBRACE", "K_KUNDI", "K_KUNDIMAN"};
-        synchronize(p, sync, 3);
+    if (peek(p) && !check_token(p, T_D_RBRACE)) {
+        parser_error(p, DIAG_IF_RBRACE);
+        synchronize(p, G_CONDITIONAL, T_D_RBRACE);
         
-        if (peek(p) && check_token(p, "D_RBRACE")) {
-            add_child(node, match(p, "D_RBRACE"));
+        if (peek(p) && check_token(p, T_D_RBRACE)) {
+            add_child(node, match(p, T_D_RBRACE));
         } else {
-            add_child(node, create_node("ERROR", "missing_rbrace"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_rbrace"));
         }
     } else {
-        add_child(node, match(p, "D_RBRACE"));
+        add_child(node, match(p, T_D_RBRACE));
     }
     
     add_child(node, parse_conditional_tail(p));
-    printf("    * Conditional complete\n");
-    exit_nonterminal("Conditional", p->current_token->lexeme);
+    parser_log("    * Conditional complete\n");
+    exit_nonterminal(G_CONDITIONAL, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_conditional_tail(Parser* p) {
-    enter_nonterminal("ConditionalTail", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("ConditionalTail", NULL);
-    if (peek(p) && check_token(p, "K_KUNDI")) {
-        add_child(node, match(p, "K_KUNDI"));
-        add_child(node, match(p, "D_LBRACE"));
+    enter_nonterminal(G_CONDITIONAL_TAIL, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_CONDITIONAL_TAIL, NULL);
+    if (peek(p) && check_token(p, T_K_KUNDI)) {
+        add_child(node, match(p, T_K_KUNDI));
+        add_child(node, match(p, T_D_LBRACE));
         add_child(node, parse_statement_list(p));
-        add_child(node, match(p, "D_RBRACE"));
-    } else if (peek(p) && check_token(p, "K_KUNDIMAN")) {
-        add_child(node, match(p, "K_KUNDIMAN"));
-        add_child(node, match(p, "D_LPAREN"));
+        add_child(node, match(p, T_D_RBRACE));
+    } else if (peek(p) && check_token(p, T_K_KUNDIMAN)) {
+        add_child(node, match(p, T_K_KUNDIMAN));
+        add_child(node, match(p, T_D_LPAREN));
         add_child(node, parse_boolean_expression(p));
-        add_child(node, match(p, "D_RPAREN"));
-        add_child(node, match(p, "D_LBRACE"));
+        add_child(node, match(p, T_D_RPAREN));
+        add_child(node, match(p, T_D_LBRACE));
         add_child(node, parse_statement_list(p));
-        add_child(node, match(p, "D_RBRACE"));
+        add_child(node, match(p, T_D_RBRACE));
         add_child(node, parse_conditional_tail(p));
     } else {
-        add_child(node, create_node("ε", "empty"));
+        add_child(node, create_node(p, NODE_EMPTY, "empty"));
     }
-    exit_nonterminal("ConditionalTail", p->current_token->lexeme);
+    exit_nonterminal(G_CONDITIONAL_TAIL, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_boolean_expression(Parser* p) {
-    enter_nonterminal("BooleanExpression", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("BooleanExpression", NULL);
-    add_child(node, parse_expression(p));
-    add_child(node, parse_relop(p));
+    enter_nonterminal(G_BOOLEAN_EXPRESSION, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_BOOLEAN_EXPRESSION, NULL);
     add_child(node, parse_expression(p));
-    exit_nonterminal("BooleanExpression", p->current_token->lexeme);
+    // A compact expression takes the relational and logical operators itself
+    if (p->expression_tree == EXPRESSION_TREE_TEXTBOOK) {
+        add_child(node, parse_relop(p));
+        add_child(node, parse_expression(p));
+    }
+    exit_nonterminal(G_BOOLEAN_EXPRESSION, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_relop(Parser* p) {
-    enter_nonterminal("RelOp", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("RelOp", NULL);
-    if (peek(p) && (check_token(p, "O_EQUAL") || check_token(p, "O_NOT_EQUAL") ||
-                     check_token(p, "O_GREATER") || check_token(p, "O_LESS") ||
-                     check_token(p, "O_GREATER_EQ") || check_token(p, "O_LESS_EQ"))) {
-        add_child(node, create_node(p->current_token->type, p->current_token->lexeme));
+    enter_nonterminal(G_RELOP, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_RELOP, NULL);
+    if (check_first(p, G_RELOP)) {
+        add_child(node, create_token_node(p));
         advance(p);
     } else {
-        parser_error(p, "Expected relational operator");
+        parser_error(p, DIAG_EXPECTED_RELOP);
     }
-    exit_nonterminal("RelOp", p->current_token->lexeme);
+    exit_nonterminal(G_RELOP, p->pos);
     return node;
 }
 
 // ============ ITERATIONS/LOOPS ============
 
 ParseTreeNode* parse_iterative(Parser* p) {
-    enter_nonterminal("Iterative", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("Iterative", NULL);
-    if (check_token(p, "K_PARA")) {
+    enter_nonterminal(G_ITERATIVE, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_ITERATIVE, NULL);
+    switch (predict(p, G_ITERATIVE)) {
+    case P_ITERATIVE_FOR:
         add_child(node, parse_for_loop(p));
-    } else if (check_token(p, "K_HABANG")) {
+        break;
+    case P_ITERATIVE_WHILE:
         add_child(node, parse_while_loop(p));
-    } else if (check_token(p, "K_GAWIN")) {
+        break;
+    case P_ITERATIVE_DO_WHILE:
         add_child(node, parse_do_while_loop(p));
+        break;
+    default:
+        break;
     }
-    exit_nonterminal("Iterative", p->current_token->lexeme);
+    exit_nonterminal(G_ITERATIVE, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_for_loop(Parser* p) {
-    enter_nonterminal("ForLoop", p->current_token->lexeme);
-    printf("    - Parsing For Loop...\n");
-    ParseTreeNode* node = create_node("ForLoop", NULL);
-    add_child(node, match(p, "K_PARA"));
+    enter_nonterminal(G_FOR_LOOP, p->pos);
+    parser_log("    - Parsing For Loop...\n");
+    ParseTreeNode* node = create_node(p, NODE_FOR_LOOP, NULL);
+    add_child(node, match(p, T_K_PARA));
 
-    if (peek(p) && !check_token(p, "D_LPAREN")) {
-        parser_error(p, "Missing '(' after 'para'");
-        const char* sync[] = {"D_LPAREN"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LPAREN)) {
+        parser_error(p, DIAG_FOR_LPAREN);
+        synchronize(p, G_FOR_LOOP, T_D_LPAREN);
     }
 
-    add_child(node, match(p, "D_LPAREN"));
+    add_child(node, match(p, T_D_LPAREN));
     
     // Parse initialization
-    if (check_token(p, "R_BILANG") || check_token(p, "R_LUTANG") ||
-        check_token(p, "R_BULYAN") || check_token(p, "R_KWERDAS")) {
+    if (check_first(p, G_DECLARATION)) {
         add_child(node, parse_declaration(p));
-    } else if (peek(p) && check_token(p, "L_IDENTIFIER")) {
-        ParseTreeNode* assign = create_node("Assignment", NULL);
-        add_child(assign, match(p, "L_IDENTIFIER"));
-        add_child(assign, match(p, "O_ASSIGN"));
+    } else if (peek(p) && check_token(p, T_L_IDENTIFIER)) {
+        ParseTreeNode* assign = create_node(p, NODE_ASSIGNMENT, NULL);
+        add_child(assign, match(p, T_L_IDENTIFIER));
+        add_child(assign, match(p, T_O_ASSIGN));
         add_child(assign, parse_expression(p));
-        add_child(assign, match(p, "D_SEMICOLON"));
+        add_child(assign, match(p, T_D_SEMICOLON));
         add_child(node, assign);
     } else {
-        parser_error(p, "Expected initialization in for loop");
-        add_child(node, create_node("ERROR", "missing_init"));
+        parser_error(p, DIAG_FOR_INIT);
+        add_child(node, create_node(p, NODE_ERROR, "missing_init"));
     }
 
     // Parse condition - Try to detect if semicolon is missing
-    ParseTreeNode* condition = create_node("BooleanExpression", NULL);
+    ParseTreeNode* condition = create_node(p, NODE_BOOLEAN_EXPRESSION, NULL);
     
     // Parse left side of condition
-    if (peek(p) && check_token(p, "L_IDENTIFIER")) {
+    if (peek(p) && check_token(p, T_L_IDENTIFIER)) {
         add_child(condition, parse_expression(p));
         
-        // Check for relational operator
-        if (peek(p) && (check_token(p, "O_EQUAL") || check_token(p, "O_NOT_EQUAL") ||
-                         check_token(p, "O_GREATER") || check_token(p, "O_LESS") ||
-                         check_token(p, "O_GREATER_EQ") || check_token(p, "O_LESS_EQ"))) {
-            add_child(condition, parse_relop(p));
-            add_child(condition, parse_expression(p));
-        } else {
-            parser_error(p, "Expected relational operator in condition");
-            add_child(condition, create_node("ERROR", "missing_relop"));
+        // Check for relational operator (a compact expression includes it)
+        if (p->expression_tree == EXPRESSION_TREE_TEXTBOOK) {
+            if (check_first(p, G_RELOP)) {
+                add_child(condition, parse_relop(p));
+                add_child(condition, parse_expression(p));
+            } else {
+                parser_error(p, DIAG_FOR_RELOP);
+                add_child(condition, create_node(p, NODE_ERROR, "missing_relop"));
+            }
         }
     } else {
-        parser_error(p, "Expected condition in for loop");
-        add_child(condition, create_node("ERROR", "missing_condition"));
+        parser_error(p, DIAG_FOR_CONDITION);
+        add_child(condition, create_node(p, NODE_ERROR, "missing_condition"));
     }
     
     add_child(node, condition);
     
     // Check for semicolon after condition
-    if (peek(p) && !check_token(p, "D_SEMICOLON")) {
-        parser_error(p, "Missing ';' after for loop condition");
+    if (peek(p) && !check_token(p, T_D_SEMICOLON)) {
+        parser_error(p, DIAG_FOR_SEMICOLON);
         
         // Try to detect if we're already at the increment part
         // If we see an identifier that looks like increment (not relop), we're missing semicolon
-        if (peek(p) && check_token(p, "L_IDENTIFIER")) {
-            printf("    [ERROR RECOVERY] Detected missing semicolon before increment\n");
+        if (peek(p) && check_token(p, T_L_IDENTIFIER)) {
+            parser_log("    [ERROR RECOVERY] Detected missing semicolon before increment\n");
             // Don't skip anything, just note the error and continue
-            add_child(node, create_node("ERROR", "missing_semicolon"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
         } else {
             // Otherwise try to find semicolon
-            const char* sync[] = {"D_SEMICOLON"};
-            synchronize(p, sync, 1);
-            if (peek(p) && check_token(p, "D_SEMICOLON")) {
-                add_child(node, match(p, "D_SEMICOLON"));
+            synchronize(p, G_FOR_LOOP, T_D_SEMICOLON);
+            if (peek(p) && check_token(p, T_D_SEMICOLON)) {
+                add_child(node, match(p, T_D_SEMICOLON));
             } else {
-                add_child(node, create_node("ERROR", "missing_semicolon"));
+                add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
             }
         }
     } else {
-        add_child(node, match(p, "D_SEMICOLON"));
+        add_child(node, match(p, T_D_SEMICOLON));
     }
     
     // Parse increment
-    if (peek(p) && check_token(p, "L_IDENTIFIER")) {
-        ParseTreeNode* incr = create_node("Assignment", NULL);
-        add_child(incr, match(p, "L_IDENTIFIER"));
+    if (peek(p) && check_token(p, T_L_IDENTIFIER)) {
+        ParseTreeNode* incr = create_node(p, NODE_ASSIGNMENT, NULL);
+        add_child(incr, match(p, T_L_IDENTIFIER));
         
-        if (peek(p) && check_token(p, "O_ASSIGN")) {
-            add_child(incr, match(p, "O_ASSIGN"));
+        if (peek(p) && check_token(p, T_O_ASSIGN)) {
+            add_child(incr, match(p, T_O_ASSIGN));
             add_child(incr, parse_expression(p));
         } else {
-            parser_error(p, "Expected '=' in for loop increment");
-            add_child(incr, create_node("ERROR", "missing_assign"));
+            parser_error(p, DIAG_FOR_ASSIGN);
+            add_child(incr, create_node(p, NODE_ERROR, "missing_assign"));
         }
         add_child(node, incr);
-    } else if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Expected increment expression in for loop");
-        add_child(node, create_node("ERROR", "missing_increment"));
+    } else if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_FOR_INCREMENT);
+        add_child(node, create_node(p, NODE_ERROR, "missing_increment"));
         // Skip to closing paren
-        const char* sync[] = {"D_RPAREN"};
-        synchronize(p, sync, 1);
+        synchronize(p, G_FOR_LOOP, T_D_RPAREN);
     } else {
         // Empty increment is technically ok, just add placeholder
-        add_child(node, create_node("EmptyIncrement", ""));
+        add_child(node, create_node(p, NODE_EMPTY_INCREMENT, ""));
     }
     
     // Check for closing parenthesis
-    if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Missing ')' in for loop header");
-        const char* sync[] = {"D_RPAREN", "D_LBRACE"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_FOR_RPAREN);
+        synchronize(p, G_FOR_LOOP, T_D_RPAREN);
     }
     
-    if (peek(p) && check_token(p, "D_RPAREN")) {
-        add_child(node, match(p, "D_RPAREN"));
+    if (peek(p) && check_token(p, T_D_RPAREN)) {
+        add_child(node, match(p, T_D_RPAREN));
     } else {
-        add_child(node, create_node("ERROR", "missing_rparen"));
+        add_child(node, create_node(p, NODE_ERROR, "missing_rparen"));
     }
     
     // Parse body
-    if (peek(p) && !check_token(p, "D_LBRACE")) {
-        parser_error(p, "Missing '{' for for loop body");
-        const char* sync[] = {"D_LBRACE"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LBRACE)) {
+        parser_error(p, DIAG_FOR_LBRACE);
+        synchronize(p, G_FOR_LOOP, T_D_LBRACE);
     }
     
-    if (peek(p) && check_token(p, "D_LBRACE")) {
-        add_child(node, match(p, "D_LBRACE"));
+    if (peek(p) && check_token(p, T_D_LBRACE)) {
+        add_child(node, match(p, T_D_LBRACE));
         add_child(node, parse_statement_list(p));
         
-        if (peek(p) && !check_token(p, "D_RBRACE")) {
-            parser_error(p, "Missing '}' at end of for loop");
-            const char* sync[] = {"D_RBRACE"};
-            synchronize(p, sync, 1);
+        if (peek(p) && !check_token(p, T_D_RBRACE)) {
+            parser_error(p, DIAG_FOR_RBRACE);
+            synchronize(p, G_FOR_LOOP, T_D_RBRACE);
         }
         
-        if (peek(p) && check_token(p, "D_RBRACE")) {
-            add_child(node, match(p, "D_RBRACE"));
+        if (peek(p) && check_token(p, T_D_RBRACE)) {
+            add_child(node, match(p, T_D_RBRACE));
         } else {
-            add_child(node, create_node("ERROR", "missing_rbrace"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_rbrace"));
         }
     }
     
-    printf("    * For Loop complete\n");
-    exit_nonterminal("ForLoop", p->current_token->lexeme);
+    parser_log("    * For Loop complete\n");
+    exit_nonterminal(G_FOR_LOOP, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_while_loop(Parser* p) {
-    enter_nonterminal("WhileLoop", p->current_token->lexeme);
-    printf("    - Parsing While Loop...\n");
-    ParseTreeNode* node = create_node("WhileLoop", NULL);
-    add_child(node, match(p, "K_HABANG"));
-    add_child(node, match(p, "D_LPAREN"));
+    enter_nonterminal(G_WHILE_LOOP, p->pos);
+    parser_log("    - Parsing While Loop...\n");
+    ParseTreeNode* node = create_node(p, NODE_WHILE_LOOP, NULL);
+    add_child(node, match(p, T_K_HABANG));
+    add_child(node, match(p, T_D_LPAREN));
     add_child(node, parse_boolean_expression(p));
     
     // ERROR RECOVERY: Check for closing parenthesis
-    if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Missing ')' after while condition");
-        const char* sync[] = {"D_RPAREN", "D_LBRACE"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_WHILE_RPAREN);
+        synchronize(p, G_WHILE_LOOP, T_D_RPAREN);
     }
     
-    add_child(node, match(p, "D_RPAREN"));
+    add_child(node, match(p, T_D_RPAREN));
     
     // ERROR RECOVERY: Check for loop body
-    if (peek(p) && !check_token(p, "D_LBRACE")) {
-        parser_error(p, "Missing '{' for while loop body");
-        const char* sync[] = {"D_LBRACE"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LBRACE)) {
+        parser_error(p, DIAG_WHILE_LBRACE);
+        synchronize(p, G_WHILE_LOOP, T_D_LBRACE);
     }
     
-    add_child(node, match(p, "D_LBRACE"));
+    add_child(node, match(p, T_D_LBRACE));
     add_child(node, parse_statement_list(p));
     
     // ERROR RECOVERY: Check for closing brace
-    if (peek(p) && !check_token(p, "D_RBRACE")) {
-        parser_error(p, "Missing '}' at end of while loop");
+    if (peek(p) && !check_token(p, T_D_RBRACE)) {
+        parser_error(p, DIAG_WHILE_RBRACE);
         skip_to_closing_brace(p);
     }
     
-    add_child(node, match(p, "D_RBRACE"));
-    printf("    * While Loop complete\n");
-    exit_nonterminal("WhileLoop", p->current_token->lexeme);
+    add_child(node, match(p, T_D_RBRACE));
+    parser_log("    * While Loop complete\n");
+    exit_nonterminal(G_WHILE_LOOP, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_do_while_loop(Parser* p) {
-    enter_nonterminal("DoWhileLoop", p->current_token->lexeme);
-    printf("    * Parsing Do-While Loop...\n");
-    ParseTreeNode* node = create_node("DoWhileLoop", NULL);
-    add_child(node, match(p, "K_GAWIN"));
+    enter_nonterminal(G_DO_WHILE_LOOP, p->pos);
+    parser_log("    * Parsing Do-While Loop...\n");
+    ParseTreeNode* node = create_node(p, NODE_DO_WHILE_LOOP, NULL);
+    add_child(node, match(p, T_K_GAWIN));
     
     // ERROR RECOVERY: Check for opening brace
-    if (peek(p) && !check_token(p, "D_LBRACE")) {
-        parser_error(p, "Missing '{' after 'gawin'");
-        const char* sync[] = {"D_LBRACE"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LBRACE)) {
+        parser_error(p, DIAG_DO_LBRACE);
+        synchronize(p, G_DO_WHILE_LOOP, T_D_LBRACE);
     }
     
-    add_child(node, match(p, "D_LBRACE"));
+    add_child(node, match(p, T_D_LBRACE));
     add_child(node, parse_statement_list(p));
     
     // ERROR RECOVERY: Check for closing brace
-    if (peek(p) && !check_token(p, "D_RBRACE")) {
-        parser_error(p, "Missing '}' in do-while loop");
-        const char* sync[] = {"D_RBRACE", "K_HABANG"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RBRACE)) {
+        parser_error(p, DIAG_DO_RBRACE);
+        synchronize(p, G_DO_WHILE_LOOP, T_D_RBRACE);
     }
     
-    add_child(node, match(p, "D_RBRACE"));
+    add_child(node, match(p, T_D_RBRACE));
     
     // ERROR RECOVERY: Check for 'habang' keyword
-    if (peek(p) && !check_token(p, "K_HABANG")) {
-        parser_error(p, "Expected 'habang' after do-while body");
-        const char* sync[] = {"K_HABANG"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_K_HABANG)) {
+        parser_error(p, DIAG_DO_HABANG);
+        synchronize(p, G_DO_WHILE_LOOP, T_K_HABANG);
     }
     
-    add_child(node, match(p, "K_HABANG"));
-    add_child(node, match(p, "D_LPAREN"));
+    add_child(node, match(p, T_K_HABANG));
+    add_child(node, match(p, T_D_LPAREN));
     add_child(node, parse_boolean_expression(p));
     
     // ERROR RECOVERY: Check for closing parenthesis
-    if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Missing ')' in do-while condition");
-        const char* sync[] = {"D_RPAREN", "D_SEMICOLON"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_DO_RPAREN);
+        synchronize(p, G_DO_WHILE_LOOP, T_D_RPAREN);
     }
 
     // SAVE THE LINE NUMBER HERE - before matching the closing paren
     int statement_end_line = p->current_token ? p->current_token->line : 0;
     
-    add_child(node, match(p, "D_RPAREN"));
+    add_child(node, match(p, T_D_RPAREN));
     
     // ERROR RECOVERY: Check for semicolon
-    if (peek(p) && !check_token(p, "D_SEMICOLON")) {
-        // Create error message with the SAVED line number
-        char msg[256];
-        sprintf(msg, "Missing ';' at end of do-while statement (expected after line %d)", 
-                statement_end_line);
-        parser_error(p, msg);
+    if (peek(p) && !check_token(p, T_D_SEMICOLON)) {
+        // Report it with the SAVED line number
+        parser_error_line(p, DIAG_DO_SEMICOLON, statement_end_line);
         
-        const char* sync[] = {"D_SEMICOLON"};
-        synchronize(p, sync, 1);
+        synchronize(p, G_DO_WHILE_LOOP, T_D_SEMICOLON);
         
-        if (peek(p) && check_token(p, "D_SEMICOLON")) {
-            add_child(node, match(p, "D_SEMICOLON"));
+        if (peek(p) && check_token(p, T_D_SEMICOLON)) {
+            add_child(node, match(p, T_D_SEMICOLON));
         } else {
-            add_child(node, create_node("ERROR", "missing_semicolon"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
         }
     } else {
-        add_child(node, match(p, "D_SEMICOLON"));
+        add_child(node, match(p, T_D_SEMICOLON));
     }
     
-    printf("    * Do-While Loop complete\n");
-    exit_nonterminal("DoWhileLoop", p->current_token->lexeme);
+    parser_log("    * Do-While Loop complete\n");
+    exit_nonterminal(G_DO_WHILE_LOOP, p->pos);
     return node;
 }
 
 // ============ INPUT/OUTPUT ============
 
 ParseTreeNode* parse_print(Parser* p) {
-    enter_nonterminal("Print", p->current_token->lexeme);
-    printf("    - Parsing Print...\n");
-    ParseTreeNode* node = create_node("Print", NULL);
-    add_child(node, match(p, "K_ANI"));
+    enter_nonterminal(G_PRINT, p->pos);
+    parser_log("    - Parsing Print...\n");
+    ParseTreeNode* node = create_node(p, NODE_PRINT, NULL);
+    add_child(node, match(p, T_K_ANI));
     
     // ERROR RECOVERY: Check for opening parenthesis
-    if (peek(p) && !check_token(p, "D_LPAREN")) {
-        parser_error(p, "Missing '(' after 'ani'");
-        const char* sync[] = {"D_LPAREN"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LPAREN)) {
+        parser_error(p, DIAG_PRINT_LPAREN);
+        synchronize(p, G_PRINT, T_D_LPAREN);
     }
     
-    add_child(node, match(p, "D_LPAREN"));
+    add_child(node, match(p, T_D_LPAREN));
     add_child(node, parse_print_args(p));
     
     // ERROR RECOVERY: Check for closing parenthesis
-    if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Missing ')' in print statement");
-        const char* sync[] = {"D_RPAREN", "D_SEMICOLON"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_PRINT_RPAREN);
+        synchronize(p, G_PRINT, T_D_RPAREN);
         
-        if (peek(p) && check_token(p, "D_RPAREN")) {
-            add_child(node, match(p, "D_RPAREN"));
+        if (peek(p) && check_token(p, T_D_RPAREN)) {
+            add_child(node, match(p, T_D_RPAREN));
         } else {
-            add_child(node, create_node("ERROR", "missing_rparen"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_rparen"));
         }
     } else {
-        add_child(node, match(p, "D_RPAREN"));
+        add_child(node, match(p, T_D_RPAREN));
     }
     
     // ERROR RECOVERY: Check for semicolon
-    if (peek(p) && !check_token(p, "D_SEMICOLON")) {
-        parser_error(p, "Missing ';' at end of print statement");
-        const char* sync[] = {"D_SEMICOLON"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_SEMICOLON)) {
+        parser_error(p, DIAG_PRINT_SEMICOLON);
+        synchronize(p, G_PRINT, T_D_SEMICOLON);
         
-        if (peek(p) && check_token(p, "D_SEMICOLON")) {
-            add_child(node, match(p, "D_SEMICOLON"));
+        if (peek(p) && check_token(p, T_D_SEMICOLON)) {
+            add_child(node, match(p, T_D_SEMICOLON));
         } else {
-            add_child(node, create_node("ERROR", "missing_semicolon"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
         }
     } else {
-        add_child(node, match(p, "D_SEMICOLON"));
+        add_child(node, match(p, T_D_SEMICOLON));
     }
     
-    printf("    * Print complete\n");
-    exit_nonterminal("Print", p->current_token->lexeme);
+    parser_log("    * Print complete\n");
+    exit_nonterminal(G_PRINT, p->pos);
     return node;
 }
 
 
 ParseTreeNode* parse_print_args(Parser* p) {
-    enter_nonterminal("PrintArgs", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("PrintArgs", NULL);
+    enter_nonterminal(G_PRINT_ARGS, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_PRINT_ARGS, NULL);
     add_child(node, parse_expression(p));
-    if (peek(p) && check_token(p, "D_COMMA")) {
-        add_child(node, match(p, "D_COMMA"));
+    if (peek(p) && check_token(p, T_D_COMMA)) {
+        add_child(node, match(p, T_D_COMMA));
         add_child(node, parse_print_args(p));
     }
-    exit_nonterminal("PrintArgs", p->current_token->lexeme);
+    exit_nonterminal(G_PRINT_ARGS, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_scan(Parser* p) {
-    enter_nonterminal("Scan", p->current_token->lexeme);
-    printf("    - Parsing Scan...\n");
-    ParseTreeNode* node = create_node("Scan", NULL);
-    add_child(node, match(p, "K_TANIM"));
+    enter_nonterminal(G_SCAN, p->pos);
+    parser_log("    - Parsing Scan...\n");
+    ParseTreeNode* node = create_node(p, NODE_SCAN, NULL);
+    add_child(node, match(p, T_K_TANIM));
     
     // ERROR RECOVERY: Check for opening parenthesis
-    if (peek(p) && !check_token(p, "D_LPAREN")) {
-        parser_error(p, "Missing '(' after 'tanim'");
-        const char* sync[] = {"D_LPAREN"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_LPAREN)) {
+        parser_error(p, DIAG_SCAN_LPAREN);
+        synchronize(p, G_SCAN, T_D_LPAREN);
     }
     
-    add_child(node, match(p, "D_LPAREN"));
+    add_child(node, match(p, T_D_LPAREN));
     add_child(node, parse_scan_args(p));
     
     // ERROR RECOVERY: Check for closing parenthesis
-    if (peek(p) && !check_token(p, "D_RPAREN")) {
-        parser_error(p, "Missing ')' in scan statement");
-        const char* sync[] = {"D_RPAREN", "D_SEMICOLON"};
-        synchronize(p, sync, 2);
+    if (peek(p) && !check_token(p, T_D_RPAREN)) {
+        parser_error(p, DIAG_SCAN_RPAREN);
+        synchronize(p, G_SCAN, T_D_RPAREN);
         
-        if (peek(p) && check_token(p, "D_RPAREN")) {
-            add_child(node, match(p, "D_RPAREN"));
+        if (peek(p) && check_token(p, T_D_RPAREN)) {
+            add_child(node, match(p, T_D_RPAREN));
         } else {
-            add_child(node, create_node("ERROR", "missing_rparen"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_rparen"));
         }
     } else {
-        add_child(node, match(p, "D_RPAREN"));
+        add_child(node, match(p, T_D_RPAREN));
     }
     
     // ERROR RECOVERY: Check for semicolon
-    if (peek(p) && !check_token(p, "D_SEMICOLON")) {
-        parser_error(p, "Missing ';' at end of scan statement");
-        const char* sync[] = {"D_SEMICOLON"};
-        synchronize(p, sync, 1);
+    if (peek(p) && !check_token(p, T_D_SEMICOLON)) {
+        parser_error(p, DIAG_SCAN_SEMICOLON);
+        synchronize(p, G_SCAN, T_D_SEMICOLON);
         
-        if (peek(p) && check_token(p, "D_SEMICOLON")) {
-            add_child(node, match(p, "D_SEMICOLON"));
+        if (peek(p) && check_token(p, T_D_SEMICOLON)) {
+            add_child(node, match(p, T_D_SEMICOLON));
         } else {
-            add_child(node, create_node("ERROR", "missing_semicolon"));
+            add_child(node, create_node(p, NODE_ERROR, "missing_semicolon"));
         }
     } else {
-        add_child(node, match(p, "D_SEMICOLON"));
+        add_child(node, match(p, T_D_SEMICOLON));
     }
     
-    printf("    * Scan complete\n");
-    exit_nonterminal("Scan", p->current_token->lexeme);
+    parser_log("    * Scan complete\n");
+    exit_nonterminal(G_SCAN, p->pos);
     return node;
 }
 
 ParseTreeNode* parse_scan_args(Parser* p) {
-    enter_nonterminal("ScanArgs", p->current_token->lexeme);
-    ParseTreeNode* node = create_node("ScanArgs", NULL);
-    add_child(node, match(p, "L_IDENTIFIER"));
-    if (peek(p) && check_token(p, "D_COMMA")) {
-        add_child(node, match(p, "D_COMMA"));
+    enter_nonterminal(G_SCAN_ARGS, p->pos);
+    ParseTreeNode* node = create_node(p, NODE_SCAN_ARGS, NULL);
+    add_child(node, match(p, T_L_IDENTIFIER));
+    if (peek(p) && check_token(p, T_D_COMMA)) {
+        add_child(node, match(p, T_D_COMMA));
         add_child(node, parse_scan_args(p));
     }
-    exit_nonterminal("ScanArgs", p->current_token->lexeme);
+    exit_nonterminal(G_SCAN_ARGS, p->pos);
     return node;
 }
 
 // ============ CLASS DEFINITION ============
 
 ParseTreeNode* parse_class_definition(Parser* p) {
-    enter_nonterminal("ClassDefinition", p->current_token->lexeme);
-    printf("  - Parsing Class Definition...\n");
-    ParseTreeNode* node = create_node("ClassDefinition", NULL);
-    add_child(node, match(p, "K_PANGKAT"));
-    add_child(node, match(p, "L_IDENTIFIER"));
-    add_child(node, match(p, "D_LBRACE"));
-    add_child(node, match(p, "D_RBRACE"));
-    printf("  * Class Definition complete\n");
-    exit_nonterminal("ClassDefinition", p->current_token->lexeme);
+    enter_nonterminal(G_CLASS_DEFINITION, p->pos);
+    parser_log("  - Parsing Class Definition...\n");
+    ParseTreeNode* node = create_node(p, NODE_CLASS_DEFINITION, NULL);
+    add_child(node, match(p, T_K_PANGKAT));
+    add_child(node, match(p, T_L_IDENTIFIER));
+    add_child(node, match(p, T_D_LBRACE));
+    add_child(node, match(p, T_D_RBRACE));
+    parser_log("  * Class Definition complete\n");
+    exit_nonterminal(G_CLASS_DEFINITION, p->pos);
     return node;
 }
 
 // ============ FILE I/O ============
 
-Token* read_symbol_table(const char* filename, int* count) {
+// One line of fp, however long, into *line (grown as needed); its length, or
+// -1 at the end of the file or when out of memory
+static long read_line(char** line, size_t* capacity, FILE* fp) {
+#ifndef _WIN32
+    return (long)getline(line, capacity, fp);
+#else
+    // No getline: fgets into the buffer, doubling it until the line fits
+    size_t length = 0;
+    for (;;) {
+        if (*capacity - length < 2) {
+            size_t grown = *capacity ? 2 * *capacity : 256;
+            char* text = (char*)realloc(*line, grown);
+            if (!text) return -1;
+            *line = text;
+            *capacity = grown;
+        }
+        if (!fgets(*line + length, (int)(*capacity - length), fp)) return length > 0 ? (long)length : -1;
+        length += strlen(*line + length);
+        if ((*line)[length - 1] == '\n') return (long)length;
+    }
+#endif
+}
+
+// The last '|' in the length bytes at text, NULL for none
+static char* last_bar(char* text, size_t length) {
+    while (length > 0) {
+        if (text[--length] == '|') return text + length;
+    }
+    return NULL;
+}
+
+bool read_symbol_table(const char* filename, TokenStore* tokens) {
     FILE* fp = fopen(filename, "r");
     if (!fp) {
-        printf("\nERROR: Cannot open file '%s'\n", filename);
-        printf("Make sure 'Symbol Table.txt' exists in the same folder!\n");
-        *count = 0;
-        return NULL;
+        parser_log("\nERROR: Cannot open file '%s'\n", filename);
+        parser_log("Make sure 'Symbol Table.txt' exists in the same folder!\n");
+        return false;
     }
     
-    Token* tokens = (Token*)malloc(MAX_TOKENS * sizeof(Token));
-    *count = 0;
-    char line[512];
+    char* line = NULL;
+    size_t capacity = 0;
+    long length;
+    bool ok = true;
     
-    printf("\nReading symbol table from '%s'...\n", filename);
+    parser_log("\nReading symbol table from '%s'...\n", filename);
     
     // Skip header line
-    if (fgets(line, sizeof(line), fp)) {
-        printf("Header: %s", line);
+    if (read_line(&line, &capacity, fp) >= 0) {
+        parser_log("Header: %s", line);
     }
     
-    // Read tokens
-    while (fgets(line, sizeof(line), fp) && *count < MAX_TOKENS) {
-        // Parse format: lexeme | token | line
-        char lexeme[MAX_TOKEN_LENGTH];
-        char token_type[MAX_TOKEN_LENGTH];
-        int line_num;
+    // Read tokens: lexeme | token | line. The lexeme may hold '|' itself
+    // ("||", a string), so the fields are split at the last two.
+    while (ok && (length = read_line(&line, &capacity, fp)) >= 0) {
+        char* line_ptr = last_bar(line, (size_t)length);
+        char* token_ptr = line_ptr ? last_bar(line, (size_t)(line_ptr - line)) : NULL;
+        if (!token_ptr) continue;
         
-        char* lex_ptr = strtok(line, "|");
-        char* token_ptr = strtok(NULL, "|");
-        char* line_ptr = strtok(NULL, "|");
+        char* lexeme = line;
+        size_t lexeme_length = trim(&lexeme, (size_t)(token_ptr - line));
+        char* token_type = token_ptr + 1;
+        size_t token_length = trim(&token_type, (size_t)(line_ptr - token_ptr - 1));
+        token_type[token_length] = '\0';
+        int line_num = atoi(line_ptr + 1);
         
-        if (lex_ptr && token_ptr && line_ptr) {
-            strcpy(lexeme, lex_ptr);
-            strcpy(token_type, token_ptr);
-            line_num = atoi(line_ptr);
-            
-            // Trim whitespace
-            trim(lexeme);
-            trim(token_type);
-            
-            strcpy(tokens[*count].lexeme, lexeme);
-            strcpy(tokens[*count].type, token_type);
-            tokens[*count].line = line_num;
-            (*count)++;
-        }
+        ok = add_token(tokens, token_kind_from_name(token_type), lexeme, lexeme_length, line_num);
     }
     
+    // getline stops the same way at the end and when out of memory
+    if (ok && !feof(fp)) ok = false;
+    free(line);
     fclose(fp);
-    printf("Successfully read %d tokens from symbol table.\n\n", *count);
-    return tokens;
-}
-
-void print_parse_tree_visual_helper(ParseTreeNode* node, FILE* fp, char* prefix, bool is_last) {
-    if (!node) return;
-    
-    fprintf(fp, "%s", prefix);
-    fprintf(fp, "%s", is_last ? "└── " : "├── ");
-    fprintf(fp, "%s", node->name);
-    if (strlen(node->value) > 0 && strcmp(node->value, "empty") != 0) {
-        fprintf(fp, " [%s]", node->value);
-    }
-    fprintf(fp, "\n");
-    
-    char new_prefix[512];
-    sprintf(new_prefix, "%s%s", prefix, is_last ? "    " : "│   ");
-    
-    for (int i = 0; i < node->child_count; i++) {
-        print_parse_tree_visual_helper(node->children[i], fp, new_prefix, 
-                                       i == node->child_count - 1);
-    }
-}
+    if (!ok) {
+        parser_log("\nERROR: Out of memory while reading '%s'\n", filename);
+        return false;
+    }
+    parser_log("Successfully read %d tokens from symbol table.\n\n", tokens->count);
+    return true;
+}
+
+// Map a binary token file and check that its sections fit the file.
+// Nothing is decoded here; the section pointers point into the mapping.
+bool open_token_file(const char* filename, TokenFile* tf) {
+    if (!openSource(&tf->file, filename)) {
+        parser_log("\nERROR: Cannot open file '%s'\n", filename);
+        return false;
+    }
+
+    const unsigned char* data = (const unsigned char*)tf->file.data;
+    TokenFileHeader* h = &tf->header;
+    bool ok = tf->file.length >= sizeof(TokenFileHeader);
+    if (ok) {
+        memcpy(h, data, sizeof(TokenFileHeader));
+        h->version = tokenFileU16(h->version);
+        h->headerSize = tokenFileU16(h->headerSize);
+        h->tokenCount = tokenFileU32(h->tokenCount);
+        h->kindCount = tokenFileU32(h->kindCount);
+        h->lexemeCount = tokenFileU32(h->lexemeCount);
+        h->stringBytes = tokenFileU32(h->stringBytes);
+        h->lineBytes = tokenFileU32(h->lineBytes);
+        ok = memcmp(h->magic, TOKEN_FILE_MAGIC, sizeof(h->magic)) == 0 &&
+             h->version == TOKEN_FILE_VERSION &&
+             h->headerSize == sizeof(TokenFileHeader) &&
+             h->kindCount <= TOKEN_FILE_MAX_KINDS;
+    }
+    if (ok) {
+        // 64-bit sizes so a corrupt count can't wrap around
+        uint64_t string_count = (uint64_t)h->kindCount + h->lexemeCount;
+        uint64_t size = sizeof(TokenFileHeader) + (string_count + 1) * 4 +
+                        (uint64_t)h->tokenCount * 5 + h->lineBytes + h->stringBytes;
+        ok = size == tf->file.length;
+    }
+    if (!ok) {
+        parser_log("\nERROR: '%s' is not a version %d token file\n", filename, TOKEN_FILE_VERSION);
+        closeSource(&tf->file);
+        return false;
+    }
+
+    size_t offset = sizeof(TokenFileHeader);
+    tf->stringOffsets = data + offset;
+    offset += ((size_t)h->kindCount + h->lexemeCount + 1) * 4;
+    tf->tokenLexemes = data + offset;
+    offset += (size_t)h->tokenCount * 4;
+    tf->tokenKinds = data + offset;
+    offset += h->tokenCount;
+    tf->lineDeltas = data + offset;
+    offset += h->lineBytes;
+    tf->strings = (const char*)data + offset;
+
+    // The string pool must be terminated where the offsets say
+    uint32_t string_count = h->kindCount + h->lexemeCount;
+    uint32_t previous = 0;
+    for (uint32_t i = 0; ok && i <= string_count; i++) {
+        uint32_t start = tokenFileEntry(tf->stringOffsets, i);
+        ok = (i == 0) ? start == 0
+                      : start > previous && start <= h->stringBytes && tf->strings[start - 1] == '\0';
+        previous = start;
+    }
+    if (!ok || previous != h->stringBytes) {
+        parser_log("\nERROR: '%s' has a corrupt string pool\n", filename);
+        closeSource(&tf->file);
+        return false;
+    }
+    return true;
+}
+
+void close_token_file(TokenFile* tf) {
+    closeSource(&tf->file);
+}
+
+static const char* token_file_kind_name(const TokenFile* tf, uint32_t kind_id) {
+    return tf->strings + tokenFileEntry(tf->stringOffsets, kind_id);
+}
+
+// Walk the tokens of a mapped file: lexeme, its length, kind id and line.
+// Returns false at the end or on a corrupt token.
+typedef struct {
+    uint32_t index;
+    size_t line_pos;
+    int line;
+} TokenFileCursor;
+
+static bool next_file_token(const TokenFile* tf, TokenFileCursor* c, const char** lexeme,
+                            size_t* length, uint32_t* kind, int* line) {
+    const TokenFileHeader* h = &tf->header;
+    if (c->index >= h->tokenCount) return false;
+
+    uint32_t lexeme_id = tokenFileEntry(tf->tokenLexemes, c->index);
+    uint32_t kind_id = tf->tokenKinds[c->index];
+    if (lexeme_id >= h->lexemeCount || kind_id >= h->kindCount) return false;
+
+    uint32_t delta = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        if (c->line_pos >= h->lineBytes || shift > 28) return false;
+        byte = tf->lineDeltas[c->line_pos++];
+        delta |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    c->line += (int)delta;
+
+    uint32_t start = tokenFileEntry(tf->stringOffsets, h->kindCount + lexeme_id);
+    *lexeme = tf->strings + start;
+    *length = tokenFileEntry(tf->stringOffsets, h->kindCount + lexeme_id + 1) - start - 1;
+    *kind = kind_id;
+    *line = c->line;
+    c->index++;
+    return true;
+}
+
+// Load a binary token file into parser tokens
+bool read_token_file(const char* filename, TokenStore* tokens) {
+    TokenFile tf;
+    if (!open_token_file(filename, &tf)) {
+        return false;
+    }
+
+    // The token columns grow once; the text column as lexemes are copied in
+    uint32_t token_count = tf.header.tokenCount;
+    if (token_count > (uint32_t)(INT32_MAX - tokens->count) ||
+        !reserve_token_store(tokens, tokens->count + (int)token_count, tokens->text_capacity)) {
+        close_token_file(&tf);
+        return false;
+    }
+
+    // Each kind name in the file is looked up once
+    TokenKind kinds[TOKEN_FILE_MAX_KINDS];
+    for (uint32_t k = 0; k < tf.header.kindCount; k++) {
+        kinds[k] = token_kind_from_name(token_file_kind_name(&tf, k));
+    }
+
+    TokenFileCursor cursor = {0, 0, 1};
+    const char* lexeme;
+    uint32_t kind;
+    size_t length;
+    int line;
+    int first = tokens->count;
+    bool ok = true;
+    while (ok && next_file_token(&tf, &cursor, &lexeme, &length, &kind, &line)) {
+        ok = add_token(tokens, kinds[kind], lexeme, length, line);
+    }
+    close_token_file(&tf);
+
+    int count = tokens->count - first;
+    if (!ok) {
+        parser_log("\nERROR: Out of memory while reading '%s'\n", filename);
+        return false;
+    }
+    if ((uint32_t)count != token_count) {
+        parser_log("\nERROR: '%s' is corrupt at token %d\n", filename, count);
+        return false;
+    }
+    parser_log("\nLoaded %d tokens from '%s'.\n\n", count, filename);
+    return true;
+}
+
+// Write a token file back out as the lexer's text symbol table
+void write_token_file_text(const TokenFile* tf, FILE* fp) {
+    TokenFileCursor cursor = {0, 0, 1};
+    const char* lexeme;
+    uint32_t kind;
+    size_t length;
+    int line;
+    fprintf(fp, "Lexeme           | Token Name\n");
+    while (next_file_token(tf, &cursor, &lexeme, &length, &kind, &line)) {
+        fprintf(fp, "%-15.*s | %-20s | %d \n", (int)length, lexeme, token_file_kind_name(tf, kind), line);
+    }
+}
+
+// Node values that are never printed: none, and the ε marker
+static bool has_printed_value(const ParseTreeNode* node) {
+    return node->value && node->value[0] != '\0' && strcmp(node->value, "empty") != 0;
+}
+
+// Node being written: the one after it among its siblings comes next
+typedef struct {
+    const ParseTreeNode* next;  // next child to write, NULL when done
+    size_t prefix;              // visual: the children's prefix length
+} WriteFrame;
 
-void print_parse_tree_parenthesized_helper(ParseTreeNode* node, FILE* fp, int indent) {
-    if (!node) return;
-    
-    // Print indentation
-    for (int j = 0; j < indent; j++) fprintf(fp, "  ");
-    
-    if (node->child_count == 0) {
-        fprintf(fp, "%s", node->name);
-        if (strlen(node->value) > 0 && strcmp(node->value, "empty") != 0) {
-            fprintf(fp, "(%s)", node->value);
+typedef struct {
+    WriteFrame* frames;
+    int depth;
+    int capacity;
+} WriteStack;
+
+static bool write_stack_push(WriteStack* stack, const ParseTreeNode* next, size_t prefix) {
+    if (stack->depth == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 256;
+        WriteFrame* grown = (WriteFrame*)realloc(stack->frames, capacity * sizeof(WriteFrame));
+        if (!grown) return false;
+        stack->frames = grown;
+        stack->capacity = capacity;
+    }
+    stack->frames[stack->depth].next = next;
+    stack->frames[stack->depth].prefix = prefix;
+    stack->depth++;
+    return true;
+}
+
+// "<prefix>└── Name [value]", with ├── unless the node is the last child
+static void write_visual_line(Output* out, const char* prefix, size_t length,
+                              const ParseTreeNode* node, bool is_last) {
+    output_write(out, prefix, length);
+    output_string(out, is_last ? "└── " : "├── ");
+    output_string(out, node_name(node));
+    if (has_printed_value(node)) {
+        output_write(out, " [", 2);
+        output_string(out, node->value);
+        output_char(out, ']');
+    }
+    output_char(out, '\n');
+}
+
+// Tree drawing, one node per line. The prefix of every depth lives in one
+// buffer: each level adds "    " or "│   " after its parent's, so entering a
+// node only writes its segment at the parent's length.
+static bool write_tree_visual(Output* out, const ParseTreeNode* root) {
+    if (!root) return true;
+    WriteStack stack = { NULL, 0, 0 };
+    size_t prefix_capacity = 1024;
+    char* prefix = (char*)malloc(prefix_capacity);
+    bool ok = prefix != NULL;
+
+    if (ok) write_visual_line(out, "", 0, root, true);
+    if (ok && root->first_child) {
+        memcpy(prefix, "    ", 4);
+        ok = write_stack_push(&stack, root->first_child, 4);
+    }
+    while (ok && stack.depth > 0) {
+        WriteFrame* frame = &stack.frames[stack.depth - 1];
+        const ParseTreeNode* node = frame->next;
+        if (!node) {
+            stack.depth--;
+            continue;
         }
-        return;
-    }
-    
-    fprintf(fp, "%s(\n", node->name);
-    for (int i = 0; i < node->child_count; i++) {
-        print_parse_tree_parenthesized_helper(node->children[i], fp, indent + 1);
-        if (i < node->child_count - 1) {
-            fprintf(fp, ",");
+        frame->next = node->next_sibling;
+        bool is_last = node->next_sibling == NULL;
+        size_t length = frame->prefix;
+        write_visual_line(out, prefix, length, node, is_last);
+        if (!node->first_child) continue;
+
+        const char* segment = is_last ? "    " : "│   ";
+        size_t grown = length + strlen(segment);
+        if (grown > prefix_capacity) {
+            char* larger = (char*)realloc(prefix, prefix_capacity * 2);
+            if (!larger) {
+                ok = false;
+                break;
+            }
+            prefix = larger;
+            prefix_capacity *= 2;
+        }
+        memcpy(prefix + length, segment, grown - length);
+        ok = write_stack_push(&stack, node->first_child, grown);
+    }
+    free(prefix);
+    free(stack.frames);
+    return ok;
+}
+
+// After a child of the innermost open node: a comma unless it was the last
+static void end_parenthesized_child(Output* out, const WriteStack* stack) {
+    if (stack->depth == 0) return;
+    if (stack->frames[stack->depth - 1].next) output_char(out, ',');
+    output_char(out, '\n');
+}
+
+// Name(value) for a leaf, otherwise "Name(" and the children one per line,
+// comma-separated and indented two spaces a level, then ")" on its own line
+static bool write_tree_parenthesized(Output* out, const ParseTreeNode* root) {
+    if (!root) return true;
+    WriteStack stack = { NULL, 0, 0 };
+    bool ok = true;
+
+    const ParseTreeNode* node = root;
+    for (;;) {
+        // Write node, at the stack's depth
+        output_spaces(out, 2 * (size_t)stack.depth);
+        output_string(out, node_name(node));
+        if (node->first_child) {
+            output_write(out, "(\n", 2);
+            if (!(ok = write_stack_push(&stack, node->first_child, 0))) break;
+        } else {
+            if (has_printed_value(node)) {
+                output_char(out, '(');
+                output_string(out, node->value);
+                output_char(out, ')');
+            }
+            end_parenthesized_child(out, &stack);
         }
-        fprintf(fp, "\n");
+
+        // Close the nodes whose children are all written, then go on to the
+        // next child of the innermost open one
+        node = NULL;
+        while (stack.depth > 0) {
+            WriteFrame* frame = &stack.frames[stack.depth - 1];
+            if (frame->next) {
+                node = frame->next;
+                frame->next = node->next_sibling;
+                break;
+            }
+            stack.depth--;
+            output_spaces(out, 2 * (size_t)stack.depth);
+            output_char(out, ')');
+            end_parenthesized_child(out, &stack);
+        }
+        if (!node) break;
     }
-    
-    // Closing parenthesis
-    for (int j = 0; j < indent; j++) fprintf(fp, "  ");
-    fprintf(fp, ")");
+    free(stack.frames);
+    return ok;
 }
 
-void write_parse_tree_to_file(const char* filename, ParseTreeNode* tree, bool is_visual) {
-    FILE* fp = fopen(filename, "w");
-    if (!fp) {
-        printf("ERROR: Cannot create output file '%s'\n", filename);
-        return;
+bool write_parse_tree_to_file(const char* filename, ParseTreeNode* tree, bool is_visual) {
+    Output out;
+    if (!output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create output file '%s'\n", filename);
+        return false;
     }
     
-    fprintf(fp, "PARSE TREE (%s FORMAT)\n", is_visual ? "VISUAL" : "PARENTHESIZED");
-    fprintf(fp, "Generated by Recursive Descent Parser (Pushdown Automaton)\n");
-    fprintf(fp, "======================================================================\n\n");
+    output_string(&out, is_visual ? "PARSE TREE (VISUAL FORMAT)\n" : "PARSE TREE (PARENTHESIZED FORMAT)\n");
+    output_string(&out, "Generated by Recursive Descent Parser (Pushdown Automaton)\n");
+    output_string(&out, "======================================================================\n\n");
     
+    bool ok;
     if (is_visual) {
-        char prefix[512] = "";
-        print_parse_tree_visual_helper(tree, fp, prefix, true);
+        ok = write_tree_visual(&out, tree);
     } else {
-        print_parse_tree_parenthesized_helper(tree, fp, 0);
-        fprintf(fp, "\n");
+        ok = write_tree_parenthesized(&out, tree);
+        output_char(&out, '\n');
     }
     
-    fprintf(fp, "\n======================================================================\n");
-    fprintf(fp, "End of Parse Tree\n");
+    output_string(&out, "\n======================================================================\n");
+    output_string(&out, "End of Parse Tree\n");
     
-    fclose(fp);
-    printf("Parse tree written to '%s'\n", filename);
+    ok = output_close(&out) && ok;
+    parser_log("Parse tree written to '%s'\n", filename);
+    return ok;
 }
 
 // ==== HELPER ====
-Token* peek_ahead(Parser* p, int offset) {
+ParserToken* peek_ahead(Parser* p, int offset) {
     int target = p->pos + offset;
     
     if (target >= 0 && target < p->token_count) {
-        return &p->tokens[target];
+        return read_token(&p->tokens, target, &p->ahead);
     }
     return NULL;
 }
@@ -6,62 +6,255 @@
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <stdint.h>
+#include "../Lexer/tokens.h"
+#include "../Lexer/tokenfile.h"
+#include "arena.h"
 
-#define MAX_TOKEN_LENGTH 256
-#define MAX_CHILDREN 20
-#define MAX_ERRORS 100
-#define MAX_TOKENS 1000
+// Token kinds: TOKEN_KIND(category, value) from ../Lexer/tokens.h, so matching a
+// token is an integer compare. Type names are only used at the edges (symbol
+// tables, token files and the reports). Names the lexer never writes get kinds
+// from TOKEN_KIND_COUNT up: R_VOID, and any name met in a hand-edited table.
+typedef int TokenKind;
 
-// Token structure
+enum {
+    T_K_ANI = TOKEN_KIND(CAT_KEYWORD, K_ANI),
+    T_K_TANIM = TOKEN_KIND(CAT_KEYWORD, K_TANIM),
+    T_K_PARA = TOKEN_KIND(CAT_KEYWORD, K_PARA),
+    T_K_HABANG = TOKEN_KIND(CAT_KEYWORD, K_HABANG),
+    T_K_KUNG = TOKEN_KIND(CAT_KEYWORD, K_KUNG),
+    T_K_KUNDI = TOKEN_KIND(CAT_KEYWORD, K_KUNDI),
+    T_K_KUNDIMAN = TOKEN_KIND(CAT_KEYWORD, K_KUNDIMAN),
+    T_K_GAWIN = TOKEN_KIND(CAT_KEYWORD, K_GAWIN),
+    T_K_PANGKAT = TOKEN_KIND(CAT_KEYWORD, K_PANGKAT),
+
+    T_R_TAMA = TOKEN_KIND(CAT_RESERVED, R_TAMA),
+    T_R_MALI = TOKEN_KIND(CAT_RESERVED, R_MALI),
+    T_R_UGAT = TOKEN_KIND(CAT_RESERVED, R_UGAT),
+    T_R_BILANG = TOKEN_KIND(CAT_RESERVED, R_BILANG),
+    T_R_KWERDAS = TOKEN_KIND(CAT_RESERVED, R_KWERDAS),
+    T_R_LUTANG = TOKEN_KIND(CAT_RESERVED, R_LUTANG),
+    T_R_BULYAN = TOKEN_KIND(CAT_RESERVED, R_BULYAN),
+    T_R_WALA = TOKEN_KIND(CAT_RESERVED, R_WALA),
+    T_R_PI = TOKEN_KIND(CAT_RESERVED, R_PI),
+    T_R_E_NUM = TOKEN_KIND(CAT_RESERVED, R_E_NUM),
+    T_R_SAMPLE_CONST_STRING = TOKEN_KIND(CAT_RESERVED, R_SAMPLE_CONST_STRING),
+    T_R_Kiss = TOKEN_KIND(CAT_RESERVED, R_Kiss),
+
+    T_O_PLUS = TOKEN_KIND(CAT_OPERATOR, O_PLUS),
+    T_O_MINUS = TOKEN_KIND(CAT_OPERATOR, O_MINUS),
+    T_O_MULTIPLY = TOKEN_KIND(CAT_OPERATOR, O_MULTIPLY),
+    T_O_DIVIDE = TOKEN_KIND(CAT_OPERATOR, O_DIVIDE),
+    T_O_POW = TOKEN_KIND(CAT_OPERATOR, O_POW),
+    T_O_MODULO = TOKEN_KIND(CAT_OPERATOR, O_MODULO),
+    T_O_ASSIGN = TOKEN_KIND(CAT_OPERATOR, O_ASSIGN),
+    T_O_EQUAL = TOKEN_KIND(CAT_OPERATOR, O_EQUAL),
+    T_O_NOT_EQUAL = TOKEN_KIND(CAT_OPERATOR, O_NOT_EQUAL),
+    T_O_LESS = TOKEN_KIND(CAT_OPERATOR, O_LESS),
+    T_O_GREATER = TOKEN_KIND(CAT_OPERATOR, O_GREATER),
+    T_O_LESS_EQ = TOKEN_KIND(CAT_OPERATOR, O_LESS_EQ),
+    T_O_GREATER_EQ = TOKEN_KIND(CAT_OPERATOR, O_GREATER_EQ),
+    T_O_AND = TOKEN_KIND(CAT_OPERATOR, O_AND),
+    T_O_OR = TOKEN_KIND(CAT_OPERATOR, O_OR),
+    T_O_NOT = TOKEN_KIND(CAT_OPERATOR, O_NOT),
+
+    T_D_LPAREN = TOKEN_KIND(CAT_DELIMITER, D_LPAREN),
+    T_D_RPAREN = TOKEN_KIND(CAT_DELIMITER, D_RPAREN),
+    T_D_LBRACE = TOKEN_KIND(CAT_DELIMITER, D_LBRACE),
+    T_D_RBRACE = TOKEN_KIND(CAT_DELIMITER, D_RBRACE),
+    T_D_LBRACKET = TOKEN_KIND(CAT_DELIMITER, D_LBRACKET),
+    T_D_RBRACKET = TOKEN_KIND(CAT_DELIMITER, D_RBRACKET),
+    T_D_COMMA = TOKEN_KIND(CAT_DELIMITER, D_COMMA),
+    T_D_SEMICOLON = TOKEN_KIND(CAT_DELIMITER, D_SEMICOLON),
+
+    T_L_IDENTIFIER = TOKEN_KIND(CAT_LITERAL, L_IDENTIFIER),
+    T_L_BILANG_LITERAL = TOKEN_KIND(CAT_LITERAL, L_BILANG_LITERAL),
+    T_L_LUTANG_LITERAL = TOKEN_KIND(CAT_LITERAL, L_LUTANG_LITERAL),
+    T_L_KWERDAS_LITERAL = TOKEN_KIND(CAT_LITERAL, L_KWERDAS_LITERAL),
+
+    T_R_VOID = TOKEN_KIND_COUNT,    // accepted as a return type, never written by the lexer
+    T_NONE = -1
+};
+
+// The parser's tokens, one column per field. Lookahead only touches the dense
+// kinds column; lines and lexemes are read when a node or a message needs them.
+// Lexemes are NUL-terminated strings packed in one text buffer. Every column
+// grows by doubling, so there is no token limit.
+//
+// An incremental reparse (incremental.h) keeps a gap in the columns where the
+// last edit was, so that tokens go in and out there without moving the rest:
+// tokens from gap on sit gap_length slots further along, their lines stored
+// tail_lines short. A store filled by add_token has no gap (all three zero);
+// read_token reads either.
+typedef struct {
+    uint16_t* kinds;
+    int* lines;
+    uint32_t* lexemes;      // offset of each token's lexeme in text
+    char* text;
+    int count;
+    int capacity;
+    size_t text_length;
+    size_t text_capacity;
+    int gap;
+    int gap_length;
+    int tail_lines;
+} TokenStore;
+
+// One token as the parser sees it, read out of the store
 typedef struct {
-    char lexeme[MAX_TOKEN_LENGTH];
-    char type[MAX_TOKEN_LENGTH];
+    const char* lexeme;
+    TokenKind kind;
     int line;
-} Token;
+} ParserToken;
+
+void init_token_store(TokenStore* tokens);
+void free_token_store(TokenStore* tokens);
+// Room for count tokens and text_length lexeme bytes in all, so a loader that
+// knows its sizes grows the columns once. Returns false when out of memory.
+bool reserve_token_store(TokenStore* tokens, int count, size_t text_length);
+// Copies the length bytes of the lexeme, however many, into the store
+bool add_token(TokenStore* tokens, TokenKind kind, const char* lexeme, size_t length, int line);
 
-// Parse Tree Node structure
+// Kind <-> type name, e.g. T_D_SEMICOLON <-> "D_SEMICOLON". Unknown names get
+// a new kind; returns T_NONE only when out of memory.
+const char* token_kind_name(TokenKind kind);
+TokenKind token_kind_from_name(const char* name);
+
+// Parse tree node kinds: the grammar's nonterminals, ε and ERROR. A node for a
+// matched token has kind NODE_TOKEN + its TokenKind and is named after it.
+#define PARSE_NODE_KINDS(X) \
+    X(NODE_PROGRAM,               "Program") \
+    X(NODE_MAIN_FUNCTION,         "MainFunction") \
+    X(NODE_RETURN_TYPE,           "ReturnType") \
+    X(NODE_PARAMETER_LIST,        "ParameterList") \
+    X(NODE_FUNCTION_BODY,         "FunctionBody") \
+    X(NODE_STATEMENT_LIST,        "StatementList") \
+    X(NODE_STATEMENT,             "Statement") \
+    X(NODE_DECLARATION,           "Declaration") \
+    X(NODE_DATA_TYPE,             "DataType") \
+    X(NODE_IDENTIFIER_LIST,       "IdentifierList") \
+    X(NODE_IDENTIFIER_TAIL,       "IdentifierTail") \
+    X(NODE_ASSIGNMENT,            "Assignment") \
+    X(NODE_ASSIGNMENT_EXPRESSION, "AssignmentExpression") \
+    X(NODE_EXPRESSION,            "Expression") \
+    X(NODE_EXPRESSION_TAIL,       "ExpressionTail") \
+    X(NODE_TERM,                  "Term") \
+    X(NODE_TERM_TAIL,             "TermTail") \
+    X(NODE_FACTOR,                "Factor") \
+    X(NODE_BOOLEAN_EXPRESSION,    "BooleanExpression") \
+    X(NODE_RELOP,                 "RelOp") \
+    X(NODE_CONDITIONAL,           "Conditional") \
+    X(NODE_CONDITIONAL_TAIL,      "ConditionalTail") \
+    X(NODE_ITERATIVE,             "Iterative") \
+    X(NODE_FOR_LOOP,              "ForLoop") \
+    X(NODE_WHILE_LOOP,            "WhileLoop") \
+    X(NODE_DO_WHILE_LOOP,         "DoWhileLoop") \
+    X(NODE_PRINT,                 "Print") \
+    X(NODE_PRINT_ARGS,            "PrintArgs") \
+    X(NODE_SCAN,                  "Scan") \
+    X(NODE_SCAN_ARGS,             "ScanArgs") \
+    X(NODE_CLASS_DEFINITION,      "ClassDefinition") \
+    X(NODE_EMPTY_INCREMENT,       "EmptyIncrement") \
+    X(NODE_EMPTY,                 "ε") \
+    X(NODE_ERROR,                 "ERROR")
+
+typedef enum {
+#define NODE_KIND_ENUM(kind, name) kind,
+    PARSE_NODE_KINDS(NODE_KIND_ENUM)
+#undef NODE_KIND_ENUM
+    NODE_TOKEN
+} NodeKind;
+
+// Parse Tree Node structure. Nodes are allocated from the parser's arena and
+// freed with it. The value is not copied: it points at the token's lexeme in
+// the parser's TokenStore or at a fixed note such as "missing_semicolon".
 typedef struct ParseTreeNode {
-    char name[MAX_TOKEN_LENGTH];
-    char value[MAX_TOKEN_LENGTH];
-    struct ParseTreeNode* children[MAX_CHILDREN];
-    int child_count;
+    int kind;                           // NodeKind, or NODE_TOKEN + TokenKind
+    const char* value;                  // NULL for none
+    struct ParseTreeNode* first_child;
+    struct ParseTreeNode* last_child;
+    struct ParseTreeNode* next_sibling;
 } ParseTreeNode;
 
+// Shape of expression subtrees built by parse_program
+typedef enum {
+    // The grammar's Expression/ExpressionTail/Term/TermTail/Factor chain with
+    // its ε tails and transitions; operators are + - * / only
+    EXPRESSION_TREE_TEXTBOOK,
+    // One node per operand and per operator, the operator's token node holding
+    // its operands; takes + - * / % ^, relational and logical operators and
+    // logs a single Expression transition pair per expression
+    EXPRESSION_TREE_COMPACT
+} ExpressionTree;
+
 // Parser structure
 typedef struct {
-    Token* tokens;
+    TokenStore tokens;
     int token_count;
     int pos;
-    Token* current_token;
-    char errors[MAX_ERRORS][512];
+    ParserToken* current_token;  // &current, NULL past the last token
+    ParserToken current;
+    ParserToken ahead;           // what peek_ahead last returned
+    Arena nodes;                 // the parse tree's nodes
+    struct Diagnostic* diagnostics;  // the syntax errors found (diagnostics.h)
     int error_count;
+    int diagnostic_capacity;
     ParseTreeNode* parse_tree;
+    ExpressionTree expression_tree;  // EXPRESSION_TREE_TEXTBOOK unless set after create_parser
+    struct AstNode* ast;         // parse_program_ast's tree (ast.h), NULL otherwise
+    struct IncrementalParse* incremental;  // the incremental parse keeping this one up to date (incremental.h), NULL for none
 } Parser;
 
+// Tracing build switch. Building with -DPARSER_TRACE=0 compiles the console
+// chatter below and the transition hooks (transitions.h) out of the parsing
+// engines, for a production parser that only builds trees and reports errors.
+#ifndef PARSER_TRACE
+#define PARSER_TRACE 1
+#endif
+
+// Console chatter (progress lines, error echo, recovery notes). 1 prints it as
+// the interactive parser always did; the batch CLI sets 0 unless asked (-v).
+extern int parser_verbosity;
+#if PARSER_TRACE
+#define parser_log(...) do { if (parser_verbosity > 0) printf(__VA_ARGS__); } while (0)
+#else
+#define parser_log(...) do { if (0) printf(__VA_ARGS__); } while (0)
+#endif
+
 // Function declarations
-Parser* create_parser(Token* tokens, int count);
+// The parser takes over the store's columns and leaves it empty
+Parser* create_parser(TokenStore* tokens);
 void free_parser(Parser* parser);
 bool parse_program(Parser* p);
-Token* read_symbol_table(const char* filename, int* count);
-void write_parse_tree_to_file(const char* filename, ParseTreeNode* tree, bool is_visual);
+// The rest of a block, from the current token on; an incremental reparse
+// starts at one (incremental.h)
+ParseTreeNode* parse_statement_list(Parser* p);
+bool read_symbol_table(const char* filename, TokenStore* tokens);
 
-// Parse tree node functions
-ParseTreeNode* create_node(const char* name, const char* value);
-void add_child(ParseTreeNode* parent, ParseTreeNode* child);
-void free_tree(ParseTreeNode* node);
+// Token-level steps shared by the parsing engines
+void advance(Parser* p);
+bool check_token(Parser* p, TokenKind type);
+// Consumes the expected token with a MATCH transition; on a mismatch reports
+// the error and returns an error node without consuming anything
+ParseTreeNode* match(Parser* p, TokenKind expected_type);
+// Token i of the store (i < count)
+ParserToken* read_token(const TokenStore* tokens, int i, ParserToken* token);
 
-// Transition tracking functions
-void init_transition_tracking();
-void enter_nonterminal(const char* nonterminal, const char* lookahead);
-void exit_nonterminal(const char* nonterminal, const char* lookahead);
-void match_terminal(const char* terminal, const char* value);
-void apply_production(const char* production_rule);
-void write_transition_table(const char* filename);
-void write_transition_diagram(const char* filename);
-void write_transition_summary(const char* filename);
+// Binary token file written by the lexer (format in ../Lexer/tokenfile.h)
+bool open_token_file(const char* filename, TokenFile* tf);
+void close_token_file(TokenFile* tf);
+bool read_token_file(const char* filename, TokenStore* tokens);
+void write_token_file_text(const TokenFile* tf, FILE* fp);
+// Report writers return false if the file could not be written
+bool write_parse_tree_to_file(const char* filename, ParseTreeNode* tree, bool is_visual);
 
-extern int transition_count;
+// Parse tree node functions. value must live as long as the parser (a lexeme
+// from its tokens or a string literal). NULL only when out of memory.
+ParseTreeNode* create_node(Parser* p, NodeKind kind, const char* value);
+ParseTreeNode* create_token_node(Parser* p);    // the current token as a leaf
+void add_child(ParseTreeNode* parent, ParseTreeNode* child);
+const char* node_name(const ParseTreeNode* node);
 
-Token* peek_ahead(Parser* p, int offset);
+ParserToken* peek_ahead(Parser* p, int offset);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "table_parser.h"
+#include "grammar.h"
+#include "diagnostics.h"
+#include "transitions.h"
+
+// Stack symbols past the grammar's: the end of a traced nonterminal's
+// production, where its EXIT transition is logged
+#define TABLE_EXIT(nonterminal) (0x4000 + (nonterminal))
+#define TABLE_IS_EXIT(symbol) ((symbol) >= 0x4000)
+
+#define TABLE_FIRST_STACK 256
+
+typedef struct {
+    int symbol;              // grammar symbol or TABLE_EXIT(...)
+    ParseTreeNode* parent;   // node the symbol's subtree is added to
+} StackEntry;
+
+typedef struct {
+    StackEntry* entries;
+    int depth;
+    int capacity;
+} ParseStack;
+
+static bool push(ParseStack* stack, int symbol, ParseTreeNode* parent) {
+    if (stack->depth == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : TABLE_FIRST_STACK;
+        StackEntry* grown = (StackEntry*)realloc(stack->entries, capacity * sizeof(StackEntry));
+        if (!grown) return false;
+        stack->entries = grown;
+        stack->capacity = capacity;
+    }
+    stack->entries[stack->depth].symbol = symbol;
+    stack->entries[stack->depth].parent = parent;
+    stack->depth++;
+    return true;
+}
+
+static int lookahead(Parser* p) {
+    return lookahead_symbol(p->current_token);
+}
+
+// Adds a node of kind to parent, or makes it the tree's root; NODE_NONE adds
+// nothing and gives back parent
+static ParseTreeNode* add_node(Parser* p, ParseTreeNode* parent, int kind) {
+    if (kind == NODE_NONE) return parent;
+    ParseTreeNode* node = create_node(p, (NodeKind)kind, NULL);
+    if (parent) add_child(parent, node);
+    else p->parse_tree = node;
+    return node;
+}
+
+// The node a nonterminal's productions build, NODE_NONE for helpers
+static int nonterminal_node(GrammarNonterminal nonterminal) {
+    for (int i = 0; i < P_COUNT; i++) {
+        const ProductionInfo* info = grammar_production((GrammarProduction)i);
+        if (info->lhs == nonterminal && info->node != NODE_NONE) return info->node;
+    }
+    return NODE_NONE;
+}
+
+// Production for nonterminal at the current token, after panic-mode recovery
+// if the table has none; P_NONE if recovery found only a token that follows it
+static GrammarProduction choose(Parser* p, GrammarNonterminal nonterminal) {
+    GrammarProduction production = grammar_choice(nonterminal, lookahead(p), lookahead_symbol(peek_ahead(p, 1)));
+    if (production != P_NONE) return production;
+
+    // A nullable nonterminal ends quietly where the input may end
+    GrammarProduction empty = grammar_empty_production(nonterminal);
+    const TokenSet* follow = grammar_follow(nonterminal);
+    if (empty != P_NONE && (lookahead(p) == TOKEN_SET_EOF || token_set_has(follow, TOKEN_SET_EOF))) {
+        return empty;
+    }
+
+    parser_error_expected_nonterminal(p, nonterminal);
+
+    // Skip to a token that can start or follow the nonterminal
+    const TokenSet* first = grammar_first(nonterminal);
+    while (p->current_token && !token_set_has(first, lookahead(p)) && !token_set_has(follow, lookahead(p))) {
+        advance(p);
+    }
+    production = grammar_choice(nonterminal, lookahead(p), lookahead_symbol(peek_ahead(p, 1)));
+    return production != P_NONE ? production : empty;
+}
+
+// Expands a nonterminal: logs ENTER, creates its node and pushes its
+// right-hand side (and EXIT marker) so that the leftmost symbol is on top
+static bool expand(Parser* p, ParseStack* stack, GrammarNonterminal nonterminal, ParseTreeNode* parent) {
+    bool traced = grammar_nonterminal_traced(nonterminal);
+    if (traced) enter_nonterminal(nonterminal, p->pos);
+
+    GrammarProduction production = choose(p, nonterminal);
+    if (production == P_NONE) {
+        // The nonterminal's node holding an error leaf (a helper's leaf goes to the parent)
+        ParseTreeNode* node = add_node(p, parent, nonterminal_node(nonterminal));
+        add_child(node, create_node(p, NODE_ERROR, "unexpected_token"));
+        if (traced) exit_nonterminal(nonterminal, p->pos);
+        return true;
+    }
+
+    const ProductionInfo* info = grammar_production(production);
+    ParseTreeNode* node = add_node(p, parent, info->node);
+
+    if (traced && !push(stack, TABLE_EXIT(nonterminal), NULL)) return false;
+    int length = 0;
+    while (info->rhs[length] != GRAMMAR_END) length++;
+    for (int i = length - 1; i >= 0; i--) {
+        int symbol = info->rhs[i];
+        if (symbol == GRAMMAR_EPSILON || GRAMMAR_IS_STARTS_WITH(symbol)) continue;
+        if (!push(stack, symbol, node)) return false;
+    }
+    return true;
+}
+
+bool parse_program_table(Parser* p) {
+    parser_log("\n=== Starting Syntax Analysis (table-driven LL(1)) ===\n");
+    ParseStack stack = { NULL, 0, 0 };
+    bool ok = push(&stack, GRAMMAR_NT(G_PROGRAM), NULL);
+
+    while (ok && stack.depth > 0) {
+        StackEntry top = stack.entries[--stack.depth];
+        int symbol = top.symbol;
+
+        if (TABLE_IS_EXIT(symbol)) {
+            exit_nonterminal((GrammarNonterminal)(symbol - TABLE_EXIT(0)), p->pos);
+        } else if (GRAMMAR_IS_NT(symbol)) {
+            ok = expand(p, &stack, (GrammarNonterminal)(symbol - GRAMMAR_NT(0)), top.parent);
+        } else if (symbol == GRAMMAR_EMPTY) {
+            add_child(top.parent, create_node(p, NODE_EMPTY, "empty"));
+        } else if (symbol == GRAMMAR_EMPTY_INCREMENT) {
+            add_child(top.parent, create_node(p, NODE_EMPTY_INCREMENT, ""));
+        } else if (GRAMMAR_IS_QUIET(symbol) && check_token(p, GRAMMAR_TERMINAL(symbol))) {
+            add_child(top.parent, create_token_node(p));
+            advance(p);
+        } else {
+            add_child(top.parent, match(p, GRAMMAR_TERMINAL(symbol)));
+        }
+    }
+    free(stack.entries);
+
+    if (!ok) parser_error(p, DIAG_OUT_OF_MEMORY);
+    parser_log("Program parsing complete!\n");
+    parser_log("Total errors found: %d\n", p->error_count);
+    return (p->error_count == 0);
+}
@@ -0,0 +1,22 @@
+#ifndef TABLE_PARSER_H
+#define TABLE_PARSER_H
+
+#include "parser.h"
+
+// Table-driven LL(1) engine: the push-down automaton run directly on the
+// predict table of grammar.h, with its stack on the heap instead of the C call
+// stack, so input size is limited by memory only.
+//
+// On valid input it builds the same tree as parse_program and logs the same
+// ENTER/EXIT/MATCH transitions. Invalid input is reported differently:
+//   - a terminal that does not match is reported and left in place, like
+//     match() does;
+//   - a nonterminal with no production for the lookahead is reported, then
+//     tokens are skipped until one that can start it (parsing resumes) or
+//     follow it (it becomes an error node);
+//   - a nullable nonterminal takes its empty production at end of input.
+// There are no per-construct messages or recovery paths, so error counts and
+// messages differ from parse_program's.
+bool parse_program_table(Parser* p);
+
+#endif
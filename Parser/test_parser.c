@@ -0,0 +1,150 @@
+// Parser tests: inputs the parser has to take whatever their size. Each test
+// prints its name and ok or FAILED with what went wrong; the exit status is
+// nonzero if any failed.
+//
+// Build: gcc -O2 test_parser.c parser.c grammar.c table_parser.c ast.c transitions.c output.c treefile.c diagnostics.c
+//            incremental.c frontend.c arena.c bench_common.c ../Lexer/lexer.c ../Lexer/source.c ../Lexer/WordHash.c
+//            ../Lexer/tokenfile.c ../Lexer/skip.c -o test_parser
+//        (or: make check, which runs it)
+// Usage: test_parser
+#include "parser.h"
+#include "frontend.h"
+#include "table_parser.h"
+#include "incremental.h"
+#include "treefile.h"
+#include "bench_common.h"
+
+// Statements in the long block, far more than a stack frame each would allow
+#define LONG_BLOCK_STATEMENTS 300000
+// Characters in the long identifier, past the 255 lexemes used to be cut to
+#define LONG_LEXEME_LENGTH 400
+#define LONG_LEXEME_JSON "test_parser_long_lexeme.json"
+
+typedef bool (*ParseFunction)(Parser* p);
+
+// Lexes and parses the text; the parser, NULL when out of memory
+static Parser* parse_text(const char* source, size_t length, ParseFunction parse) {
+    TokenStore tokens;
+    init_token_store(&tokens);
+    if (!lex_source(source, length, &tokens, NULL)) return NULL;
+    Parser* parser = create_parser(&tokens);
+    if (parser) parse(parser);
+    return parser;
+}
+
+// The first node of the kind in preorder, NULL for none
+static const ParseTreeNode* find_node(const ParseTreeNode* node, int kind) {
+    while (node) {
+        if (node->kind == kind) return node;
+        const ParseTreeNode* found = find_node(node->first_child, kind);
+        if (found) return found;
+        node = node->next_sibling;
+    }
+    return NULL;
+}
+
+// The first node with the value in preorder, NULL for none
+static const ParseTreeNode* find_value(const ParseTreeNode* node, const char* value) {
+    while (node) {
+        if (node->value && strcmp(node->value, value) == 0) return node;
+        const ParseTreeNode* found = find_value(node->first_child, value);
+        if (found) return found;
+        node = node->next_sibling;
+    }
+    return NULL;
+}
+
+static bool report(const char* name, const char* failure) {
+    if (failure) printf("%-28s FAILED: %s\n", name, failure);
+    else printf("%-28s ok\n", name);
+    return failure == NULL;
+}
+
+// A main function of one long block: the descent engine makes its statement
+// lists without a stack frame per statement, and the same tree as the table
+// engine
+static bool test_long_block(void) {
+    static const char head[] = "wala ugat() {\n", statement[] = "x = 1;\n", tail[] = "}\n";
+    size_t length = strlen(head) + LONG_BLOCK_STATEMENTS * strlen(statement) + strlen(tail);
+    char* source = (char*)malloc(length + 1);
+    if (!source) return report("long block", "out of memory");
+    char* at = source + sprintf(source, "%s", head);
+    for (int i = 0; i < LONG_BLOCK_STATEMENTS; i++) at += sprintf(at, "%s", statement);
+    sprintf(at, "%s", tail);
+
+    const char* failure = NULL;
+    Parser* descent = parse_text(source, length, parse_program);
+    Parser* table = parse_text(source, length, parse_program_table);
+    if (!descent || !table) {
+        failure = "out of memory";
+    } else if (descent->error_count != 0 || table->error_count != 0) {
+        failure = "syntax errors in a valid program";
+    } else {
+        // One list per statement and the empty one, each the last child of
+        // the one before
+        int lists = 0;
+        const ParseTreeNode* list = find_node(descent->parse_tree, NODE_STATEMENT_LIST);
+        for (; list && list->kind == NODE_STATEMENT_LIST; list = list->last_child) lists++;
+        if (lists != LONG_BLOCK_STATEMENTS + 1) failure = "not one statement list per statement";
+        else if (!same_tree(descent->parse_tree, table->parse_tree)) failure = "the engines' trees differ";
+    }
+    if (descent) free_parser(descent);
+    if (table) free_parser(table);
+    free(source);
+    return report("long block", failure);
+}
+
+// An identifier longer than 255 bytes stays whole: in the tree, through a
+// JSON round trip, and across edits of the incremental parse, both one that
+// changes it and one next to it that leaves the token to be reused
+static bool test_long_lexeme(void) {
+    static const char head[] = "wala ugat() {\nx = 1;\n", tail[] = " = 1;\n}\n";
+    char name[LONG_LEXEME_LENGTH + 1];
+    memset(name, 'a', LONG_LEXEME_LENGTH);
+    name[LONG_LEXEME_LENGTH] = '\0';
+    char source[sizeof(head) + LONG_LEXEME_LENGTH + sizeof(tail)];
+    size_t length = (size_t)sprintf(source, "%s%s%s", head, name, tail);
+
+    const char* failure = NULL;
+    Parser* parser = parse_text(source, length, parse_program);
+    LoadedParseTree loaded;
+    if (!parser) {
+        failure = "out of memory";
+    } else if (parser->error_count != 0) {
+        failure = "syntax errors in a valid program";
+    } else if (!find_value(parser->parse_tree, name)) {
+        failure = "the identifier is not whole in the tree";
+    } else if (!write_parse_tree_json(LONG_LEXEME_JSON, parser->parse_tree) ||
+               !load_parse_tree_json(LONG_LEXEME_JSON, &loaded)) {
+        failure = "cannot write and load the tree as JSON";
+    } else {
+        if (!same_tree(parser->parse_tree, loaded.root)) failure = "the JSON tree differs";
+        free_loaded_parse_tree(&loaded);
+    }
+    if (parser) free_parser(parser);
+    remove(LONG_LEXEME_JSON);
+    if (failure) return report("long lexeme", failure);
+
+    IncrementalParse ip;
+    if (!incremental_open(&ip, source, length, EXPRESSION_TREE_TEXTBOOK)) return report("long lexeme", "out of memory");
+    // The last character retyped, then the statement before it changed
+    name[LONG_LEXEME_LENGTH - 1] = 'b';
+    SourceEdit retype = {strlen(head) + LONG_LEXEME_LENGTH - 1, 1, "b", 1};
+    SourceEdit before = {strlen(head) - 3, 1, "2", 1};
+    if (!incremental_edit(&ip, &retype) || !find_value(ip.parser->parse_tree, name)) {
+        failure = "the retyped identifier is not whole";
+    } else if (!incremental_edit(&ip, &before) || !find_value(ip.parser->parse_tree, name)) {
+        failure = "the reused identifier is not whole";
+    } else if (ip.parser->error_count != 0) {
+        failure = "syntax errors after the edits";
+    }
+    incremental_close(&ip);
+    return report("long lexeme", failure);
+}
+
+int main(void) {
+    parser_verbosity = 0;
+    bool ok = test_long_block();
+    ok = test_long_lexeme() && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
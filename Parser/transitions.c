@@ -0,0 +1,310 @@
+#include "transitions.h"
+#include "output.h"
+
+typedef struct {
+    uint32_t token;    // token index, see transitions.h
+    uint16_t id;       // GrammarNonterminal, or the matched TokenKind
+    uint8_t kind;      // TransitionKind
+} TransitionEvent;
+
+#define EVENTS_PER_CHUNK 8192
+
+typedef struct EventChunk {
+    struct EventChunk* next;
+    int count;
+    TransitionEvent events[EVENTS_PER_CHUNK];
+} EventChunk;
+
+// Chunks in log order. Those past last_chunk are left over from a longer
+// parse and are reused before any new one is allocated.
+static EventChunk* first_chunk = NULL;
+static EventChunk* last_chunk = NULL;
+int transition_count = 0;
+bool transition_tracing = true;
+
+// Initialize transition tracking
+void init_transition_tracking(void) {
+    last_chunk = NULL;
+    transition_count = 0;
+}
+
+static EventChunk* next_chunk(void) {
+    EventChunk* chunk = last_chunk ? last_chunk->next : first_chunk;
+    if (!chunk) {
+        chunk = (EventChunk*)malloc(sizeof(EventChunk));
+        if (!chunk) return NULL;
+        chunk->next = NULL;
+        if (last_chunk) last_chunk->next = chunk;
+        else first_chunk = chunk;
+    }
+    chunk->count = 0;
+    last_chunk = chunk;
+    return chunk;
+}
+
+// Append an event; when out of memory the log just ends
+void record_transition(TransitionKind kind, int id, int token) {
+    EventChunk* chunk = last_chunk;
+    if (!chunk || chunk->count == EVENTS_PER_CHUNK) {
+        chunk = next_chunk();
+        if (!chunk) return;
+    }
+    TransitionEvent* event = &chunk->events[chunk->count++];
+    event->token = (uint32_t)token;
+    event->id = (uint16_t)id;
+    event->kind = (uint8_t)kind;
+    transition_count++;
+}
+
+// ============ REPLAY ============
+
+// Walks the log in order
+typedef struct {
+    const EventChunk* chunk;
+    int index;
+    int remaining;
+} EventCursor;
+
+static EventCursor first_event(void) {
+    EventCursor cursor = { first_chunk, 0, transition_count };
+    return cursor;
+}
+
+static const TransitionEvent* next_event(EventCursor* cursor) {
+    if (cursor->remaining == 0) return NULL;
+    if (cursor->index == cursor->chunk->count) {
+        cursor->chunk = cursor->chunk->next;
+        cursor->index = 0;
+    }
+    cursor->remaining--;
+    return &cursor->chunk->events[cursor->index++];
+}
+
+// The action column: "ENTER Statement", "MATCH 'D_SEMICOLON'"
+static void format_action(char* action, size_t size, const TransitionEvent* event) {
+    switch (event->kind) {
+    case TRANSITION_ENTER:
+        snprintf(action, size, "ENTER %s", grammar_nonterminal_name((GrammarNonterminal)event->id));
+        break;
+    case TRANSITION_EXIT:
+        snprintf(action, size, "EXIT %s", grammar_nonterminal_name((GrammarNonterminal)event->id));
+        break;
+    default:
+        snprintf(action, size, "MATCH '%s'", token_kind_name(event->id));
+        break;
+    }
+}
+
+// The input column: the token's lexeme (cut to fit, 64 bytes for 63 as the
+// reports always had), "EOF" past the last token and for an EXIT at an empty lexeme
+static void format_input(char* input, size_t size, const TransitionEvent* event, const Parser* p) {
+    const char* lexeme = "EOF";
+    if (event->token < (uint32_t)p->token_count) {
+        ParserToken token;
+        lexeme = read_token(&p->tokens, (int)event->token, &token)->lexeme;
+        if (event->kind == TRANSITION_EXIT && lexeme[0] == '\0') lexeme = "EOF";
+    }
+    snprintf(input, size, "%s", lexeme);
+}
+
+// The stack column as the events replay: "$" and the nonterminals entered and
+// not yet exited, bottom first, cut at STACK_COLUMN bytes. length[d - 1] is
+// the column's length with d entries, so a pop only shortens it.
+#define STACK_COLUMN 255
+
+typedef struct {
+    char text[STACK_COLUMN + 1];
+    int* length;
+    int depth;
+    int capacity;
+} StackColumn;
+
+static bool stack_init(StackColumn* stack) {
+    stack->capacity = 256;
+    stack->length = (int*)malloc(stack->capacity * sizeof(int));
+    if (!stack->length) return false;
+    strcpy(stack->text, "$");
+    stack->length[0] = 1;
+    stack->depth = 1;
+    return true;
+}
+
+static bool stack_push(StackColumn* stack, const char* name) {
+    if (stack->depth == stack->capacity) {
+        int* grown = (int*)realloc(stack->length, stack->capacity * 2 * sizeof(int));
+        if (!grown) return false;
+        stack->length = grown;
+        stack->capacity *= 2;
+    }
+    int used = stack->length[stack->depth - 1];
+    if (used < STACK_COLUMN) {
+        int n = snprintf(stack->text + used, sizeof(stack->text) - used, " %s", name);
+        used = (used + n < STACK_COLUMN) ? used + n : STACK_COLUMN;
+    }
+    stack->length[stack->depth++] = used;
+    return true;
+}
+
+static void stack_pop(StackColumn* stack) {
+    if (stack->depth > 1) {
+        stack->depth--;
+    }
+}
+
+// ============ REPORTS ============
+
+// Two spaces per level
+static void indent(Output* out, int depth) {
+    if (depth > 0) output_spaces(out, (size_t)depth * 2);
+}
+
+// Write transition table to file
+bool write_transition_table(const char* filename, const Parser* p) {
+
+    Output out;
+    if (!output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create transition table file '%s'\n", filename);
+        return false;
+    }
+    StackColumn stack;
+    if (!stack_init(&stack)) {
+        output_close(&out);
+        return false;
+    }
+
+    output_string(&out, "PARSING TRANSITION TABLE\n");
+    output_string(&out, "Generated by Recursive Descent Parser (Pushdown Automaton)\n");
+    output_string(&out, "======================================================================\n\n");
+
+    // Table header
+    output_format(&out, "%-6s %-30s %-20s %-25s %-30s\n",
+            "STEP", "STACK", "INPUT", "ACTION", "PRODUCTION/DETAILS");
+    output_format(&out, "%-6s %-30s %-20s %-25s %-30s\n",
+            "------", "------------------------------",
+            "--------------------", "-------------------------",
+            "------------------------------");
+
+    // Table rows: ENTER shows the stack after its push, EXIT before its pop
+    bool ok = true;
+    EventCursor cursor = first_event();
+    const TransitionEvent* event;
+    for (int step = 1; (event = next_event(&cursor)) != NULL; step++) {
+        if (event->kind == TRANSITION_ENTER &&
+            !stack_push(&stack, grammar_nonterminal_name((GrammarNonterminal)event->id))) {
+            ok = false;
+            break;
+        }
+        char input[64], action[128];
+        format_input(input, sizeof(input), event, p);
+        format_action(action, sizeof(action), event);
+        output_format(&out, "%-6d %-30.*s %-20s %-25s %-30s\n",
+                step,
+                stack.length[stack.depth - 1], stack.text,
+                input,
+                action,
+                "");
+        if (event->kind == TRANSITION_EXIT) stack_pop(&stack);
+    }
+    free(stack.length);
+
+    output_string(&out, "\n======================================================================\n");
+    output_format(&out, "Total transitions: %d\n", transition_count);
+    output_string(&out, "End of Transition Table\n");
+
+    ok = output_close(&out) && ok;
+    parser_log("Transition table written to '%s'\n", filename);
+    return ok;
+}
+
+// Alternative: ASCII Diagram format
+bool write_transition_diagram(const char* filename, const Parser* p) {
+    Output out;
+    if (!output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create transition diagram file '%s'\n", filename);
+        return false;
+    }
+
+    output_string(&out, "PARSING TRANSITION DIAGRAM\n");
+    output_string(&out, "======================================================================\n\n");
+
+    int depth = 0;
+
+    EventCursor cursor = first_event();
+    const TransitionEvent* event;
+    for (int step = 1; (event = next_event(&cursor)) != NULL; step++) {
+        char action[128];
+        format_action(action, sizeof(action), event);
+
+        // Add section break when entering new major non-terminals
+        if (event->kind == TRANSITION_ENTER) {
+            depth++;
+            if (depth <= 2) {  // Only show headers for top 2 levels
+                output_format(&out, "\n========== %s ==========\n\n", action);
+            }
+        } else if (event->kind == TRANSITION_EXIT) {
+            depth--;
+        }
+
+        // Indent based on depth
+        indent(&out, depth);
+
+        output_format(&out, "[Step %d] %s\n", step, action);
+
+        // Show details on same line for terminals
+        if (event->kind == TRANSITION_MATCH) {
+            char input[64];
+            format_input(input, sizeof(input), event, p);
+            indent(&out, depth);
+            output_format(&out, "    Input: %s\n", input);
+        }
+    }
+
+    output_string(&out, "\n[ACCEPT]\n");
+    output_string(&out, "\n======================================================================\n");
+    output_string(&out, "End of Transition Diagram\n");
+
+    bool ok = output_close(&out);
+    parser_log("Transition diagram written to '%s'\n", filename);
+    return ok;
+}
+
+bool write_transition_summary(const char* filename, const Parser* p) {
+    Output out;
+    if (!output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create transition summary file '%s'\n", filename);
+        return false;
+    }
+
+    output_string(&out, "PARSING TRANSITION SUMMARY\n");
+    output_string(&out, "======================================================================\n\n");
+
+    int depth = 0;
+
+    EventCursor cursor = first_event();
+    const TransitionEvent* event;
+    while ((event = next_event(&cursor)) != NULL) {
+        // Only show ENTER and EXIT (skip individual MATCH actions)
+        if (event->kind == TRANSITION_MATCH) continue;
+        char action[128];
+        format_action(action, sizeof(action), event);
+        if (event->kind == TRANSITION_ENTER) {
+            char input[64];
+            format_input(input, sizeof(input), event, p);
+            depth++;
+            indent(&out, depth - 1);
+            output_format(&out, "↓ %s [Input: %s]\n", action, input);
+        } else {
+            indent(&out, depth - 1);
+            output_format(&out, "↑ %s\n", action);
+            depth--;
+        }
+    }
+
+    output_string(&out, "\n======================================================================\n");
+    output_format(&out, "Total parsing steps: %d\n", transition_count);
+    output_string(&out, "End of Summary\n");
+
+    bool ok = output_close(&out);
+    parser_log("Transition summary written to '%s'\n", filename);
+    return ok;
+}
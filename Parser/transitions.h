@@ -0,0 +1,47 @@
+#ifndef TRANSITIONS_H
+#define TRANSITIONS_H
+
+#include "grammar.h"
+
+// The PDA's transition log: ENTER and EXIT of a traced nonterminal and MATCH
+// of a terminal, each with the index of the token it happened at (the
+// lookahead, or the matched token; the token count or more at end of input).
+// Events are fixed-size records appended to chunks that are kept from one
+// parse to the next, so there is no step limit and logging copies no strings.
+// The reports' stack, input and action columns are rebuilt from the events
+// and the parser's tokens when a report is written.
+typedef enum { TRANSITION_ENTER, TRANSITION_EXIT, TRANSITION_MATCH } TransitionKind;
+
+// Whether the hooks log at run time: on by default, off when no transition
+// report is wanted, leaving a branch per hook. A PARSER_TRACE=0 build has
+// empty hooks and an always empty log.
+extern bool transition_tracing;
+
+void init_transition_tracking(void);
+void record_transition(TransitionKind kind, int id, int token);
+
+#if PARSER_TRACE
+static inline void enter_nonterminal(GrammarNonterminal nonterminal, int token) {
+    if (transition_tracing) record_transition(TRANSITION_ENTER, nonterminal, token);
+}
+static inline void exit_nonterminal(GrammarNonterminal nonterminal, int token) {
+    if (transition_tracing) record_transition(TRANSITION_EXIT, nonterminal, token);
+}
+static inline void match_terminal(TokenKind terminal, int token) {
+    if (transition_tracing) record_transition(TRANSITION_MATCH, terminal, token);
+}
+#else
+static inline void enter_nonterminal(GrammarNonterminal nonterminal, int token) { (void)nonterminal; (void)token; }
+static inline void exit_nonterminal(GrammarNonterminal nonterminal, int token) { (void)nonterminal; (void)token; }
+static inline void match_terminal(TokenKind terminal, int token) { (void)terminal; (void)token; }
+#endif
+
+// Reports of the last parse, whose tokens p holds; false if the file could
+// not be written
+bool write_transition_table(const char* filename, const Parser* p);
+bool write_transition_diagram(const char* filename, const Parser* p);
+bool write_transition_summary(const char* filename, const Parser* p);
+
+extern int transition_count;
+
+#endif
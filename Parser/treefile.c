@@ -0,0 +1,728 @@
+#include "treefile.h"
+#include "output.h"
+
+// Frame of an iterative tree walk
+typedef struct {
+    const ParseTreeNode* next;  // next child to visit, NULL when done
+    uint32_t parent;            // image: the parent's index
+    uint32_t previous;          // image: the last child's index; JSON: children so far
+} TreeFrame;
+
+typedef struct {
+    TreeFrame* frames;
+    int depth;
+    int capacity;
+} TreeStack;
+
+static bool tree_push(TreeStack* stack, const ParseTreeNode* next, uint32_t parent, uint32_t previous) {
+    if (stack->depth == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 256;
+        TreeFrame* grown = (TreeFrame*)realloc(stack->frames, capacity * sizeof(TreeFrame));
+        if (!grown) return false;
+        stack->frames = grown;
+        stack->capacity = capacity;
+    }
+    TreeFrame* frame = &stack->frames[stack->depth++];
+    frame->next = next;
+    frame->parent = parent;
+    frame->previous = previous;
+    return true;
+}
+
+// ============ JSON ============
+
+// Length of the UTF-8 sequence at s (at most left bytes), 0 if it is not one
+static size_t utf8_sequence(const unsigned char* s, size_t left) {
+    unsigned char c = s[0];
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;  // the second byte's range
+    if (c >= 0xC2 && c <= 0xDF) length = 2;
+    else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        if (c == 0xE0) low = 0xA0;          // overlong
+        if (c == 0xED) high = 0x9F;         // surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        if (c == 0xF0) low = 0x90;          // overlong
+        if (c == 0xF4) high = 0x8F;         // past U+10FFFF
+    } else return 0;
+    if (left < length || s[1] < low || s[1] > high) return 0;
+    for (size_t i = 2; i < length; i++) {
+        if (s[i] < 0x80 || s[i] > 0xBF) return 0;
+    }
+    return length;
+}
+
+// A JSON string literal: runs of plain bytes are copied as they are
+static void write_json_string(Output* out, const char* text) {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char* s = (const unsigned char*)text;
+    size_t length = strlen(text);
+    size_t run = 0;
+    output_char(out, '"');
+    for (size_t i = 0; i < length; ) {
+        unsigned char c = s[i];
+        size_t sequence = 1;
+        if (c >= 0x20 && c != '"' && c != '\\' && (c < 0x80 || (sequence = utf8_sequence(s + i, length - i)) > 0)) {
+            i += sequence;
+            continue;
+        }
+        output_write(out, text + run, i - run);
+        char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+        switch (c) {
+            case '"':  output_write(out, "\\\"", 2); break;
+            case '\\': output_write(out, "\\\\", 2); break;
+            case '\n': output_write(out, "\\n", 2); break;
+            case '\t': output_write(out, "\\t", 2); break;
+            case '\r': output_write(out, "\\r", 2); break;
+            default:   output_write(out, escape, sizeof(escape)); break;
+        }
+        run = ++i;
+    }
+    output_write(out, text + run, length - run);
+    output_char(out, '"');
+}
+
+static void write_json_node(Output* out, const ParseTreeNode* node) {
+    output_string(out, node->kind >= NODE_TOKEN ? "\n{\"token\":" : "\n{\"node\":");
+    write_json_string(out, node_name(node));
+    if (node->value) {
+        output_string(out, ",\"value\":");
+        write_json_string(out, node->value);
+    }
+    output_string(out, node->first_child ? ",\"children\":[" : "}");
+}
+
+bool write_parse_tree_json(const char* filename, const ParseTreeNode* tree) {
+    Output out;
+    if (!output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create output file '%s'\n", filename);
+        return false;
+    }
+    char head[80];
+    snprintf(head, sizeof(head), "{\"format\":\"%s\",\"version\":%d,\"tree\":",
+             TREE_JSON_FORMAT, TREE_JSON_VERSION);
+    output_string(&out, head);
+
+    TreeStack stack = { NULL, 0, 0 };
+    bool ok = true;
+    const ParseTreeNode* node = tree;
+    if (!node) output_string(&out, "null");
+    while (node) {
+        write_json_node(&out, node);
+        if (node->first_child && !(ok = tree_push(&stack, node->first_child, 0, 0))) break;
+
+        // The next child of the innermost open node, closing finished ones
+        node = NULL;
+        while (stack.depth > 0) {
+            TreeFrame* frame = &stack.frames[stack.depth - 1];
+            if (frame->next) {
+                node = frame->next;
+                frame->next = node->next_sibling;
+                if (frame->previous++ > 0) output_char(&out, ',');
+                break;
+            }
+            stack.depth--;
+            output_string(&out, "]}");
+        }
+    }
+    free(stack.frames);
+    output_string(&out, "}\n");
+
+    ok = output_close(&out) && ok;
+    parser_log("Parse tree written to '%s'\n", filename);
+    return ok;
+}
+
+// Node kind of a kind name as it appears in the file, so each name is looked
+// up once per load
+#define KIND_CACHE_SLOTS 256
+// Longer names are no kind's, so the file is not one of ours
+#define MAX_KIND_NAME_LENGTH 256
+
+typedef struct {
+    const char* name;       // in the file, NULL for an empty slot
+    size_t length;
+    int kind;
+} KindCacheEntry;
+
+// JSON text being read: at moves forward, ok turns false at the first error
+typedef struct {
+    const char* at;
+    const char* end;
+    Arena* arena;
+    bool ok;
+    KindCacheEntry kinds[KIND_CACHE_SLOTS];
+} JsonReader;
+
+static char json_peek(JsonReader* r) {
+    while (r->at < r->end && (*r->at == ' ' || *r->at == '\n' || *r->at == '\r' || *r->at == '\t')) r->at++;
+    return r->at < r->end ? *r->at : '\0';
+}
+
+// Next non-space character, consumed; '\0' at the end
+static char json_take(JsonReader* r) {
+    char c = json_peek(r);
+    if (r->at < r->end) r->at++;
+    return c;
+}
+
+static bool json_expect(JsonReader* r, char c) {
+    if (json_take(r) != c) r->ok = false;
+    return r->ok;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool json_code_unit(JsonReader* r, unsigned* unit) {
+    *unit = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = r->at < r->end ? hex_digit(*r->at++) : -1;
+        if (digit < 0) return false;
+        *unit = *unit << 4 | (unsigned)digit;
+    }
+    return true;
+}
+
+// The end of the string literal whose text starts at r->at: its closing quote,
+// or NULL when there is none. escaped tells whether the text has escapes.
+static const char* json_string_end(const JsonReader* r, bool* escaped) {
+    const char* close = (const char*)memchr(r->at, '"', r->end - r->at);
+    const char* backslash = (const char*)memchr(r->at, '\\', (close ? close : r->end) - r->at);
+    *escaped = backslash != NULL;
+    if (!backslash) return close;
+    close = backslash;
+    while (close < r->end && *close != '"') close += (*close == '\\') ? 2 : 1;
+    return close < r->end ? close : NULL;
+}
+
+// A string literal, decoded into the arena; NULL on an error
+static char* json_string(JsonReader* r) {
+    if (!json_expect(r, '"')) return NULL;
+    bool escaped;
+    const char* close = json_string_end(r, &escaped);
+    // Decoding never makes a string longer than its literal
+    char* text = close ? (char*)arena_alloc(r->arena, (size_t)(close - r->at) + 1) : NULL;
+    if (!text) {
+        r->ok = false;
+        return NULL;
+    }
+    if (!escaped) {
+        memcpy(text, r->at, close - r->at);
+        text[close - r->at] = '\0';
+        r->at = close + 1;
+        return text;
+    }
+    char* w = text;
+    while (r->at < close) {
+        char c = *r->at++;
+        if (c != '\\') {
+            *w++ = c;
+            continue;
+        }
+        unsigned code;
+        switch (*r->at++) {
+            case '"':  *w++ = '"'; break;
+            case '\\': *w++ = '\\'; break;
+            case '/':  *w++ = '/'; break;
+            case 'b':  *w++ = '\b'; break;
+            case 'f':  *w++ = '\f'; break;
+            case 'n':  *w++ = '\n'; break;
+            case 'r':  *w++ = '\r'; break;
+            case 't':  *w++ = '\t'; break;
+            case 'u':
+                if (!json_code_unit(r, &code)) {
+                    r->ok = false;
+                    return NULL;
+                }
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    unsigned low;
+                    if (close - r->at < 6 || r->at[0] != '\\' || r->at[1] != 'u') {
+                        r->ok = false;
+                        return NULL;
+                    }
+                    r->at += 2;
+                    if (!json_code_unit(r, &low) || low < 0xDC00 || low > 0xDFFF) {
+                        r->ok = false;
+                        return NULL;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (code == 0) {
+                    r->ok = false;  // values are C strings
+                    return NULL;
+                }
+                // Up to U+00FF it is the byte itself, as the writer escapes it
+                if (code < 0x100) {
+                    *w++ = (char)code;
+                } else if (code < 0x800) {
+                    *w++ = (char)(0xC0 | code >> 6);
+                    *w++ = (char)(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    *w++ = (char)(0xE0 | code >> 12);
+                    *w++ = (char)(0x80 | (code >> 6 & 0x3F));
+                    *w++ = (char)(0x80 | (code & 0x3F));
+                } else {
+                    *w++ = (char)(0xF0 | code >> 18);
+                    *w++ = (char)(0x80 | (code >> 12 & 0x3F));
+                    *w++ = (char)(0x80 | (code >> 6 & 0x3F));
+                    *w++ = (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            default:
+                r->ok = false;
+                return NULL;
+        }
+    }
+    r->at = close + 1;
+    *w = '\0';
+    return text;
+}
+
+// A member name and its ':'; false on an error
+static bool json_key(JsonReader* r, char* key, size_t size) {
+    if (!json_expect(r, '"')) return false;
+    // Names of no interest may be long, they are cut to an unknown name
+    size_t length = 0;
+    while (r->at < r->end && *r->at != '"' && *r->at != '\\') {
+        if (length + 1 < size) key[length++] = *r->at;
+        r->at++;
+    }
+    key[length] = '\0';
+    r->ok = r->at < r->end && *r->at++ == '"' && json_expect(r, ':');
+    return r->ok;
+}
+
+// Skips a number, true, false or null
+static void json_skip_scalar(JsonReader* r) {
+    json_peek(r);
+    const char* start = r->at;
+    while (r->at < r->end && (isalnum((unsigned char)*r->at) || *r->at == '-' || *r->at == '+' || *r->at == '.')) {
+        r->at++;
+    }
+    if (r->at == start) r->ok = false;
+}
+
+static ParseTreeNode* json_new_child(JsonReader* r, ParseTreeNode* parent) {
+    ParseTreeNode* node = (ParseTreeNode*)arena_alloc(r->arena, sizeof(ParseTreeNode));
+    if (!node) {
+        r->ok = false;
+        return NULL;
+    }
+    node->kind = -1;
+    node->value = NULL;
+    node->first_child = node->last_child = node->next_sibling = NULL;
+    add_child(parent, node);
+    return node;
+}
+
+static int node_kind_from_name(const char* name) {
+    static const char* names[] = {
+#define NODE_KIND_NAME(kind, name) name,
+        PARSE_NODE_KINDS(NODE_KIND_NAME)
+#undef NODE_KIND_NAME
+    };
+    for (int kind = 0; kind < NODE_TOKEN; kind++) {
+        if (strcmp(names[kind], name) == 0) return kind;
+    }
+    return -1;
+}
+
+// The kind named by a string literal: a token kind or a nonterminal's; -1 on
+// an error
+static int json_kind(JsonReader* r, bool token) {
+    if (!json_expect(r, '"')) return -1;
+    bool escaped;
+    const char* name = r->at;
+    const char* close = json_string_end(r, &escaped);
+    if (!close || escaped || close - name > MAX_KIND_NAME_LENGTH) return -1;
+    size_t length = (size_t)(close - name);
+    r->at = close + 1;
+
+    uint32_t h = token ? 1 : 0;
+    for (size_t i = 0; i < length; i++) h = (h ^ (unsigned char)name[i]) * 16777619u;
+    KindCacheEntry* entry = &r->kinds[h & (KIND_CACHE_SLOTS - 1)];
+    if (entry->name && entry->length == length && memcmp(entry->name, name, length) == 0 &&
+        (entry->kind >= NODE_TOKEN) == token) {
+        return entry->kind;
+    }
+    char text[MAX_KIND_NAME_LENGTH + 1];
+    memcpy(text, name, length);
+    text[length] = '\0';
+    int kind;
+    if (token) {
+        TokenKind token_kind = token_kind_from_name(text);
+        kind = token_kind == T_NONE ? -1 : NODE_TOKEN + token_kind;
+    } else {
+        kind = node_kind_from_name(text);
+    }
+    entry->name = name;
+    entry->length = length;
+    entry->kind = kind;
+    return kind;
+}
+
+// The tree value after "tree": NODE, read without recursion. open holds the
+// nodes whose children array is being read, innermost last.
+static ParseTreeNode* json_tree(JsonReader* r) {
+    ParseTreeNode** open = NULL;
+    int depth = 0, capacity = 0;
+    if (!json_expect(r, '{')) return NULL;
+    ParseTreeNode* root = json_new_child(r, NULL);
+    ParseTreeNode* node = root;
+    bool first = true;  // at the start of node's members
+
+    while (r->ok) {
+        bool closed = first && json_peek(r) == '}';
+        if (closed) {
+            r->at++;
+        } else {
+            char key[16];
+            if (!json_key(r, key, sizeof(key))) break;
+            if (strcmp(key, "node") == 0 || strcmp(key, "token") == 0) {
+                node->kind = json_kind(r, key[0] == 't');
+                if (node->kind < 0) r->ok = false;
+            } else if (strcmp(key, "value") == 0) {
+                node->value = json_string(r);
+            } else if (strcmp(key, "children") == 0) {
+                if (!json_expect(r, '[')) break;
+                if (json_peek(r) == ']') {
+                    r->at++;
+                } else {
+                    if (depth == capacity) {
+                        capacity = capacity ? capacity * 2 : 256;
+                        ParseTreeNode** grown = (ParseTreeNode**)realloc(open, capacity * sizeof(ParseTreeNode*));
+                        if (!grown) {
+                            r->ok = false;
+                            break;
+                        }
+                        open = grown;
+                    }
+                    open[depth++] = node;
+                    if (!json_expect(r, '{')) break;
+                    node = json_new_child(r, node);
+                    first = true;
+                    continue;
+                }
+            } else {
+                json_skip_scalar(r);
+            }
+            char c = json_take(r);
+            if (c == ',') {
+                first = false;
+                continue;
+            }
+            closed = c == '}';
+            if (!closed) r->ok = false;
+        }
+
+        // node is complete: on to its next sibling, or close its parents
+        bool done = false;
+        first = false;
+        while (r->ok) {
+            if (node->kind < 0) r->ok = false;
+            done = depth == 0;
+            if (done || !r->ok) break;
+            char c = json_take(r);
+            if (c == ',') {
+                if (json_expect(r, '{')) node = json_new_child(r, open[depth - 1]);
+                first = true;
+                break;
+            }
+            if (c != ']') {
+                r->ok = false;
+                break;
+            }
+            node = open[--depth];
+            c = json_take(r);   // after the parent's children
+            if (c == ',') break;
+            if (c != '}') r->ok = false;
+        }
+        if (done) break;
+    }
+    free(open);
+    return r->ok ? root : NULL;
+}
+
+bool load_parse_tree_json(const char* filename, LoadedParseTree* tree) {
+    SourceBuffer file;
+    if (!openSource(&file, filename)) return false;
+    arena_init(&tree->nodes);
+    tree->root = NULL;
+    JsonReader* r = (JsonReader*)calloc(1, sizeof(JsonReader));
+    if (!r) {
+        closeSource(&file);
+        return false;
+    }
+    r->at = file.data;
+    r->end = file.data + file.length;
+    r->arena = &tree->nodes;
+    r->ok = true;
+
+    bool format = false, version = false;
+    json_expect(r, '{');
+    while (r->ok) {
+        char key[16];
+        if (!json_key(r, key, sizeof(key))) break;
+        if (strcmp(key, "format") == 0) {
+            const char* name = json_string(r);
+            format = name && strcmp(name, TREE_JSON_FORMAT) == 0;
+        } else if (strcmp(key, "version") == 0) {
+            json_peek(r);
+            version = r->end - r->at > 1 && r->at[0] == '0' + TREE_JSON_VERSION && !isdigit((unsigned char)r->at[1]);
+            json_skip_scalar(r);
+        } else if (strcmp(key, "tree") == 0) {
+            if (json_peek(r) == 'n') json_skip_scalar(r);
+            else tree->root = json_tree(r);
+        } else {
+            json_skip_scalar(r);
+        }
+        char c = json_take(r);
+        if (c == '}') break;
+        if (c != ',') r->ok = false;
+    }
+    bool ok = r->ok && format && version;
+    free(r);
+    closeSource(&file);
+    if (!ok) {
+        arena_free(&tree->nodes);
+        return false;
+    }
+    return true;
+}
+
+void free_loaded_parse_tree(LoadedParseTree* tree) {
+    arena_free(&tree->nodes);
+    tree->root = NULL;
+}
+
+// ============ BINARY IMAGE ============
+
+// Strings of the image, each stored once. Open addressing over pool offsets,
+// keyed by the string's bytes.
+typedef struct {
+    char* pool;
+    size_t length;
+    size_t capacity;
+    uint32_t* slots;        // offset + 1, 0 for empty
+    size_t slot_count;      // power of two
+    size_t count;
+} StringPool;
+
+static uint32_t hash_string(const char* s, size_t length) {
+    uint32_t h = 2166136261u;   // FNV-1a
+    for (size_t i = 0; i < length; i++) h = (h ^ (unsigned char)s[i]) * 16777619u;
+    return h;
+}
+
+static bool grow_slots(StringPool* strings) {
+    size_t slot_count = strings->slot_count ? strings->slot_count * 2 : 1024;
+    uint32_t* slots = (uint32_t*)calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return false;
+    for (size_t i = 0; i < strings->slot_count; i++) {
+        uint32_t entry = strings->slots[i];
+        if (!entry) continue;
+        const char* s = strings->pool + entry - 1;
+        size_t slot = hash_string(s, strlen(s)) & (slot_count - 1);
+        while (slots[slot]) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = entry;
+    }
+    free(strings->slots);
+    strings->slots = slots;
+    strings->slot_count = slot_count;
+    return true;
+}
+
+// Offset of text in the pool, adding it on first sight; TREE_IMAGE_NONE when
+// out of memory or past 4 GB
+static uint32_t intern_string(StringPool* strings, const char* text) {
+    if ((strings->count + 1) * 2 > strings->slot_count && !grow_slots(strings)) return TREE_IMAGE_NONE;
+    size_t length = strlen(text);
+    size_t slot = hash_string(text, length) & (strings->slot_count - 1);
+    while (strings->slots[slot]) {
+        const char* s = strings->pool + strings->slots[slot] - 1;
+        if (strcmp(s, text) == 0) return strings->slots[slot] - 1;
+        slot = (slot + 1) & (strings->slot_count - 1);
+    }
+    if (strings->length + length + 1 >= TREE_IMAGE_NONE) return TREE_IMAGE_NONE;
+    if (strings->length + length + 1 > strings->capacity) {
+        size_t capacity = strings->capacity ? strings->capacity : 4096;
+        while (capacity < strings->length + length + 1) capacity *= 2;
+        char* grown = (char*)realloc(strings->pool, capacity);
+        if (!grown) return TREE_IMAGE_NONE;
+        strings->pool = grown;
+        strings->capacity = capacity;
+    }
+    uint32_t offset = (uint32_t)strings->length;
+    memcpy(strings->pool + offset, text, length + 1);
+    strings->length += length + 1;
+    strings->slots[slot] = offset + 1;
+    strings->count++;
+    return offset;
+}
+
+// The image's nodes and kinds as they are built, in file byte order
+typedef struct {
+    TreeImageNode* nodes;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t* kinds;        // kind table: name offsets
+    uint32_t kind_count;
+    uint16_t* kind_ids;     // by node kind: kind table index + 1, 0 for none yet
+    int kind_id_count;
+} ImageBuilder;
+
+// Appends node, linked to its parent and previous sibling; its index or
+// TREE_IMAGE_NONE when out of memory
+static uint32_t add_image_node(ImageBuilder* b, StringPool* strings, const ParseTreeNode* node,
+                               uint32_t parent, uint32_t previous) {
+    if (b->count == b->capacity) {
+        uint32_t capacity = b->capacity ? b->capacity * 2 : 4096;
+        if (capacity <= b->capacity || capacity >= TREE_IMAGE_NONE) return TREE_IMAGE_NONE;
+        TreeImageNode* grown = (TreeImageNode*)realloc(b->nodes, (size_t)capacity * sizeof(TreeImageNode));
+        if (!grown) return TREE_IMAGE_NONE;
+        b->nodes = grown;
+        b->capacity = capacity;
+    }
+    if (node->kind >= b->kind_id_count) {
+        int count = node->kind + 64;
+        uint16_t* grown = (uint16_t*)realloc(b->kind_ids, count * sizeof(uint16_t));
+        if (!grown) return TREE_IMAGE_NONE;
+        memset(grown + b->kind_id_count, 0, (count - b->kind_id_count) * sizeof(uint16_t));
+        b->kind_ids = grown;
+        b->kind_id_count = count;
+    }
+    if (b->kind_ids[node->kind] == 0) {
+        uint32_t name = intern_string(strings, node_name(node));
+        uint32_t* grown = (uint32_t*)realloc(b->kinds, (b->kind_count + 1) * sizeof(uint32_t));
+        if (name == TREE_IMAGE_NONE || !grown || b->kind_count == 0xFFFF) return TREE_IMAGE_NONE;
+        b->kinds = grown;
+        b->kinds[b->kind_count++] = tokenFileU32(name);
+        b->kind_ids[node->kind] = (uint16_t)b->kind_count;
+    }
+
+    uint32_t value = TREE_IMAGE_NONE;
+    if (node->value && (value = intern_string(strings, node->value)) == TREE_IMAGE_NONE) return TREE_IMAGE_NONE;
+    uint32_t index = b->count++;
+    TreeImageNode* record = &b->nodes[index];
+    record->kind = tokenFileU16((uint16_t)(b->kind_ids[node->kind] - 1));
+    record->flags = tokenFileU16(node->kind >= NODE_TOKEN ? TREE_IMAGE_TOKEN : 0);
+    record->value = tokenFileU32(value);
+    record->first_child = TREE_IMAGE_NONE;
+    record->next_sibling = TREE_IMAGE_NONE;
+    if (previous != TREE_IMAGE_NONE) b->nodes[previous].next_sibling = tokenFileU32(index);
+    else if (parent != TREE_IMAGE_NONE) b->nodes[parent].first_child = tokenFileU32(index);
+    return index;
+}
+
+bool write_parse_tree_image(const char* filename, const ParseTreeNode* tree) {
+    ImageBuilder b = { NULL, 0, 0, NULL, 0, NULL, 0 };
+    StringPool strings = { NULL, 0, 0, NULL, 0, 0 };
+    TreeStack stack = { NULL, 0, 0 };
+    bool ok = true;
+
+    // Preorder, so a node's first child is the node after it
+    if (tree) {
+        uint32_t root = add_image_node(&b, &strings, tree, TREE_IMAGE_NONE, TREE_IMAGE_NONE);
+        ok = root != TREE_IMAGE_NONE &&
+             (!tree->first_child || tree_push(&stack, tree->first_child, root, TREE_IMAGE_NONE));
+    }
+    while (ok && stack.depth > 0) {
+        TreeFrame* frame = &stack.frames[stack.depth - 1];
+        const ParseTreeNode* node = frame->next;
+        if (!node) {
+            stack.depth--;
+            continue;
+        }
+        frame->next = node->next_sibling;
+        uint32_t index = add_image_node(&b, &strings, node, frame->parent, frame->previous);
+        ok = index != TREE_IMAGE_NONE;
+        if (!ok) break;
+        frame->previous = index;
+        if (node->first_child) ok = tree_push(&stack, node->first_child, index, TREE_IMAGE_NONE);
+    }
+    free(stack.frames);
+
+    Output out;
+    if (ok && !output_open(&out, filename)) {
+        parser_log("ERROR: Cannot create output file '%s'\n", filename);
+        ok = false;
+    } else if (ok) {
+        TreeImageHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, TREE_IMAGE_MAGIC, sizeof(header.magic));
+        header.version = tokenFileU16(TREE_IMAGE_VERSION);
+        header.header_size = tokenFileU16(sizeof(TreeImageHeader));
+        header.node_count = tokenFileU32(b.count);
+        header.kind_count = tokenFileU32(b.kind_count);
+        header.string_bytes = tokenFileU32((uint32_t)strings.length);
+        output_write(&out, (const char*)&header, sizeof(header));
+        output_write(&out, (const char*)b.kinds, b.kind_count * sizeof(uint32_t));
+        output_write(&out, (const char*)b.nodes, (size_t)b.count * sizeof(TreeImageNode));
+        output_write(&out, strings.pool, strings.length);
+        ok = output_close(&out);
+        parser_log("Parse tree written to '%s'\n", filename);
+    }
+
+    free(b.nodes);
+    free(b.kinds);
+    free(b.kind_ids);
+    free(strings.pool);
+    free(strings.slots);
+    return ok;
+}
+
+bool open_tree_image(const char* filename, TreeImage* image) {
+    if (!openSource(&image->file, filename)) return false;
+
+    const unsigned char* data = (const unsigned char*)image->file.data;
+    TreeImageHeader* h = &image->header;
+    bool ok = image->file.length >= sizeof(TreeImageHeader);
+    if (ok) {
+        memcpy(h, data, sizeof(TreeImageHeader));
+        h->version = tokenFileU16(h->version);
+        h->header_size = tokenFileU16(h->header_size);
+        h->node_count = tokenFileU32(h->node_count);
+        h->kind_count = tokenFileU32(h->kind_count);
+        h->string_bytes = tokenFileU32(h->string_bytes);
+        // 64-bit sizes so a corrupt count can't wrap around
+        uint64_t size = sizeof(TreeImageHeader) + (uint64_t)h->kind_count * 4 +
+                        (uint64_t)h->node_count * sizeof(TreeImageNode) + h->string_bytes;
+        ok = memcmp(h->magic, TREE_IMAGE_MAGIC, sizeof(h->magic)) == 0 &&
+             h->version == TREE_IMAGE_VERSION &&
+             h->header_size == sizeof(TreeImageHeader) &&
+             size == image->file.length &&
+             (h->string_bytes == 0 ? h->node_count == 0 : data[image->file.length - 1] == '\0');
+    }
+    if (ok) {
+        image->kinds = data + sizeof(TreeImageHeader);
+        image->nodes = image->kinds + (size_t)h->kind_count * 4;
+        image->strings = (const char*)image->nodes + (size_t)h->node_count * sizeof(TreeImageNode);
+    }
+    for (uint32_t k = 0; ok && k < h->kind_count; k++) {
+        ok = tokenFileEntry(image->kinds, k) < h->string_bytes;
+    }
+    // Every link in range and forward: the first child right after its
+    // parent, a sibling after the node
+    for (uint32_t i = 0; ok && i < h->node_count; i++) {
+        TreeImageNode node = tree_image_node(image, i);
+        ok = node.kind < h->kind_count &&
+             (node.value == TREE_IMAGE_NONE || node.value < h->string_bytes) &&
+             (node.first_child == TREE_IMAGE_NONE || (node.first_child == i + 1 && i + 1 < h->node_count)) &&
+             (node.next_sibling == TREE_IMAGE_NONE || (node.next_sibling > i && node.next_sibling < h->node_count));
+    }
+    if (!ok) {
+        closeSource(&image->file);
+        return false;
+    }
+    return true;
+}
+
+void close_tree_image(TreeImage* image) {
+    closeSource(&image->file);
+}
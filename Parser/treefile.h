@@ -0,0 +1,105 @@
+#ifndef TREEFILE_H
+#define TREEFILE_H
+
+#include "parser.h"
+#include "../Lexer/source.h"
+
+// Parse trees for other programs: streaming JSON and a binary image that can
+// be mapped and walked in place. Both keep every node, its kind name and its
+// value (also the ones the text layouts leave out, such as ε's "empty").
+//
+// JSON: {"format":"usbong-parse-tree","version":1,"tree":NODE} where NODE is
+// {"node":"Statement","children":[NODE,...]} for a nonterminal (ε and ERROR
+// included) and {"token":"D_SEMICOLON","value":";"} for a matched token.
+// "value" is left out when a node has none, "children" when it has no
+// children, and "tree" is null for no tree. Every node starts on a new line,
+// without indentation. Strings are UTF-8; a lexeme byte that is not part of a
+// UTF-8 sequence is written as its \u0080 to \u00ff escape, which the loader
+// turns back into that byte.
+#define TREE_JSON_FORMAT "usbong-parse-tree"
+#define TREE_JSON_VERSION 1
+
+// Binary image (".usbp"). All integers are little-endian; layout, in file order:
+//
+//  TreeImageHeader                          32 bytes
+//  uint32 kinds[kind_count]                 string offset of each kind's name
+//  TreeImageNode nodes[node_count]          16 bytes each, in preorder: node 0
+//                                           is the root, a node's first child
+//                                           comes right after it
+//  char   strings[string_bytes]             string pool, every string
+//                                           NUL-terminated, each one once
+//
+// Links are node indexes and only point forward, so a walk always ends.
+// open_tree_image checks every offset and index once; after that the
+// accessors below read the mapping directly.
+#define TREE_IMAGE_MAGIC "USBP"
+#define TREE_IMAGE_VERSION 1
+#define TREE_IMAGE_NONE 0xFFFFFFFFu    // no value, child or sibling
+#define TREE_IMAGE_TOKEN 1             // TreeImageNode flag: a matched token
+
+typedef struct {
+    char magic[4];          // "USBP"
+    uint16_t version;       // TREE_IMAGE_VERSION
+    uint16_t header_size;   // sizeof(TreeImageHeader)
+    uint32_t node_count;
+    uint32_t kind_count;
+    uint32_t string_bytes;
+    uint32_t reserved[3];   // 0
+} TreeImageHeader;
+
+typedef struct {
+    uint16_t kind;          // index into kinds
+    uint16_t flags;         // TREE_IMAGE_TOKEN
+    uint32_t value;         // string offset or TREE_IMAGE_NONE
+    uint32_t first_child;   // index + 1 or TREE_IMAGE_NONE
+    uint32_t next_sibling;  // a later index or TREE_IMAGE_NONE
+} TreeImageNode;
+
+// A mapped image; the section pointers point into the mapping
+typedef struct {
+    SourceBuffer file;
+    TreeImageHeader header;         // in host byte order
+    const unsigned char* kinds;
+    const unsigned char* nodes;
+    const char* strings;
+} TreeImage;
+
+bool write_parse_tree_json(const char* filename, const ParseTreeNode* tree);
+bool write_parse_tree_image(const char* filename, const ParseTreeNode* tree);
+
+// A tree loaded back from JSON, its nodes and values in its own arena
+typedef struct {
+    Arena nodes;
+    ParseTreeNode* root;    // NULL for no tree
+} LoadedParseTree;
+
+// False (nothing to free) if the file cannot be read or is not a tree
+bool load_parse_tree_json(const char* filename, LoadedParseTree* tree);
+void free_loaded_parse_tree(LoadedParseTree* tree);
+
+// False (nothing to close) if the file cannot be read or is not a valid image
+bool open_tree_image(const char* filename, TreeImage* image);
+void close_tree_image(TreeImage* image);
+
+// Node i of an open image, in host byte order (i < node_count)
+static inline TreeImageNode tree_image_node(const TreeImage* image, uint32_t i) {
+    TreeImageNode node;
+    memcpy(&node, image->nodes + (size_t)i * sizeof(TreeImageNode), sizeof(node));
+    node.kind = tokenFileU16(node.kind);
+    node.flags = tokenFileU16(node.flags);
+    node.value = tokenFileU32(node.value);
+    node.first_child = tokenFileU32(node.first_child);
+    node.next_sibling = tokenFileU32(node.next_sibling);
+    return node;
+}
+
+static inline const char* tree_image_kind_name(const TreeImage* image, const TreeImageNode* node) {
+    return image->strings + tokenFileEntry(image->kinds, node->kind);
+}
+
+// NULL for none
+static inline const char* tree_image_value(const TreeImage* image, const TreeImageNode* node) {
+    return node->value == TREE_IMAGE_NONE ? NULL : image->strings + node->value;
+}
+
+#endif